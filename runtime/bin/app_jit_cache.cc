@@ -0,0 +1,328 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/app_jit_cache.h"
+
+#include <time.h>
+
+#include <memory>
+
+#include "bin/dartutils.h"
+#include "bin/directory.h"
+#include "bin/file.h"
+#include "bin/platform.h"
+#include "bin/process.h"
+#include "include/dart_api.h"
+#include "platform/growable_array.h"
+#include "platform/hashmap.h"
+#include "platform/syslog.h"
+#include "platform/utils.h"
+
+namespace dart {
+namespace bin {
+
+static const char* const kSnapshotSuffix = ".jit";
+static const char* const kTemporarySuffix = ".tmp";
+
+// Temporary files older than this were left behind by training runs that
+// did not finish, and are deleted during eviction.
+static constexpr int64_t kStaleTemporaryFileSeconds = 24 * 60 * 60;
+
+char* AppJITCache::cache_dir_ = nullptr;
+char* AppJITCache::snapshot_filename_ = nullptr;
+char* AppJITCache::training_snapshot_filename_ = nullptr;
+
+// 64-bit FNV-1a, applied a word at a time to keep hashing large kernel
+// binaries cheap compared to the startup it saves.
+class KeyHasher {
+ public:
+  KeyHasher() : hash_(kOffsetBasis) {}
+
+  void Add(const uint8_t* data, intptr_t length) {
+    intptr_t i = 0;
+    for (; i + kInt64Size <= length; i += kInt64Size) {
+      uint64_t word;
+      memmove(&word, data + i, kInt64Size);
+      Mix(word);
+    }
+    for (; i < length; i++) {
+      Mix(data[i]);
+    }
+  }
+
+  void Add(const char* str) {
+    if (str == nullptr) str = "";
+    // Include the terminator so that adjacent strings cannot run together.
+    Add(reinterpret_cast<const uint8_t*>(str), strlen(str) + 1);
+  }
+
+  void Add(int64_t value) { Mix(static_cast<uint64_t>(value)); }
+
+  uint64_t hash() const { return hash_; }
+
+ private:
+  static constexpr uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+  static constexpr uint64_t kPrime = 0x100000001b3ULL;
+
+  void Mix(uint64_t value) { hash_ = (hash_ ^ value) * kPrime; }
+
+  uint64_t hash_;
+};
+
+// Adds the contents of the kernel file [script_name] to [hasher]. Returns
+// false if the file cannot be read or is not a kernel binary.
+static bool AddKernelFile(KeyHasher* hasher, const char* script_name) {
+  File* file = File::Open(nullptr, script_name, File::kRead);
+  if (file == nullptr) {
+    return false;
+  }
+  RefCntReleaseScope<File> rs(file);
+  const int64_t length = file->Length();
+  if (length <= 0) {
+    return false;
+  }
+  std::unique_ptr<MappedMemory> mapping(file->Map(File::kReadOnly, 0, length));
+  if (mapping == nullptr) {
+    return false;
+  }
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(mapping->address());
+  if (DartUtils::SniffForMagicNumber(data, length) !=
+      DartUtils::kKernelMagicNumber) {
+    return false;
+  }
+  hasher->Add(data, length);
+  return true;
+}
+
+// Adds the identity of the running executable to [hasher], since snapshots
+// are only compatible with the VM build that wrote them.
+static void AddExecutable(KeyHasher* hasher) {
+  char path[PATH_MAX + 1];
+  const intptr_t length = Platform::ResolveExecutablePathInto(path, PATH_MAX);
+  if (length <= 0) {
+    return;
+  }
+  path[length] = '\0';
+  hasher->Add(path);
+  hasher->Add(static_cast<int64_t>(File::LastModified(nullptr, path)));
+  File* file = File::Open(nullptr, path, File::kRead);
+  if (file != nullptr) {
+    hasher->Add(file->Length());
+    file->Release();
+  }
+}
+
+struct Definition {
+  const char* name;
+  const char* value;
+};
+
+static int CompareDefinitions(const Definition* a, const Definition* b) {
+  return strcmp(a->name, b->name);
+}
+
+// Adds the -D definitions to [hasher], since the code of the snapshot may
+// have been compiled for their values (e.g. of const String.fromEnvironment
+// in kernel compiled without them). The entries are hashed in name
+// order, which does not depend on the order of the command line.
+static void AddEnvironment(KeyHasher* hasher, SimpleHashMap* environment) {
+  if (environment == nullptr) {
+    return;
+  }
+  MallocGrowableArray<Definition> definitions(environment->size());
+  for (SimpleHashMap::Entry* p = environment->Start(); p != nullptr;
+       p = environment->Next(p)) {
+    definitions.Add({reinterpret_cast<const char*>(p->key),
+                     reinterpret_cast<const char*>(p->value)});
+  }
+  definitions.Sort(CompareDefinitions);
+  hasher->Add(static_cast<int64_t>(definitions.length()));
+  for (intptr_t i = 0; i < definitions.length(); i++) {
+    hasher->Add(definitions[i].name);
+    hasher->Add(definitions[i].value);
+  }
+}
+
+// Adds the --packages file to [hasher], which package: URIs resolve
+// against.
+static void AddPackagesFile(KeyHasher* hasher, const char* packages_file) {
+  if (packages_file == nullptr) {
+    hasher->Add("");
+    return;
+  }
+  char path[PATH_MAX + 1];
+  if (File::GetCanonicalPath(nullptr, packages_file, path, PATH_MAX) !=
+      nullptr) {
+    hasher->Add(path);
+  } else {
+    hasher->Add(packages_file);
+  }
+}
+
+AppSnapshot* AppJITCache::Lookup(const char* cache_dir,
+                                 const char* script_name,
+                                 CommandLineOptions* vm_options,
+                                 SimpleHashMap* environment,
+                                 const char* packages_file,
+                                 bool training,
+                                 bool trace) {
+  ASSERT(training_snapshot_filename_ == nullptr);
+  KeyHasher hasher;
+  if (!AddKernelFile(&hasher, script_name)) {
+    // Only kernel binaries are cached: the kernel of a source script is not
+    // known before the frontend has compiled it.
+    if (trace) {
+      Syslog::PrintErr("app-jit cache: %s is not a kernel file\n",
+                       script_name);
+    }
+    return nullptr;
+  }
+  hasher.Add(Dart_VersionString());
+  AddExecutable(&hasher);
+  for (intptr_t i = 0; i < vm_options->count(); i++) {
+    hasher.Add(vm_options->GetArgument(i));
+  }
+  AddEnvironment(&hasher, environment);
+  AddPackagesFile(&hasher, packages_file);
+
+  if (!Directory::Create(nullptr, cache_dir)) {
+    Syslog::PrintErr("Unable to create the app-jit cache directory '%s'\n",
+                     cache_dir);
+    return nullptr;
+  }
+  cache_dir_ = Utils::StrDup(cache_dir);
+  snapshot_filename_ =
+      Utils::SCreate("%s%s%016" Px64 "%s", cache_dir, File::PathSeparator(),
+                     hasher.hash(), kSnapshotSuffix);
+
+  AppSnapshot* snapshot = Snapshot::TryReadAppSnapshot(
+      snapshot_filename_, /*force_load_elf_from_memory=*/false,
+      /*decode_uri=*/false);
+  if (snapshot != nullptr) {
+    if (trace) {
+      Syslog::PrintErr("app-jit cache: hit %s\n", snapshot_filename_);
+    }
+    // The modification time orders entries for eviction.
+    File::SetLastModified(nullptr, snapshot_filename_,
+                          time(nullptr) * kMillisecondsPerSecond);
+    return snapshot;
+  }
+  if (!training) {
+    if (trace) {
+      Syslog::PrintErr("app-jit cache: miss %s\n", snapshot_filename_);
+    }
+    return nullptr;
+  }
+
+  // Make this a training run which writes a snapshot next to the final
+  // location, so that it can be renamed into place.
+  training_snapshot_filename_ =
+      Utils::SCreate("%s.%" Pd "%s", snapshot_filename_,
+                     Process::CurrentProcessId(), kTemporarySuffix);
+  if (trace) {
+    Syslog::PrintErr("app-jit cache: miss %s, training\n", snapshot_filename_);
+  }
+  return nullptr;
+}
+
+void AppJITCache::Commit() {
+  if (training_snapshot_filename_ == nullptr) {
+    return;
+  }
+  if (!File::Rename(nullptr, training_snapshot_filename_,
+                    snapshot_filename_)) {
+    File::Delete(nullptr, training_snapshot_filename_);
+  }
+  free(training_snapshot_filename_);
+  training_snapshot_filename_ = nullptr;
+  Evict();
+}
+
+class AppJITCacheListing : public DirectoryListing {
+ public:
+  struct Entry {
+    char* path;
+    int64_t size;
+    int64_t last_modified;
+  };
+
+  explicit AppJITCacheListing(const char* dir_name)
+      : DirectoryListing(nullptr, dir_name, /*recursive=*/false,
+                         /*follow_links=*/false),
+        entries_(16),
+        total_size_(0) {}
+
+  ~AppJITCacheListing() {
+    for (intptr_t i = 0; i < entries_.length(); i++) {
+      free(entries_[i].path);
+    }
+  }
+
+  virtual bool HandleDirectory(const char* dir_name) { return true; }
+  virtual bool HandleLink(const char* link_name) { return true; }
+  virtual bool HandleError() { return false; }
+
+  virtual bool HandleFile(const char* file_name) {
+    const int64_t last_modified = File::LastModified(nullptr, file_name);
+    if (HasSuffix(file_name, kTemporarySuffix)) {
+      if ((last_modified >= 0) &&
+          (time(nullptr) - last_modified > kStaleTemporaryFileSeconds)) {
+        File::Delete(nullptr, file_name);
+      }
+    } else if (HasSuffix(file_name, kSnapshotSuffix)) {
+      const int64_t size = File::LengthFromPath(nullptr, file_name);
+      if (size >= 0) {
+        entries_.Add({Utils::StrDup(file_name), size, last_modified});
+        total_size_ += size;
+      }
+    }
+    return true;
+  }
+
+  MallocGrowableArray<Entry>* entries() { return &entries_; }
+  int64_t total_size() const { return total_size_; }
+
+ private:
+  static bool HasSuffix(const char* str, const char* suffix) {
+    const intptr_t length = strlen(str);
+    const intptr_t suffix_length = strlen(suffix);
+    return (length >= suffix_length) &&
+           (strcmp(str + length - suffix_length, suffix) == 0);
+  }
+
+  MallocGrowableArray<Entry> entries_;
+  int64_t total_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppJITCacheListing);
+};
+
+static int CompareByLastModified(const AppJITCacheListing::Entry* a,
+                                 const AppJITCacheListing::Entry* b) {
+  if (a->last_modified < b->last_modified) return -1;
+  if (a->last_modified > b->last_modified) return 1;
+  return 0;
+}
+
+void AppJITCache::Evict() {
+  AppJITCacheListing listing(cache_dir_);
+  Directory::List(&listing);
+  MallocGrowableArray<AppJITCacheListing::Entry>* entries = listing.entries();
+  entries->Sort(CompareByLastModified);
+  int64_t total_size = listing.total_size();
+  // Evict the least recently used snapshots first, but never the one this
+  // run just wrote.
+  for (intptr_t i = 0; (i < entries->length()) && (total_size > kMaxCacheSize);
+       i++) {
+    const AppJITCacheListing::Entry& entry = entries->At(i);
+    if (strcmp(entry.path, snapshot_filename_) == 0) {
+      continue;
+    }
+    if (File::Delete(nullptr, entry.path)) {
+      total_size -= entry.size;
+    }
+  }
+}
+
+}  // namespace bin
+}  // namespace dart
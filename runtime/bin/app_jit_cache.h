@@ -0,0 +1,68 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_BIN_APP_JIT_CACHE_H_
+#define RUNTIME_BIN_APP_JIT_CACHE_H_
+
+#include "bin/snapshot_utils.h"
+#include "platform/globals.h"
+
+namespace dart {
+
+class SimpleHashMap;
+
+namespace bin {
+
+class CommandLineOptions;
+
+// An on-disk cache of app-jit snapshots of kernel scripts.
+//
+// A snapshot is only usable by the VM build and flags that wrote it, so
+// entries are keyed by a hash of the kernel binary, the VM version, the
+// executable, the VM options, the -D environment and the --packages file.
+// Runs only write to the cache when asked to: a training run which misses
+// the cache writes its snapshot to a temporary file on exit, which is then
+// renamed into place so concurrent runs never see a partial snapshot. The
+// least recently used snapshots are evicted once the cache grows beyond
+// [kMaxCacheSize].
+class AppJITCache {
+ public:
+  static constexpr int64_t kMaxCacheSize = 512 * MB;
+
+  // Returns the cached snapshot for the kernel script [script_name] run with
+  // the given options, environment and packages file, or nullptr on a miss.
+  // If [training] is set, after a miss of a cacheable script
+  // [training_snapshot_filename] returns the file the run should write its
+  // app-jit snapshot to. If [trace] is set, the outcome is printed.
+  static AppSnapshot* Lookup(const char* cache_dir,
+                             const char* script_name,
+                             CommandLineOptions* vm_options,
+                             SimpleHashMap* environment,
+                             const char* packages_file,
+                             bool training,
+                             bool trace);
+
+  static const char* training_snapshot_filename() {
+    return training_snapshot_filename_;
+  }
+
+  // Moves the snapshot written by a training run into the cache and evicts
+  // old snapshots. Does nothing if this is not a training run.
+  static void Commit();
+
+ private:
+  static void Evict();
+
+  static char* cache_dir_;
+  static char* snapshot_filename_;
+  static char* training_snapshot_filename_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(AppJITCache);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // RUNTIME_BIN_APP_JIT_CACHE_H_
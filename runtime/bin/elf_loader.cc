@@ -194,6 +194,9 @@ class LoadedElf {
 
   const char* error() { return error_; }
 
+  /// Whether the segments of objects loaded afterwards are read ahead.
+  static void set_prefetch_segments(bool value) { prefetch_segments_ = value; }
+
  private:
   bool ReadHeader();
   bool ReadProgramTable();
@@ -204,6 +207,11 @@ class LoadedElf {
 
   static uword PageSize() { return VirtualMemory::PageSize(); }
 
+  // The alignment of executable segments written with
+  // --elf_huge_page_aligned_text (see Elf::kHugePageSize). Other segments are
+  // aligned to at most 16KB, which is still more than a page on most hosts.
+  static constexpr uword kHugePageSize = 2 * MB;
+
   // Unlike File::Map, allows non-aligned 'start' and 'length'.
   MappedMemory* MapFilePiece(uword start,
                              uword length,
@@ -225,6 +233,7 @@ class LoadedElf {
 
   // Initialized by LoadSegments().
   std::unique_ptr<VirtualMemory> base_;
+  uword image_start_ = 0;
 
   // Initialized by ReadSectionTable().
   std::unique_ptr<MappedMemory> section_table_mapping_;
@@ -239,9 +248,13 @@ class LoadedElf {
   const dart::elf::Symbol* dynamic_symbol_table_ = nullptr;
   uword dynamic_symbol_count_ = 0;
 
+  static bool prefetch_segments_;
+
   DISALLOW_COPY_AND_ASSIGN(LoadedElf);
 };
 
+bool LoadedElf::prefetch_segments_ = false;
+
 #define CHECK(value)                                                           \
   if (!(value)) {                                                              \
     ASSERT(error_ != nullptr);                                                 \
@@ -369,6 +382,7 @@ bool LoadedElf::ReadSectionStringTable() {
 bool LoadedElf::LoadSegments() {
   // Calculate the total amount of virtual memory needed.
   uword total_memory = 0;
+  uword max_alignment = PageSize();
   for (uword i = 0; i < header_.num_program_headers; ++i) {
     const dart::elf::ProgramHeader header = program_table_[i];
 
@@ -380,13 +394,19 @@ bool LoadedElf::LoadSegments() {
         total_memory);
     CHECK_ERROR(Utils::IsPowerOfTwo(header.alignment),
                 "Alignment must be a power of two.");
+    max_alignment =
+        Utils::Maximum(static_cast<uword>(header.alignment), max_alignment);
   }
   total_memory = Utils::RoundUp(total_memory, PageSize());
 
-  base_.reset(VirtualMemory::Allocate(total_memory,
+  // Segments aligned beyond the page size (e.g., for huge pages) are only
+  // aligned in memory if the image is, so reserve room to align its start.
+  const uword reserved_memory = total_memory + max_alignment - PageSize();
+  base_.reset(VirtualMemory::Allocate(reserved_memory,
                                       /*is_executable=*/false,
                                       "dart-compiled-image"));
   CHECK_ERROR(base_ != nullptr, "Could not reserve virtual memory.");
+  image_start_ = Utils::RoundUp(base_->start(), max_alignment);
 
   for (uword i = 0; i < header_.num_program_headers; ++i) {
     const dart::elf::ProgramHeader header = program_table_[i];
@@ -403,7 +423,7 @@ bool LoadedElf::LoadSegments() {
     const intptr_t adjustment = header.memory_offset % PageSize();
 
     void* const memory_start =
-        static_cast<char*>(base_->address()) + memory_offset - adjustment;
+        reinterpret_cast<void*>(image_start_ + memory_offset - adjustment);
     const uword file_start = elf_data_offset_ + file_offset - adjustment;
     const uword length = header.memory_size + adjustment;
 
@@ -444,6 +464,15 @@ bool LoadedElf::LoadSegments() {
     CHECK_ERROR(memory != nullptr, "Could not map segment.");
     CHECK_ERROR(memory->address() == memory_start,
                 "Mapping not at requested address.");
+
+    if (prefetch_segments_) {
+      VirtualMemory::Advise(memory_start, length, VirtualMemory::kWillNeed);
+    }
+    if ((map_type == File::kReadExecute) &&
+        (header.alignment >= kHugePageSize)) {
+      // The snapshot was written with its text aligned for huge pages.
+      VirtualMemory::Advise(memory_start, length, VirtualMemory::kHugePages);
+    }
   }
 
   return true;
@@ -456,11 +485,11 @@ bool LoadedElf::ReadSections() {
     if (strcmp(name, ".dynstr") == 0) {
       CHECK_ERROR(header.memory_offset != 0, ".dynstr must be loaded.");
       dynamic_string_table_ =
-          static_cast<const char*>(base_->address()) + header.memory_offset;
+          reinterpret_cast<const char*>(image_start_ + header.memory_offset);
     } else if (strcmp(name, ".dynsym") == 0) {
       CHECK_ERROR(header.memory_offset != 0, ".dynsym must be loaded.");
       dynamic_symbol_table_ = reinterpret_cast<const dart::elf::Symbol*>(
-          base_->start() + header.memory_offset);
+          image_start_ + header.memory_offset);
       dynamic_symbol_count_ = header.file_size / sizeof(dart::elf::Symbol);
     }
   }
@@ -495,7 +524,7 @@ bool LoadedElf::ResolveSymbols(const uint8_t** vm_data,
     }
 
     if (output != nullptr) {
-      *output = reinterpret_cast<const uint8_t*>(base_->start() + sym.value);
+      *output = reinterpret_cast<const uint8_t*>(image_start_ + sym.value);
     }
   }
 
@@ -608,6 +637,10 @@ DART_EXPORT Dart_LoadedElf* Dart_LoadELF_Memory(
   return reinterpret_cast<Dart_LoadedElf*>(elf.release());
 }
 
+DART_EXPORT void Dart_SetELFPrefetch(bool prefetch) {
+  LoadedElf::set_prefetch_segments(prefetch);
+}
+
 DART_EXPORT void Dart_UnloadELF(Dart_LoadedElf* loaded) {
   delete reinterpret_cast<LoadedElf*>(loaded);
 }
@@ -8,12 +8,14 @@
 
 #include <memory>
 
+#include "bin/app_jit_cache.h"
 #include "bin/builtin.h"
 #include "bin/console.h"
 #include "bin/crashpad.h"
 #include "bin/dartdev_isolate.h"
 #include "bin/dartutils.h"
 #include "bin/dfe.h"
+#include "bin/elf_loader.h"
 #include "bin/error_exit.h"
 #include "bin/eventhandler.h"
 #include "bin/file.h"
@@ -141,6 +143,7 @@ static void OnExitHook(int64_t exit_code) {
   if (exit_code == 0) {
     if (Options::gen_snapshot_kind() == kAppJIT) {
       Snapshot::GenerateAppJIT(Options::snapshot_filename());
+      AppJITCache::Commit();
     }
     WriteDepsFile(main_isolate);
   }
@@ -1060,6 +1063,7 @@ void RunMainIsolate(const char* script_name,
     if (Options::gen_snapshot_kind() == kAppJIT) {
       if (!Dart_IsCompilationError(result)) {
         Snapshot::GenerateAppJIT(Options::snapshot_filename());
+        AppJITCache::Commit();
       }
     }
     CHECK_RESULT(result);
@@ -1212,6 +1216,10 @@ void main(int argc, char** argv) {
 
   Loader::InitOnce();
 
+#if defined(DART_PRECOMPILED_RUNTIME)
+  Dart_SetELFPrefetch(Options::prefetch_snapshot());
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
   auto try_load_snapshots_lambda = [&](void) -> void {
     if (app_snapshot == nullptr) {
       // For testing purposes we add a flag to debug-mode to use the
@@ -1236,6 +1244,18 @@ void main(int argc, char** argv) {
     if (!CheckForInvalidPath(script_name)) {
       Platform::Exit(0);
     }
+#if !defined(DART_PRECOMPILED_RUNTIME)
+    if ((Options::app_jit_cache_dir() != nullptr) &&
+        (Options::gen_snapshot_kind() == kNone)) {
+      app_snapshot = AppJITCache::Lookup(
+          Options::app_jit_cache_dir(), script_name, &vm_options,
+          Options::environment(), Options::packages_file(),
+          Options::app_jit_cache_training(), Options::trace_loading());
+      if (AppJITCache::training_snapshot_filename() != nullptr) {
+        Options::SetAppJITSnapshot(AppJITCache::training_snapshot_filename());
+      }
+    }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
     try_load_snapshots_lambda();
   }
 
@@ -59,6 +59,9 @@ BOOL_OPTIONS_LIST(BOOL_OPTION_DEFINITION)
 #if defined(DEBUG)
 DEBUG_BOOL_OPTIONS_LIST(BOOL_OPTION_DEFINITION)
 #endif
+#if defined(DART_PRECOMPILED_RUNTIME)
+PRECOMPILED_BOOL_OPTIONS_LIST(BOOL_OPTION_DEFINITION)
+#endif
 #undef BOOL_OPTION_DEFINITION
 
 #define SHORT_BOOL_OPTION_DEFINITION(short_name, long_name, variable)          \
@@ -173,6 +176,12 @@ void Options::PrintUsage() {
 "    <snapshot-kind> controls the kind of snapshot, it could be\n"
 "                    kernel(default) or app-jit\n"
 "    <file_name> specifies the file into which the snapshot is written\n"
+"--app-jit-cache=<path>\n"
+"  The path to a cache directory for app-jit snapshots of kernel (.dill)\n"
+"  scripts. Runs of a script with the same VM start from its cached\n"
+"  snapshot. Use --trace-loading to report cache hits and misses.\n"
+"--app-jit-cache-training\n"
+"  With --app-jit-cache, a run without a cached snapshot writes one on exit.\n"
 "--version\n"
 "  Print the SDK version.\n");
   } else {
@@ -219,6 +228,12 @@ void Options::PrintUsage() {
 "  When the VM service is told to bind to a particular port, fallback to 0 if\n"
 "  it fails to bind instead of failing to start.\n"
 "\n"
+#if defined(DART_PRECOMPILED_RUNTIME)
+"--prefetch-snapshot\n"
+"  Read an AOT snapshot ahead when it is loaded instead of paging it in on\n"
+"  first use, which reduces page faults when it is on slow storage.\n"
+"\n"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
 "--root-certs-file=<path>\n"
 "  The path to a file containing the trusted root certificates to use for\n"
 "  secure socket connections.\n"
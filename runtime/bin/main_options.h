@@ -26,7 +26,8 @@ namespace bin {
   V(root_certs_file, root_certs_file)                                          \
   V(root_certs_cache, root_certs_cache)                                        \
   V(namespace, namespc)                                                        \
-  V(write_service_info, vm_write_service_info_filename)
+  V(write_service_info, vm_write_service_info_filename)                        \
+  V(app_jit_cache, app_jit_cache_dir)
 
 // As STRING_OPTIONS_LIST but for boolean valued options. The default value is
 // always false, and the presence of the flag switches the value to true.
@@ -48,7 +49,8 @@ namespace bin {
   V(long_ssl_cert_evaluation, long_ssl_cert_evaluation)                        \
   V(bypass_trusting_system_roots, bypass_trusting_system_roots)                \
   V(delayed_filewatch_callback, delayed_filewatch_callback)                    \
-  V(mark_main_isolate_as_system_isolate, mark_main_isolate_as_system_isolate)
+  V(mark_main_isolate_as_system_isolate, mark_main_isolate_as_system_isolate)  \
+  V(app_jit_cache_training, app_jit_cache_training)
 
 // Boolean flags that have a short form.
 #define SHORT_BOOL_OPTIONS_LIST(V)                                             \
@@ -58,6 +60,10 @@ namespace bin {
 #define DEBUG_BOOL_OPTIONS_LIST(V)                                             \
   V(force_load_elf_from_memory, force_load_elf_from_memory)
 
+// Boolean flags that are only used by the AOT runtime.
+#define PRECOMPILED_BOOL_OPTIONS_LIST(V)                                       \
+  V(prefetch_snapshot, prefetch_snapshot)
+
 // A list of flags taking arguments from an enum. Organized as:
 //   V(flag_name, enum_type, field_name)
 // In main_options.cc there must be a list of strings that matches the enum
@@ -116,6 +122,9 @@ class Options {
 #if defined(DEBUG)
   DEBUG_BOOL_OPTIONS_LIST(BOOL_OPTION_GETTER)
 #endif
+#if defined(DART_PRECOMPILED_RUNTIME)
+  PRECOMPILED_BOOL_OPTIONS_LIST(BOOL_OPTION_GETTER)
+#endif
 #undef BOOL_OPTION_GETTER
 
 #define SHORT_BOOL_OPTION_GETTER(short_name, long_name, variable)              \
@@ -148,6 +157,13 @@ class Options {
 #if !defined(DART_PRECOMPILED_RUNTIME)
   static DFE* dfe() { return dfe_; }
   static void set_dfe(DFE* dfe) { dfe_ = dfe; }
+
+  // Makes this run write an app-jit snapshot to [filename], as if it was
+  // started with --snapshot-kind=app-jit --snapshot=<filename>.
+  static void SetAppJITSnapshot(const char* filename) {
+    gen_snapshot_kind_ = kAppJIT;
+    snapshot_filename_ = filename;
+  }
 #endif  // !defined(DART_PRECOMPILED_RUNTIME)
 
   static void PrintUsage();
@@ -165,6 +181,9 @@ class Options {
 #if defined(DEBUG)
   DEBUG_BOOL_OPTIONS_LIST(BOOL_OPTION_DECL)
 #endif
+#if defined(DART_PRECOMPILED_RUNTIME)
+  PRECOMPILED_BOOL_OPTIONS_LIST(BOOL_OPTION_DECL)
+#endif
 #undef BOOL_OPTION_DECL
 
 #define SHORT_BOOL_OPTION_DECL(short_name, long_name, variable)                \
@@ -215,6 +234,9 @@ class Options {
 #if defined(DEBUG)
   DEBUG_BOOL_OPTIONS_LIST(OPTION_FRIEND)
 #endif
+#if defined(DART_PRECOMPILED_RUNTIME)
+  PRECOMPILED_BOOL_OPTIONS_LIST(OPTION_FRIEND)
+#endif
 #undef OPTION_FRIEND
 
 #define SHORT_BOOL_OPTION_FRIEND(short_name, long_name, variable)              \
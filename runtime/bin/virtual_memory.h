@@ -21,6 +21,14 @@ class VirtualMemory {
     kReadWriteExecute
   };
 
+  enum Advice {
+    // The memory area will be accessed soon, so its pages should be read
+    // ahead.
+    kWillNeed,
+    // The memory area should be backed by huge pages where possible.
+    kHugePages,
+  };
+
   // The reserved memory is unmapped on destruction.
   ~VirtualMemory();
 
@@ -38,6 +46,10 @@ class VirtualMemory {
   static void Protect(void* address, intptr_t size, Protection mode);
   void Protect(Protection mode) { return Protect(address(), size(), mode); }
 
+  // Passes a usage hint for the memory area to the OS. The hint may be
+  // ignored, so this cannot fail.
+  static void Advise(void* address, intptr_t size, Advice advice);
+
   // Reserves and commits a virtual memory segment with size. If a segment of
   // the requested size cannot be allocated, NULL is returned.
   static VirtualMemory* Allocate(intptr_t size,
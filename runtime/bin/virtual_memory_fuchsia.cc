@@ -104,6 +104,10 @@ void VirtualMemory::Protect(void* address, intptr_t size, Protection mode) {
   }
 }
 
+void VirtualMemory::Advise(void* address, intptr_t size, Advice advice) {
+  // Not supported.
+}
+
 }  // namespace bin
 }  // namespace dart
 
@@ -103,6 +103,28 @@ void VirtualMemory::Protect(void* address, intptr_t size, Protection mode) {
   }
 }
 
+void VirtualMemory::Advise(void* address, intptr_t size, Advice advice) {
+  uword start_address = reinterpret_cast<uword>(address);
+  uword end_address = start_address + size;
+  uword page_address = Utils::RoundDown(start_address, PageSize());
+  int posix_advice = 0;
+  switch (advice) {
+    case kWillNeed:
+      posix_advice = MADV_WILLNEED;
+      break;
+    case kHugePages:
+#if defined(MADV_HUGEPAGE)
+      posix_advice = MADV_HUGEPAGE;
+      break;
+#else
+      return;
+#endif
+  }
+  // Failures only mean the hint is not applied.
+  madvise(reinterpret_cast<void*>(page_address), end_address - page_address,
+          posix_advice);
+}
+
 }  // namespace bin
 }  // namespace dart
 
@@ -2491,6 +2491,32 @@ Dart_NewExternalTypedDataWithFinalizer(Dart_TypedData_Type type,
                                        intptr_t external_allocation_size,
                                        Dart_HandleFinalizer callback);
 
+/**
+ * Returns a TypedData object whose zero-initialized data array is shared by
+ * all isolates of the current isolate group.
+ *
+ * Sending the object, or a view on it, to another isolate of the same group
+ * passes it by reference instead of copying its contents, so all isolates
+ * read and write the same memory. The array is freed once the returned object
+ * is no longer reachable from any isolate of the group. Other external typed
+ * data pointing into the array, for example one created with
+ * `Pointer.asTypedList` from its address, is copied when sent and must not
+ * outlive the returned object.
+ *
+ * Accesses from different isolates are not synchronized. Isolates must
+ * coordinate through other means, for example native atomic operations
+ * invoked through FFI on the array's address.
+ *
+ * \param type The type of the data array. Dart_TypedData_kByteData is not
+ *   supported.
+ * \param length The length of the data array (length in type units).
+ *
+ * \return The TypedData object if no error occurs. Otherwise returns
+ *   an error handle.
+ */
+DART_EXPORT Dart_Handle Dart_NewSharedTypedData(Dart_TypedData_Type type,
+                                                intptr_t length);
+
 /**
  * Returns a ByteBuffer object for the typed data.
  *
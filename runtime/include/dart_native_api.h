@@ -116,6 +116,35 @@ typedef struct _Dart_CObject {
  */
 DART_EXPORT bool Dart_PostCObject(Dart_Port port_id, Dart_CObject* message);
 
+/**
+ * Posts a batch of messages on some port. Each element of 'messages' is
+ * delivered as a separate message, in order, as if posted by
+ * Dart_PostCObject. The destination port is looked up and the receiving
+ * isolate is notified once for the whole batch, which makes this cheaper than
+ * calling Dart_PostCObject in a loop when streaming many small messages.
+ *
+ * Dart_CObject_kExternalTypedData elements are transferred without copying
+ * their data.
+ *
+ * The same restrictions on accessing the Dart_CObject graphs as for
+ * Dart_PostCObject apply.
+ *
+ * This function may be called on any thread when the VM is running (that is,
+ * after Dart_Initialize has returned and before Dart_Cleanup has been called).
+ *
+ * \param port_id The destination port.
+ * \param count The number of messages in 'messages'.
+ * \param messages The messages to send.
+ *
+ * \return The number of messages posted. If this is less than 'count', the
+ *   messages from that index on were not enqueued (for example because the
+ *   receiver's message queue is full) and ownership of external typed data in
+ *   them remains with the caller.
+ */
+DART_EXPORT intptr_t Dart_PostCObjectBatch(Dart_Port port_id,
+                                           intptr_t count,
+                                           Dart_CObject** messages);
+
 /**
  * Posts a message on some port. The message will contain the integer 'message'.
  *
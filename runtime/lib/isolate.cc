@@ -113,10 +113,15 @@ DEFINE_NATIVE_ENTRY(SendPortImpl_sendInternal_, 0, 2) {
   // share the same origin port).
   const bool same_group = PortMap::IsReceiverInThisIsolateGroup(
       destination_port_id, isolate->group());
-  // TODO(turnidge): Throw an exception when the return value is false?
-  PortMap::PostMessage(WriteMessage(can_send_any_object, same_group, obj,
-                                    destination_port_id,
-                                    Message::kNormalPriority));
+  // Messages to closed ports are dropped silently, but the sender has to
+  // know when the receiver pushes back.
+  const PortMap::PostResult result = PortMap::TryPostMessage(
+      WriteMessage(can_send_any_object, same_group, obj, destination_port_id,
+                   Message::kNormalPriority));
+  if (result == PortMap::PostResult::kQueueFull) {
+    Exceptions::ThrowStateError(
+        "The message queue of the receiving isolate is full.");
+  }
   return Object::null();
 }
 
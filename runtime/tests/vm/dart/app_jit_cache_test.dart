@@ -0,0 +1,101 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// This test checks that --app-jit-cache starts kernel scripts from cached
+// app-jit snapshots, only writes snapshots in training runs, and does not
+// use the snapshot of a script whose kernel or environment changed.
+
+import "dart:io";
+
+import 'package:expect/expect.dart';
+import 'package:path/path.dart' as path;
+
+import 'use_flag_test_helper.dart';
+
+Future<void> compile(String tempDir, String message, String dill) =>
+    compileSource(tempDir, "main() => print('$message');\n", dill);
+
+Future<void> compileSource(String tempDir, String source, String dill) async {
+  final script = path.join(tempDir, 'program.dart');
+  File(script).writeAsStringSync(source);
+  await run(
+      genKernel, <String>['--platform=$platformDill', '-o', dill, script]);
+}
+
+List<String> cachedSnapshots(String cacheDir) => Directory(cacheDir)
+    .listSync()
+    .map((entry) => entry.path)
+    .where((snapshot) => snapshot.endsWith('.jit'))
+    .toList();
+
+Future<void> runCached(String cacheDir, String dill, String expectedOutput,
+    String expectedOutcome,
+    {bool training = false, List<String> defines = const <String>[]}) async {
+  final result = await runHelper(Platform.executable, <String>[
+    '--app-jit-cache=$cacheDir',
+    if (training) '--app-jit-cache-training',
+    for (final define in defines) '-D$define',
+    '--trace-loading',
+    dill,
+  ]);
+  Expect.equals(0, result.exitCode);
+  Expect.isTrue((result.stdout as String).contains(expectedOutput));
+  Expect.isTrue(
+      (result.stderr as String).contains('app-jit cache: $expectedOutcome'));
+}
+
+main(List<String> args) async {
+  if (isAOTRuntime) {
+    return; // App-jit snapshots are only used by the JIT.
+  }
+
+  if (Platform.isAndroid) {
+    return; // SDK tree and dart_bootstrap not available on the test device.
+  }
+
+  if (!File(platformDill).existsSync()) {
+    throw "Cannot run test as $platformDill does not exist";
+  }
+
+  await withTempDir('app-jit-cache-test', (String tempDir) async {
+    final cacheDir = path.join(tempDir, 'cache');
+    final dill = path.join(tempDir, 'program.dill');
+    await compile(tempDir, 'first', dill);
+
+    // A miss only writes to the cache in a training run.
+    await runCached(cacheDir, dill, 'first', 'miss');
+    Expect.isEmpty(cachedSnapshots(cacheDir));
+    await runCached(cacheDir, dill, 'first', 'miss', training: true);
+    final snapshots = cachedSnapshots(cacheDir);
+    Expect.equals(1, snapshots.length);
+
+    // Later runs start from the cached snapshot.
+    await runCached(cacheDir, dill, 'first', 'hit ${snapshots.single}');
+    await runCached(cacheDir, dill, 'first', 'hit ${snapshots.single}',
+        training: true);
+    Expect.listEquals(snapshots, cachedSnapshots(cacheDir));
+
+    // A changed kernel binary misses the cache.
+    await compile(tempDir, 'second', dill);
+    await runCached(cacheDir, dill, 'second', 'miss', training: true);
+    Expect.equals(2, cachedSnapshots(cacheDir).length);
+    await runCached(cacheDir, dill, 'second', 'hit');
+
+    // Runs which only differ in a -D definition do not share a snapshot.
+    // The program reads the environment at runtime, since gen_kernel would
+    // fold a constant read into the kernel binary.
+    final environmentDill = path.join(tempDir, 'environment.dill');
+    await compileSource(
+        tempDir,
+        "main() => print(new String.fromEnvironment('message'));\n",
+        environmentDill);
+    await runCached(cacheDir, environmentDill, 'third', 'miss',
+        training: true, defines: <String>['message=third']);
+    await runCached(cacheDir, environmentDill, 'third', 'hit',
+        defines: <String>['message=third']);
+    await runCached(cacheDir, environmentDill, 'fourth', 'miss',
+        defines: <String>['message=fourth']);
+    Expect.equals(3, cachedSnapshots(cacheDir).length);
+  });
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// @dart = 2.9
+
+// This test checks that --print-instruction-stats reports the number of
+// spills and reloads, along with the functions with most stack moves.
+
+import "dart:io";
+
+import 'package:expect/expect.dart';
+import 'package:path/path.dart' as path;
+
+import 'use_flag_test_helper.dart';
+
+// The values x, y and z are live across a call, so they are spilled.
+const program = '''
+bool done = false;
+int counter = 0;
+
+@pragma('vm:never-inline')
+bool step() {
+  counter++;
+  if (counter % 3 != 0) return true;
+  if (counter > 30) done = true;
+  return false;
+}
+
+@pragma('vm:never-inline')
+int test(int a, int b) {
+  final x = a * b;
+  final y = a + b;
+  final z = a - b;
+  while (!done) {
+    while (step()) {}
+  }
+  return x * y * z;
+}
+
+main() => print(test(3, 4));
+''';
+
+const maxSpillingFunctions = 20;
+
+main(List<String> args) async {
+  if (!isAOTRuntime) {
+    return; // Running in JIT: AOT binaries not available.
+  }
+
+  if (Platform.isAndroid) {
+    return; // SDK tree and gen_snapshot not available on the test device.
+  }
+
+  // These are the tools we need to be available to run on a given platform:
+  if (!await testExecutable(genSnapshot)) {
+    throw "Cannot run test as $genSnapshot not available";
+  }
+  if (!File(platformDill).existsSync()) {
+    throw "Cannot run test as $platformDill does not exist";
+  }
+
+  await withTempDir('print-instruction-stats-spills-test',
+      (String tempDir) async {
+    final script = path.join(tempDir, 'program.dart');
+    File(script).writeAsStringSync(program);
+    final scriptDill = path.join(tempDir, 'program.dill');
+    await run(genKernel, <String>[
+      '--aot',
+      '--platform=$platformDill',
+      '-o',
+      scriptDill,
+      script,
+    ]);
+
+    final result = await runHelper(genSnapshot, <String>[
+      '--snapshot-kind=app-aot-elf',
+      '--elf=${path.join(tempDir, 'program.so')}',
+      '--print-instruction-stats',
+      scriptDill,
+    ]);
+    Expect.equals(0, result.exitCode);
+    final lines = (result.stderr as String).split('\n');
+
+    final totalSpills = RegExp(r'^\s*(\d+) spills$');
+    final totalReloads = RegExp(r'^\s*(\d+) reloads$');
+    final function = RegExp(r'^\s*(\d+) spills\s+(\d+) reloads    -    .+$');
+    int spills;
+    int reloads;
+    final moves = <int>[];
+    for (final line in lines) {
+      var match = totalSpills.firstMatch(line);
+      if (match != null) {
+        spills = int.parse(match.group(1));
+        continue;
+      }
+      match = totalReloads.firstMatch(line);
+      if (match != null) {
+        reloads = int.parse(match.group(1));
+        continue;
+      }
+      match = function.firstMatch(line);
+      if (match != null) {
+        final functionSpills = int.parse(match.group(1));
+        final functionReloads = int.parse(match.group(2));
+        Expect.isTrue(functionSpills <= spills);
+        Expect.isTrue(functionReloads <= reloads);
+        moves.add(functionSpills + functionReloads);
+      }
+    }
+
+    // The program spills, and so does the core library.
+    Expect.isTrue(spills > 0);
+    Expect.isTrue(reloads > 0);
+    Expect.isTrue(moves.isNotEmpty);
+    Expect.isTrue(moves.length <= maxSpillingFunctions);
+    for (int i = 1; i < moves.length; i++) {
+      Expect.isTrue(moves[i - 1] >= moves[i]);
+    }
+  });
+}
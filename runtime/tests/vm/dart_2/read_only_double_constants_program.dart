@@ -0,0 +1,14 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// @dart = 2.9
+
+// Program for read_only_double_constants_test.dart. Its double constant ends
+// up in the canonical double cluster of the AOT snapshot.
+
+const double kConstant = 3.25;
+
+main() {
+  print(kConstant);
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// @dart = 2.9
+
+// This test ensures that canonical doubles of AOT snapshots are placed in the
+// read-only data image wherever canonical strings are, and are read back
+// correctly from there.
+
+// OtherResources=read_only_double_constants_program.dart
+
+import "dart:convert";
+import "dart:io";
+
+import 'package:expect/expect.dart';
+import 'package:path/path.dart' as path;
+import 'package:vm_snapshot_analysis/v8_profile.dart';
+
+import 'use_flag_test_helper.dart';
+
+main(List<String> args) async {
+  if (!isAOTRuntime) {
+    return; // Running in JIT: AOT binaries not available.
+  }
+
+  if (Platform.isAndroid) {
+    return; // SDK tree and dart_bootstrap not available on the test device.
+  }
+
+  // These are the tools we need to be available to run on a given platform:
+  if (!await testExecutable(genSnapshot)) {
+    throw "Cannot run test as $genSnapshot not available";
+  }
+  if (!await testExecutable(aotRuntime)) {
+    throw "Cannot run test as $aotRuntime not available";
+  }
+  if (!File(platformDill).existsSync()) {
+    throw "Cannot run test as $platformDill does not exist";
+  }
+
+  await withTempDir('read-only-double-constants-test', (String tempDir) async {
+    final cwDir = path.dirname(Platform.script.toFilePath());
+    final script = path.join(cwDir, 'read_only_double_constants_program.dart');
+    final scriptDill = path.join(tempDir, 'program.dill');
+    final profilePath = path.join(tempDir, 'profile.heapsnapshot');
+    final snapshotPath = path.join(tempDir, 'program.so');
+
+    // Compile script to Kernel IR.
+    await run(genKernel, <String>[
+      '--aot',
+      '--platform=$platformDill',
+      '-o',
+      scriptDill,
+      script,
+    ]);
+
+    await run(genSnapshot, <String>[
+      '--snapshot-kind=app-aot-elf',
+      '--elf=$snapshotPath',
+      '--write-v8-snapshot-profile-to=$profilePath',
+      scriptDill,
+    ]);
+
+    final profile =
+        Snapshot.fromJson(jsonDecode(File(profilePath).readAsStringSync()));
+    final types = profile.nodes.map((node) => node.type).toSet();
+    // The read-only data image is not used with compressed pointers. Where it
+    // is used, it holds the canonical strings.
+    if (types.contains('CanonicalString')) {
+      Expect.isTrue(types.contains('CanonicalDouble'),
+          'canonical doubles are not in the read-only data image');
+    }
+
+    final output = await runOutput(aotRuntime, <String>[snapshotPath]);
+    Expect.deepEquals(<String>['3.25'], output);
+  });
+}
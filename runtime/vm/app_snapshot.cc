@@ -22,18 +22,23 @@
 #include "vm/growable_array.h"
 #include "vm/heap/heap.h"
 #include "vm/image_snapshot.h"
+#include "vm/lockers.h"
+#include "vm/lz4_codec.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/program_visitor.h"
+#include "vm/startup_trace.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
+#include "vm/thread_pool.h"
 #include "vm/timeline.h"
 #include "vm/v8_snapshot_writer.h"
 #include "vm/version.h"
 #include "vm/zone_text_buffer.h"
 
 #if !defined(DART_PRECOMPILED_RUNTIME)
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/backend/code_statistics.h"
 #include "vm/compiler/backend/il_printer.h"
 #include "vm/compiler/relocation.h"
@@ -46,8 +51,32 @@ DEFINE_FLAG(bool,
             print_cluster_information,
             false,
             "Print information about clusters written to snapshot");
+DEFINE_FLAG(bool,
+            compress_snapshot_data,
+            false,
+            "Compress the clustered data of program snapshots. Loading them "
+            "needs extra memory and time for decompression.");
+#endif
+
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+DEFINE_FLAG(bool,
+            lazy_code_source_maps,
+            true,
+            "Read CodeSourceMaps from the snapshot on first use instead of "
+            "at startup.");
 #endif
 
+DEFINE_FLAG(int,
+            snapshot_fill_tasks,
+            4,
+            "Maximum number of helper threads used to fill independent "
+            "snapshot clusters (0 fills them on the loading thread).");
+
+DEFINE_FLAG(bool,
+            print_snapshot_load_stats,
+            false,
+            "Print time spent in each phase of loading snapshots.");
+
 #if defined(DART_PRECOMPILER)
 DEFINE_FLAG(charp,
             write_v8_snapshot_profile_to,
@@ -55,6 +84,13 @@ DEFINE_FLAG(charp,
             "Write a snapshot profile in V8 format to a file.");
 #endif  // defined(DART_PRECOMPILER)
 
+// Encodings of the clustered data that follows the version and features.
+static constexpr uint8_t kUncompressedData = 0;
+static constexpr uint8_t kLZ4CompressedData = 1;
+// Compressed data is split into chunks of this size, which are compressed
+// independently so they can be decompressed in parallel.
+static constexpr intptr_t kCompressedDataChunkSize = 256 * KB;
+
 namespace {
 // StorageTrait for HashTable which allows to create hash tables backed by
 // zone memory. Used to compute cluster order for canonical clusters.
@@ -623,6 +659,7 @@ class CanonicalSetDeserializationCluster : public DeserializationCluster {
       return;
     }
 
+    Deserializer::LoadTimer timer(d, &Deserializer::LoadStats::canonical_sets);
     const auto table_length = d->ReadUnsigned();
     first_element_ = d->ReadUnsigned();
     const intptr_t count = stop_index_ - (start_index_ + first_element_);
@@ -2588,6 +2625,8 @@ class PcDescriptorsDeserializationCluster : public DeserializationCluster {
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     ASSERT(!is_canonical());  // Never canonical.
     for (intptr_t id = start_index_; id < stop_index_; id++) {
@@ -2645,10 +2684,14 @@ class CodeSourceMapSerializationCluster : public SerializationCluster {
 };
 #endif  // !DART_PRECOMPILED_RUNTIME
 
+// If [lazy], no CodeSourceMaps are allocated. Instead, each ref is a Smi with
+// the object's index in ObjectStore::lazy_code_source_maps, which holds the
+// stream position of its fill data until Code::EnsureCodeSourceMap reads it
+// (see Deserializer::ReadLazyCodeSourceMap).
 class CodeSourceMapDeserializationCluster : public DeserializationCluster {
  public:
-  CodeSourceMapDeserializationCluster()
-      : DeserializationCluster("CodeSourceMap") {}
+  explicit CodeSourceMapDeserializationCluster(bool lazy)
+      : DeserializationCluster("CodeSourceMap"), lazy_(lazy) {}
   ~CodeSourceMapDeserializationCluster() {}
 
   void ReadAlloc(Deserializer* d) {
@@ -2656,14 +2699,32 @@ class CodeSourceMapDeserializationCluster : public DeserializationCluster {
     PageSpace* old_space = d->heap()->old_space();
     const intptr_t count = d->ReadUnsigned();
     for (intptr_t i = 0; i < count; i++) {
+      const intptr_t length_position = d->position();
       const intptr_t length = d->ReadUnsigned();
-      d->AssignRef(
-          old_space->AllocateSnapshot(CodeSourceMap::InstanceSize(length)));
+      if (lazy_) {
+        d->AssignRef(Smi::New(i));
+        // The fill data repeats the length, so it has the same encoded size.
+        fill_offsets_.Add(fill_size_);
+        fill_size_ += (d->position() - length_position) + length;
+      } else {
+        d->AssignRef(
+            old_space->AllocateSnapshot(CodeSourceMap::InstanceSize(length)));
+      }
     }
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return !lazy_; }
+
+  void PrepareFill(Deserializer* d, intptr_t fill_position) {
+    fill_position_ = fill_position;
+  }
+
   void ReadFill(Deserializer* d, bool primary) {
+    if (lazy_) {
+      d->Advance(fill_size_);
+      return;
+    }
     for (intptr_t id = start_index_; id < stop_index_; id++) {
       const intptr_t length = d->ReadUnsigned();
       CodeSourceMapPtr map = static_cast<CodeSourceMapPtr>(d->Ref(id));
@@ -2674,6 +2735,24 @@ class CodeSourceMapDeserializationCluster : public DeserializationCluster {
       d->ReadBytes(cdata, length);
     }
   }
+
+  void PostLoad(Deserializer* d, const Array& refs, bool primary) {
+    if (!lazy_) return;
+    const intptr_t count = fill_offsets_.length();
+    const auto& maps = Array::Handle(d->zone(), Array::New(count, Heap::kOld));
+    auto& position = Smi::Handle(d->zone());
+    for (intptr_t i = 0; i < count; i++) {
+      position = Smi::New(fill_position_ + fill_offsets_[i]);
+      maps.SetAt(i, position);
+    }
+    d->isolate_group()->object_store()->set_lazy_code_source_maps(maps);
+  }
+
+ private:
+  const bool lazy_;
+  intptr_t fill_size_ = 0;
+  intptr_t fill_position_ = 0;
+  GrowableArray<intptr_t> fill_offsets_;
 };
 
 #if !defined(DART_PRECOMPILED_RUNTIME)
@@ -2740,6 +2819,8 @@ class CompressedStackMapsDeserializationCluster
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     for (intptr_t id = start_index_; id < stop_index_; id++) {
       const intptr_t flags_and_size = d->ReadUnsigned();
@@ -2949,6 +3030,8 @@ class ExceptionHandlersDeserializationCluster : public DeserializationCluster {
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     ASSERT(!is_canonical());  // Never canonical.
     for (intptr_t id = start_index_; id < stop_index_; id++) {
@@ -3038,6 +3121,8 @@ class ContextDeserializationCluster : public DeserializationCluster {
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     ASSERT(!is_canonical());  // Never canonical.
     for (intptr_t id = start_index_; id < stop_index_; id++) {
@@ -3713,6 +3798,8 @@ class InstanceDeserializationCluster
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     intptr_t next_field_offset = next_field_offset_in_words_
                                  << kCompressedWordSizeLog2;
@@ -4544,6 +4631,8 @@ class DoubleDeserializationCluster : public DeserializationCluster {
     ReadAllocFixedSize(d, Double::InstanceSize());
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     for (intptr_t id = start_index_; id < stop_index_; id++) {
       DoublePtr dbl = static_cast<DoublePtr>(d->Ref(id));
@@ -4703,6 +4792,8 @@ class TypedDataDeserializationCluster : public DeserializationCluster {
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     ASSERT(!is_canonical());  // Never canonical.
     intptr_t element_size = TypedData::ElementSizeInBytes(cid_);
@@ -5269,6 +5360,8 @@ class ArrayDeserializationCluster
     stop_index_ = d->next_index();
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     for (intptr_t id = start_index_; id < stop_index_; id++) {
       ArrayPtr array = static_cast<ArrayPtr>(d->Ref(id));
@@ -5346,6 +5439,11 @@ class StringSerializationCluster
       const intptr_t length = Smi::Value(str->untag()->length());
       const intptr_t encoded = EncodeLengthAndCid(length, cid);
       s->WriteUnsigned(encoded);
+      // The hash only depends on the code units, so the reader can install it
+      // instead of hashing every string at startup. Hashes use all their bits,
+      // so they are written as 4 raw bytes rather than 5 encoded ones.
+      const uint32_t hash = String::Hash(str);
+      s->WriteBytes(reinterpret_cast<const uint8_t*>(&hash), sizeof(hash));
       if (cid == kOneByteStringCid) {
         s->WriteBytes(static_cast<OneByteStringPtr>(str)->untag()->data(),
                       length);
@@ -5389,9 +5487,12 @@ class StringDeserializationCluster
       d->AssignRef(old_space->AllocateSnapshot(InstanceSize(length, cid)));
     }
     stop_index_ = d->next_index();
+    d->AddLoadStat(&Deserializer::LoadStats::strings, count);
     BuildCanonicalSetFromLayout(d);
   }
 
+  bool CanReadFillConcurrently() const { return true; }
+
   void ReadFill(Deserializer* d, bool primary) {
     for (intptr_t id = start_index_; id < stop_index_; id++) {
       StringPtr str = static_cast<StringPtr>(d->Ref(id));
@@ -5401,22 +5502,18 @@ class StringDeserializationCluster
       Deserializer::InitializeHeader(str, cid, InstanceSize(length, cid),
                                      primary && is_canonical());
       str->untag()->length_ = Smi::New(length);
-      StringHasher hasher;
+      uint32_t hash;
+      d->ReadBytes(reinterpret_cast<uint8_t*>(&hash), sizeof(hash));
       if (cid == kOneByteStringCid) {
-        for (intptr_t j = 0; j < length; j++) {
-          uint8_t code_unit = d->Read<uint8_t>();
-          static_cast<OneByteStringPtr>(str)->untag()->data()[j] = code_unit;
-          hasher.Add(code_unit);
-        }
+        d->ReadBytes(static_cast<OneByteStringPtr>(str)->untag()->data(),
+                     length);
       } else {
-        for (intptr_t j = 0; j < length; j++) {
-          uint16_t code_unit = d->Read<uint8_t>();
-          code_unit = code_unit | (d->Read<uint8_t>() << 8);
-          static_cast<TwoByteStringPtr>(str)->untag()->data()[j] = code_unit;
-          hasher.Add(code_unit);
-        }
+        d->ReadBytes(reinterpret_cast<uint8_t*>(
+                         static_cast<TwoByteStringPtr>(str)->untag()->data()),
+                     length * 2);
       }
-      String::SetCachedHash(str, hasher.Finalize());
+      String::SetCachedHash(str, hash);
+      ASSERT(String::Hash(str) == hash);
     }
   }
 
@@ -6400,7 +6497,7 @@ intptr_t Serializer::UnsafeRefId(ObjectPtr object) const {
   FATAL("Reference for object %s is unallocated", handle.ToCString());
 }
 
-const char* Serializer::ReadOnlyObjectType(intptr_t cid) {
+const char* Serializer::ReadOnlyObjectType(intptr_t cid, bool is_canonical) {
   switch (cid) {
     case kPcDescriptorsCid:
       return "PcDescriptors";
@@ -6420,6 +6517,14 @@ const char* Serializer::ReadOnlyObjectType(intptr_t cid) {
       return current_loading_unit_id_ <= LoadingUnit::kRootId
                  ? "TwoByteStringCid"
                  : nullptr;
+    case kDoubleCid:
+      // Canonical doubles are immutable and hashed by value, so they can live
+      // in the shared image like strings. They are the only other pointer-free
+      // canonical constants: Mints share their cluster with Smis, which must
+      // stay tagged integers, and SIMD values have no snapshot cluster.
+      return is_canonical && current_loading_unit_id_ <= LoadingUnit::kRootId
+                 ? "CanonicalDouble"
+                 : nullptr;
     default:
       return nullptr;
   }
@@ -6456,7 +6561,7 @@ SerializationCluster* Serializer::NewClusterForClass(intptr_t cid,
   // the memory image, and it might be outside the 4GB region addressable by
   // compressed pointers.
   if (Snapshot::IncludesCode(kind_)) {
-    if (auto const type = ReadOnlyObjectType(cid)) {
+    if (auto const type = ReadOnlyObjectType(cid, is_canonical)) {
       return new (Z) RODataSerializationCluster(Z, type, cid, is_canonical);
     }
   }
@@ -6613,6 +6718,13 @@ intptr_t Serializer::PrepareInstructions() {
   // that allows for mapping return addresses back to Code objects depends on
   // this sorting.
   if (code_cluster_ != nullptr) {
+    // Only the root unit of the isolate snapshot is reordered: the VM
+    // snapshot has no traced or profiled functions, and deferred units are
+    // loaded on demand.
+    if (!vm_ && (current_loading_unit_id_ <= LoadingUnit::kRootId)) {
+      StartupTrace::OrderCodeObjects(thread(), code_cluster_->objects());
+      AotProfile::MoveColdCodeToEnd(thread(), code_cluster_->objects());
+    }
     CodeSerializationCluster::Sort(code_cluster_->objects());
   }
   if ((loading_units_ != nullptr) &&
@@ -6849,8 +6961,49 @@ void Serializer::WriteVersionAndFeatures(bool is_vm_snapshot) {
   WriteBytes(reinterpret_cast<const uint8_t*>(expected_features),
              features_len + 1);
   free(expected_features);
+
+  data_encoding_position_ = bytes_written();
+  stream_->WriteByte(kUncompressedData);
 }
 
+#if !defined(DART_PRECOMPILED_RUNTIME)
+void Serializer::CompressData() {
+  ASSERT(data_encoding_position_ > 0);
+  const intptr_t data_start = data_encoding_position_ + 1;
+  const intptr_t data_size = bytes_written() - data_start;
+  const intptr_t num_chunks =
+      Utils::RoundUp(data_size, kCompressedDataChunkSize) /
+      kCompressedDataChunkSize;
+
+  const intptr_t max_chunk_size =
+      LZ4Codec::MaxCompressedSize(kCompressedDataChunkSize);
+  uint8_t* compressed =
+      reinterpret_cast<uint8_t*>(malloc(num_chunks * max_chunk_size));
+  GrowableArray<intptr_t> chunk_sizes(num_chunks);
+  intptr_t compressed_size = 0;
+  for (intptr_t i = 0; i < num_chunks; i++) {
+    const intptr_t start = i * kCompressedDataChunkSize;
+    const intptr_t size =
+        Utils::Minimum(kCompressedDataChunkSize, data_size - start);
+    const intptr_t chunk_size =
+        LZ4Codec::Compress(stream_->buffer() + data_start + start, size,
+                           compressed + compressed_size);
+    chunk_sizes.Add(chunk_size);
+    compressed_size += chunk_size;
+  }
+
+  stream_->SetPosition(data_encoding_position_);
+  stream_->WriteByte(kLZ4CompressedData);
+  WriteUnsigned(data_size);
+  WriteUnsigned(num_chunks);
+  for (intptr_t i = 0; i < num_chunks; i++) {
+    WriteUnsigned(chunk_sizes[i]);
+  }
+  WriteBytes(compressed, compressed_size);
+  free(compressed);
+}
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
 #if !defined(DART_PRECOMPILED_RUNTIME)
 static int CompareClusters(SerializationCluster* const* a,
                            SerializationCluster* const* b) {
@@ -7029,12 +7182,31 @@ ZoneGrowableArray<Object*>* Serializer::Serialize(SerializationRoots* roots) {
   }
 #endif
 
+  // Reserve a table with the offset of each cluster's fill section and of the
+  // end of the last one, so the reader can fill clusters out of order.
+  const intptr_t num_fill_offsets = clusters.length() + 1;
+  const intptr_t fill_offsets_position = bytes_written();
+  for (intptr_t i = 0; i < num_fill_offsets; i++) {
+    stream_->WriteFixed<uint32_t>(0);
+  }
+  const intptr_t fill_start = bytes_written();
+  GrowableArray<uint32_t> fill_offsets(num_fill_offsets);
+
   for (SerializationCluster* cluster : clusters) {
+    fill_offsets.Add(bytes_written() - fill_start);
     cluster->WriteAndMeasureFill(this);
 #if defined(DEBUG)
     Write<int32_t>(kSectionMarker);
 #endif
   }
+  fill_offsets.Add(bytes_written() - fill_start);
+
+  const intptr_t fill_end = bytes_written();
+  stream_->SetPosition(fill_offsets_position);
+  for (intptr_t i = 0; i < num_fill_offsets; i++) {
+    stream_->WriteFixed<uint32_t>(fill_offsets[i]);
+  }
+  stream_->SetPosition(fill_end);
 
   roots->WriteRoots(this);
 
@@ -7306,10 +7478,230 @@ Deserializer::Deserializer(Thread* thread,
   stream_.SetPosition(offset);
 }
 
+Deserializer::Deserializer(const Deserializer& parent, intptr_t position)
+    : ThreadStackResource(nullptr),
+      heap_(parent.heap_),
+      zone_(nullptr),
+      kind_(parent.kind_),
+      stream_(parent.stream_.AddressOfCurrentPosition() -
+                  parent.stream_.Position(),
+              parent.stream_.Position() + parent.stream_.PendingBytes(),
+              position),
+      image_reader_(parent.image_reader_),
+      num_base_objects_(parent.num_base_objects_),
+      num_objects_(parent.num_objects_),
+      num_clusters_(0),
+      refs_(parent.refs_),
+      next_ref_index_(parent.next_ref_index_),
+      previous_text_offset_(0),
+      clusters_(nullptr),
+      initial_field_table_(parent.initial_field_table_),
+      is_non_root_unit_(parent.is_non_root_unit_),
+      instructions_table_(parent.instructions_table_) {}
+
 Deserializer::~Deserializer() {
   delete[] clusters_;
 }
 
+struct ConcurrentFillWork {
+  intptr_t cluster_index;
+  intptr_t fill_size;
+
+  // Orders the largest fill sections first to balance the load between
+  // threads.
+  static int CompareBySize(const ConcurrentFillWork* a,
+                           const ConcurrentFillWork* b) {
+    if (a->fill_size != b->fill_size) {
+      return a->fill_size > b->fill_size ? -1 : 1;
+    }
+    return a->cluster_index < b->cluster_index ? -1 : 1;
+  }
+};
+
+// Shared state of the threads filling clusters in
+// Deserializer::ReadFillConcurrently. Each thread repeatedly claims the next
+// cluster and fills it with its own Deserializer.
+class ConcurrentFillState {
+ public:
+  ConcurrentFillState(const Deserializer& parent,
+                      DeserializationCluster** clusters,
+                      const intptr_t* fill_positions,
+                      const GrowableArray<ConcurrentFillWork>& work,
+                      bool primary)
+      : parent_(parent),
+        clusters_(clusters),
+        fill_positions_(fill_positions),
+        work_(work),
+        primary_(primary) {}
+
+  void FillClusters() {
+    for (intptr_t i = next_.fetch_add(1); i < work_.length();
+         i = next_.fetch_add(1)) {
+      const intptr_t index = work_[i].cluster_index;
+      Deserializer d(parent_, fill_positions_[index]);
+      clusters_[index]->ReadFill(&d, primary_);
+#if defined(DEBUG)
+      int32_t section_marker = d.Read<int32_t>();
+      ASSERT(section_marker == kSectionMarker);
+#endif
+      ASSERT_EQUAL(fill_positions_[index + 1], d.position());
+    }
+  }
+
+  void TaskStarted() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_++;
+  }
+
+  void TaskFinished() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_--;
+    if (running_tasks_ == 0) {
+      ml.Notify();
+    }
+  }
+
+  void WaitForTasks() {
+    MonitorLocker ml(&monitor_);
+    // The loading thread is in a NoSafepointScope, and helpers never need a
+    // safepoint.
+    while (running_tasks_ > 0) {
+      ml.Wait();
+    }
+  }
+
+ private:
+  const Deserializer& parent_;
+  DeserializationCluster** const clusters_;
+  const intptr_t* const fill_positions_;
+  const GrowableArray<ConcurrentFillWork>& work_;
+  const bool primary_;
+  RelaxedAtomic<intptr_t> next_ = 0;
+  Monitor monitor_;
+  intptr_t running_tasks_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentFillState);
+};
+
+class ConcurrentFillTask : public ThreadPool::Task {
+ public:
+  explicit ConcurrentFillTask(ConcurrentFillState* state) : state_(state) {}
+
+  void Run() {
+    state_->FillClusters();
+    state_->TaskFinished();
+  }
+
+ private:
+  ConcurrentFillState* state_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentFillTask);
+};
+
+void Deserializer::ReadFillConcurrently(const intptr_t* fill_positions,
+                                        bool primary) {
+  // Helper threads only pay off for large fill sections.
+  static constexpr intptr_t kMinConcurrentFillSize = 256 * KB;
+
+  GrowableArray<ConcurrentFillWork> work;
+  intptr_t total_size = 0;
+  for (intptr_t i = 0; i < num_clusters_; i++) {
+    if (clusters_[i]->CanReadFillConcurrently()) {
+      const intptr_t size = fill_positions[i + 1] - fill_positions[i];
+      work.Add({i, size});
+      total_size += size;
+    }
+  }
+  if (work.is_empty()) return;
+  TIMELINE_DURATION(thread(), Isolate, "ReadFillConcurrently");
+
+  work.Sort(ConcurrentFillWork::CompareBySize);
+  ConcurrentFillState state(*this, clusters_, fill_positions, work, primary);
+  intptr_t num_tasks = 0;
+  if ((total_size >= kMinConcurrentFillSize) &&
+      (Dart::thread_pool() != nullptr)) {
+    num_tasks = Utils::Minimum<intptr_t>(FLAG_snapshot_fill_tasks,
+                                         work.length() - 1);
+  }
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    state.TaskStarted();
+    if (!Dart::thread_pool()->Run<ConcurrentFillTask>(&state)) {
+      state.TaskFinished();
+      break;
+    }
+  }
+  state.FillClusters();
+  state.WaitForTasks();
+}
+
+Deserializer::LoadStats Deserializer::last_load_stats_;
+
+Deserializer::LoadTimer::LoadTimer(Deserializer* d, int64_t LoadStats::*stat)
+    : d_(FLAG_print_snapshot_load_stats ? d : nullptr),
+      stat_(stat),
+      start_(d_ != nullptr ? OS::GetCurrentMonotonicMicros() : 0) {}
+
+Deserializer::LoadTimer::~LoadTimer() {
+  if (d_ != nullptr) {
+    d_->load_stats_.*stat_ += OS::GetCurrentMonotonicMicros() - start_;
+  }
+}
+
+void Deserializer::AddLoadStat(int64_t LoadStats::*stat, int64_t value) {
+  if (FLAG_print_snapshot_load_stats) {
+    load_stats_.*stat += value;
+  }
+}
+
+void Deserializer::PrintLoadStats() const {
+  const char* name = isolate_group() == Dart::vm_isolate_group()
+                         ? "VMIsolate"
+                         : (is_non_root_unit_ ? "LoadingUnit" : "Isolate");
+  OS::Print("%s(ReadAllocMicros): %" Pd64 "\n", name, load_stats_.alloc);
+  OS::Print("%s(CanonicalSetMicros): %" Pd64 "\n", name,
+            load_stats_.canonical_sets);
+  OS::Print("%s(ReadFillMicros): %" Pd64 "\n", name, load_stats_.fill);
+  OS::Print("%s(PostLoadMicros): %" Pd64 "\n", name, load_stats_.post_load);
+  OS::Print("%s(CanonicalizeMicros): %" Pd64 "\n", name,
+            load_stats_.canonicalize);
+  OS::Print("%s(StringsWithHash): %" Pd64 "\n", name, load_stats_.strings);
+  OS::Print("%s(CanonicalizedObjects): %" Pd64 "\n", name,
+            load_stats_.canonicalized_objects);
+}
+
+bool Deserializer::CanReadCodeSourceMapsLazily() const {
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+  // Lazily read objects refer to the program snapshot, which stays mapped for
+  // the lifetime of the isolate group. Without compressed pointers,
+  // CodeSourceMaps are already referenced in the read-only data image.
+  if (!FLAG_lazy_code_source_maps || is_non_root_unit_ ||
+      (isolate_group() == Dart::vm_isolate_group())) {
+    return false;
+  }
+  IsolateGroupSource* source = isolate_group()->source();
+  const uint8_t* buffer = CurrentBufferAddress() - position();
+  return (source != nullptr) && (source->snapshot_data == buffer) &&
+         Smi::IsValid(position() + stream_.PendingBytes());
+#else
+  return false;
+#endif
+}
+
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+CodeSourceMapPtr Deserializer::ReadLazyCodeSourceMap(Thread* thread,
+                                                     intptr_t position) {
+  const uint8_t* buffer = thread->isolate_group()->source()->snapshot_data;
+  const Snapshot* snapshot = Snapshot::SetupFromBuffer(buffer);
+  ReadStream stream(buffer, snapshot->length(), position);
+  const intptr_t length = stream.ReadUnsigned();
+  const auto& map = CodeSourceMap::Handle(thread->zone(),
+                                          CodeSourceMap::New(length));
+  NoSafepointScope no_safepoint;
+  stream.ReadBytes(map.ptr()->untag()->data(), length);
+  return map.ptr();
+}
+#endif
+
 DeserializationCluster* Deserializer::ReadCluster() {
   const uint64_t cid_and_canonical = Read<uint64_t>();
   const intptr_t cid = (cid_and_canonical >> 1) & kMaxUint32;
@@ -7347,6 +7739,12 @@ DeserializationCluster* Deserializer::ReadCluster() {
                                                       !is_non_root_unit_, cid);
         }
         break;
+      case kDoubleCid:
+        if (is_canonical && !is_non_root_unit_) {
+          return new (Z) RODataDeserializationCluster(is_canonical,
+                                                      !is_non_root_unit_, cid);
+        }
+        break;
     }
   }
 #endif
@@ -7400,7 +7798,8 @@ DeserializationCluster* Deserializer::ReadCluster() {
       return new (Z) PcDescriptorsDeserializationCluster();
     case kCodeSourceMapCid:
       ASSERT(!is_canonical);
-      return new (Z) CodeSourceMapDeserializationCluster();
+      return new (Z)
+          CodeSourceMapDeserializationCluster(CanReadCodeSourceMapsLazily());
     case kCompressedStackMapsCid:
       ASSERT(!is_canonical);
       return new (Z) CompressedStackMapsDeserializationCluster();
@@ -7889,6 +8288,7 @@ void Deserializer::Deserialize(DeserializationRoots* roots) {
 
     {
       TIMELINE_DURATION(thread(), Isolate, "ReadAlloc");
+      LoadTimer timer(this, &LoadStats::alloc);
       for (intptr_t i = 0; i < num_clusters_; i++) {
         clusters_[i] = ReadCluster();
         TIMELINE_DURATION(thread(), Isolate, clusters_[i]->name());
@@ -7905,15 +8305,35 @@ void Deserializer::Deserialize(DeserializationRoots* roots) {
 
     {
       TIMELINE_DURATION(thread(), Isolate, "ReadFill");
+      LoadTimer timer(this, &LoadStats::fill);
       SafepointWriteRwLocker ml(thread(), isolate_group()->program_lock());
+      intptr_t* fill_positions = zone_->Alloc<intptr_t>(num_clusters_ + 1);
+      for (intptr_t i = 0; i <= num_clusters_; i++) {
+        uint32_t offset;
+        ReadBytes(reinterpret_cast<uint8_t*>(&offset), sizeof(offset));
+        fill_positions[i] = offset;
+      }
+      const intptr_t fill_start = position();
+      for (intptr_t i = 0; i <= num_clusters_; i++) {
+        fill_positions[i] += fill_start;
+      }
+
       for (intptr_t i = 0; i < num_clusters_; i++) {
+        clusters_[i]->PrepareFill(this, fill_positions[i]);
+      }
+      ReadFillConcurrently(fill_positions, primary);
+      for (intptr_t i = 0; i < num_clusters_; i++) {
+        if (clusters_[i]->CanReadFillConcurrently()) continue;
         TIMELINE_DURATION(thread(), Isolate, clusters_[i]->name());
+        set_position(fill_positions[i]);
         clusters_[i]->ReadFill(this, primary);
 #if defined(DEBUG)
         int32_t section_marker = Read<int32_t>();
         ASSERT(section_marker == kSectionMarker);
 #endif
+        ASSERT_EQUAL(fill_positions[i + 1], position());
       }
+      set_position(fill_positions[num_clusters_]);
     }
 
     roots->ReadRoots(this);
@@ -7938,13 +8358,28 @@ void Deserializer::Deserialize(DeserializationRoots* roots) {
 
   {
     TIMELINE_DURATION(thread(), Isolate, "PostLoad");
+    LoadTimer timer(this, &LoadStats::post_load);
     for (intptr_t i = 0; i < num_clusters_; i++) {
       TIMELINE_DURATION(thread(), Isolate, clusters_[i]->name());
+      // Canonical objects of secondary snapshots are inserted one by one into
+      // the existing canonical tables.
+      const bool canonicalize = !primary && clusters_[i]->is_canonical();
+      LoadTimer canonicalize_timer(canonicalize ? this : nullptr,
+                                   &LoadStats::canonicalize);
+      if (canonicalize) {
+        AddLoadStat(&LoadStats::canonicalized_objects,
+                    clusters_[i]->num_objects());
+      }
       clusters_[i]->PostLoad(this, refs, primary);
     }
   }
 
-  if (isolate_group->snapshot_is_dontneed_safe()) {
+  if (FLAG_print_snapshot_load_stats) {
+    PrintLoadStats();
+    last_load_stats_ = load_stats_;
+  }
+
+  if (buffer_is_mapped_ && isolate_group->snapshot_is_dontneed_safe()) {
     size_t clustered_length = reinterpret_cast<uword>(CurrentBufferAddress()) -
                               reinterpret_cast<uword>(clustered_start);
     VirtualMemory::DontNeed(const_cast<void*>(clustered_start),
@@ -8044,6 +8479,9 @@ void FullSnapshotWriter::WriteProgramSnapshot(
   if (units != nullptr) {
     (*units)[LoadingUnit::kRootId]->set_objects(objects);
   }
+  if (FLAG_compress_snapshot_data) {
+    CompressData(&serializer);
+  }
   serializer.FillHeader(serializer.kind());
   clustered_isolate_size_ = serializer.bytes_written();
   heap_isolate_size_ = serializer.bytes_heap_allocated();
@@ -8065,6 +8503,14 @@ void FullSnapshotWriter::WriteProgramSnapshot(
   isolate_snapshot_size_ = serializer.bytes_written();
 }
 
+void FullSnapshotWriter::CompressData(Serializer* serializer) {
+  TIMELINE_DURATION(thread(), Isolate, "CompressData");
+  const int64_t start = OS::GetCurrentMonotonicMicros();
+  uncompressed_isolate_size_ = serializer->bytes_written();
+  serializer->CompressData();
+  compression_micros_ += OS::GetCurrentMonotonicMicros() - start;
+}
+
 void FullSnapshotWriter::WriteUnitSnapshot(
     GrowableArray<LoadingUnitSerializationData*>* units,
     LoadingUnitSerializationData* unit,
@@ -8083,6 +8529,9 @@ void FullSnapshotWriter::WriteUnitSnapshot(
   UnitSerializationRoots roots(unit);
   unit->set_objects(serializer.Serialize(&roots));
 
+  if (FLAG_compress_snapshot_data) {
+    CompressData(&serializer);
+  }
   serializer.FillHeader(serializer.kind());
   clustered_isolate_size_ = serializer.bytes_written();
 
@@ -8119,6 +8568,12 @@ void FullSnapshotWriter::WriteFullSnapshot(
   if (FLAG_print_snapshot_sizes) {
     OS::Print("VMIsolate(CodeSize): %" Pd "\n", clustered_vm_size_);
     OS::Print("Isolate(CodeSize): %" Pd "\n", clustered_isolate_size_);
+    if (FLAG_compress_snapshot_data) {
+      OS::Print("Isolate(UncompressedCodeSize): %" Pd "\n",
+                uncompressed_isolate_size_);
+      OS::Print("Isolate(CompressionMicros): %" Pd64 "\n",
+                compression_micros_);
+    }
     OS::Print("ReadOnlyData(CodeSize): %" Pd "\n", mapped_data_size_);
     OS::Print("Instructions(CodeSize): %" Pd "\n", mapped_text_size_);
     OS::Print("Total(CodeSize): %" Pd "\n",
@@ -8302,12 +8757,174 @@ bool SnapshotHeaderReader::NullSafetyFromSnapshot(const Snapshot* snapshot) {
   return null_safety;
 }
 
+// Decompresses the chunks of compressed snapshot data on the loading thread
+// and helper threads.
+class SnapshotDecompressionState {
+ public:
+  SnapshotDecompressionState(const uint8_t* compressed,
+                             const intptr_t* chunk_offsets,
+                             intptr_t num_chunks,
+                             uint8_t* data,
+                             intptr_t data_size)
+      : compressed_(compressed),
+        chunk_offsets_(chunk_offsets),
+        num_chunks_(num_chunks),
+        data_(data),
+        data_size_(data_size) {}
+
+  void DecompressChunks() {
+    for (intptr_t i = next_.fetch_add(1); i < num_chunks_;
+         i = next_.fetch_add(1)) {
+      const intptr_t start = i * kCompressedDataChunkSize;
+      const intptr_t size =
+          Utils::Minimum(kCompressedDataChunkSize, data_size_ - start);
+      if (!LZ4Codec::Decompress(compressed_ + chunk_offsets_[i],
+                                chunk_offsets_[i + 1] - chunk_offsets_[i],
+                                data_ + start, size)) {
+        failed_ = true;
+      }
+    }
+  }
+
+  bool failed() const { return failed_; }
+
+  void TaskStarted() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_++;
+  }
+
+  void TaskFinished() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_--;
+    if (running_tasks_ == 0) {
+      ml.Notify();
+    }
+  }
+
+  void WaitForTasks(Thread* thread) {
+    MonitorLocker ml(&monitor_);
+    while (running_tasks_ > 0) {
+      ml.WaitWithSafepointCheck(thread);
+    }
+  }
+
+ private:
+  const uint8_t* const compressed_;
+  const intptr_t* const chunk_offsets_;
+  const intptr_t num_chunks_;
+  uint8_t* const data_;
+  const intptr_t data_size_;
+  RelaxedAtomic<intptr_t> next_ = 0;
+  RelaxedAtomic<bool> failed_ = false;
+  Monitor monitor_;
+  intptr_t running_tasks_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SnapshotDecompressionState);
+};
+
+class SnapshotDecompressionTask : public ThreadPool::Task {
+ public:
+  explicit SnapshotDecompressionTask(SnapshotDecompressionState* state)
+      : state_(state) {}
+
+  void Run() {
+    state_->DecompressChunks();
+    state_->TaskFinished();
+  }
+
+ private:
+  SnapshotDecompressionState* state_;
+
+  DISALLOW_COPY_AND_ASSIGN(SnapshotDecompressionTask);
+};
+
+char* FullSnapshotReader::DecompressData(intptr_t* offset) {
+  ReadStream stream(buffer_, size_, *offset);
+  if (stream.PendingBytes() < 1) {
+    return Utils::StrDup("Snapshot is truncated");
+  }
+  uint8_t encoding;
+  stream.ReadBytes(&encoding, 1);
+  if (encoding == kUncompressedData) {
+    *offset = stream.Position();
+    return nullptr;
+  }
+  if (encoding != kLZ4CompressedData) {
+    return Utils::StrDup("Unknown snapshot data encoding");
+  }
+
+  TIMELINE_DURATION(thread_, Isolate, "DecompressData");
+  const int64_t start = OS::GetCurrentMonotonicMicros();
+  const intptr_t data_size = stream.ReadUnsigned();
+  const intptr_t num_chunks = stream.ReadUnsigned();
+  if ((data_size < 0) ||
+      (num_chunks != Utils::RoundUp(data_size, kCompressedDataChunkSize) /
+                         kCompressedDataChunkSize)) {
+    return Utils::StrDup("Snapshot data is corrupt");
+  }
+  std::unique_ptr<intptr_t[]> chunk_offsets(new intptr_t[num_chunks + 1]);
+  chunk_offsets[0] = 0;
+  for (intptr_t i = 0; i < num_chunks; i++) {
+    chunk_offsets[i + 1] = chunk_offsets[i] + stream.ReadUnsigned();
+  }
+  if (chunk_offsets[num_chunks] != stream.PendingBytes()) {
+    return Utils::StrDup("Snapshot data is corrupt");
+  }
+
+  // Keep the prefix, so positions in the stream are the same as when it was
+  // written.
+  const intptr_t prefix_size = *offset + 1;
+  uint8_t* data = new uint8_t[prefix_size + data_size];
+  decompressed_data_.reset(data);
+  memmove(data, buffer_, prefix_size);
+  data[*offset] = kUncompressedData;
+
+  SnapshotDecompressionState state(stream.AddressOfCurrentPosition(),
+                                   chunk_offsets.get(), num_chunks,
+                                   data + prefix_size, data_size);
+  intptr_t num_tasks = 0;
+  if (Dart::thread_pool() != nullptr) {
+    num_tasks =
+        Utils::Minimum<intptr_t>(FLAG_snapshot_fill_tasks, num_chunks - 1);
+  }
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    state.TaskStarted();
+    if (!Dart::thread_pool()->Run<SnapshotDecompressionTask>(&state)) {
+      state.TaskFinished();
+      break;
+    }
+  }
+  state.DecompressChunks();
+  state.WaitForTasks(thread_);
+  if (state.failed()) {
+    decompressed_data_.reset();
+    return Utils::StrDup("Snapshot data is corrupt");
+  }
+
+  if (isolate_group()->snapshot_is_dontneed_safe()) {
+    VirtualMemory::DontNeed(const_cast<uint8_t*>(buffer_ + prefix_size),
+                            size_ - prefix_size);
+  }
+  buffer_ = data;
+  size_ = prefix_size + data_size;
+  *offset = prefix_size;
+
+  if (FLAG_print_snapshot_load_stats) {
+    OS::Print("Isolate(DecompressMicros): %" Pd64 "\n",
+              OS::GetCurrentMonotonicMicros() - start);
+  }
+  return nullptr;
+}
+
 ApiErrorPtr FullSnapshotReader::ReadVMSnapshot() {
   SnapshotHeaderReader header_reader(kind_, buffer_, size_);
 
   intptr_t offset = 0;
   char* error = header_reader.VerifyVersionAndFeatures(
       /*isolate_group=*/nullptr, &offset);
+  if (error == nullptr) {
+    error = DecompressData(&offset);
+  }
   if (error != nullptr) {
     return ConvertToApiError(error);
   }
@@ -8315,6 +8932,7 @@ ApiErrorPtr FullSnapshotReader::ReadVMSnapshot() {
   Deserializer deserializer(thread_, kind_, buffer_, size_, data_image_,
                             instructions_image_, /*is_non_root_unit=*/false,
                             offset);
+  deserializer.set_buffer_is_mapped(decompressed_data_ == nullptr);
   ApiErrorPtr api_error = deserializer.VerifyImageAlignment();
   if (api_error != ApiError::null()) {
     return api_error;
@@ -8349,6 +8967,9 @@ ApiErrorPtr FullSnapshotReader::ReadProgramSnapshot() {
   intptr_t offset = 0;
   char* error =
       header_reader.VerifyVersionAndFeatures(thread_->isolate_group(), &offset);
+  if (error == nullptr) {
+    error = DecompressData(&offset);
+  }
   if (error != nullptr) {
     return ConvertToApiError(error);
   }
@@ -8356,6 +8977,7 @@ ApiErrorPtr FullSnapshotReader::ReadProgramSnapshot() {
   Deserializer deserializer(thread_, kind_, buffer_, size_, data_image_,
                             instructions_image_, /*is_non_root_unit=*/false,
                             offset);
+  deserializer.set_buffer_is_mapped(decompressed_data_ == nullptr);
   ApiErrorPtr api_error = deserializer.VerifyImageAlignment();
   if (api_error != ApiError::null()) {
     return api_error;
@@ -8372,6 +8994,19 @@ ApiErrorPtr FullSnapshotReader::ReadProgramSnapshot() {
 
   ProgramDeserializationRoots roots(thread_->isolate_group()->object_store());
   deserializer.Deserialize(&roots);
+  if (decompressed_data_ != nullptr) {
+    // The dispatch table snapshot points into the decompressed data. Keep a
+    // copy of only the table and free the rest.
+    auto isolate_group = thread_->isolate_group();
+    if (isolate_group->dispatch_table_snapshot() != nullptr) {
+      const intptr_t size = isolate_group->dispatch_table_snapshot_size();
+      std::unique_ptr<uint8_t[]> copy(new uint8_t[size]);
+      memmove(copy.get(), isolate_group->dispatch_table_snapshot(), size);
+      isolate_group->set_dispatch_table_snapshot(copy.get());
+      isolate_group->set_dispatch_table_snapshot_copy(std::move(copy));
+    }
+    decompressed_data_.reset();
+  }
 
   InitializeBSS();
 
@@ -8383,6 +9018,9 @@ ApiErrorPtr FullSnapshotReader::ReadUnitSnapshot(const LoadingUnit& unit) {
   intptr_t offset = 0;
   char* error =
       header_reader.VerifyVersionAndFeatures(thread_->isolate_group(), &offset);
+  if (error == nullptr) {
+    error = DecompressData(&offset);
+  }
   if (error != nullptr) {
     return ConvertToApiError(error);
   }
@@ -8390,6 +9028,7 @@ ApiErrorPtr FullSnapshotReader::ReadUnitSnapshot(const LoadingUnit& unit) {
   Deserializer deserializer(
       thread_, kind_, buffer_, size_, data_image_, instructions_image_,
       /*is_non_root_unit=*/unit.id() != LoadingUnit::kRootId, offset);
+  deserializer.set_buffer_is_mapped(decompressed_data_ == nullptr);
   ApiErrorPtr api_error = deserializer.VerifyImageAlignment();
   if (api_error != ApiError::null()) {
     return api_error;
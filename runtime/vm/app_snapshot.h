@@ -147,6 +147,17 @@ class DeserializationCluster : public ZoneAllocated {
   // Initialize the cluster's objects. Do not touch the memory of other objects.
   virtual void ReadFill(Deserializer* deserializer, bool primary) = 0;
 
+  // Whether ReadFill only reads the cluster's fill section and the ref array,
+  // and only writes the memory of the cluster's objects. Such clusters are
+  // filled before all others and may be filled on helper threads, which have
+  // no current Thread or zone.
+  virtual bool CanReadFillConcurrently() const { return false; }
+
+  // Called after all clusters are allocated and before any is filled, with
+  // the stream position of the cluster's fill section.
+  virtual void PrepareFill(Deserializer* deserializer, intptr_t fill_position) {
+  }
+
   // Complete any action that requires the full graph to be deserialized, such
   // as rehashing.
   virtual void PostLoad(Deserializer* deserializer,
@@ -159,6 +170,7 @@ class DeserializationCluster : public ZoneAllocated {
 
   const char* name() const { return name_; }
   bool is_canonical() const { return is_canonical_; }
+  intptr_t num_objects() const { return stop_index_ - start_index_; }
 
  protected:
   void ReadAllocFixedSize(Deserializer* deserializer, intptr_t instance_size);
@@ -258,6 +270,12 @@ class Serializer : public ThreadStackResource {
 
   void WriteVersionAndFeatures(bool is_vm_snapshot);
 
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  // Replaces the clustered data written after the version and features with
+  // its compressed form. Must be called before FillHeader.
+  void CompressData();
+#endif
+
   ZoneGrowableArray<Object*>* Serialize(SerializationRoots* roots);
   void PrintSnapshotSizes();
 
@@ -491,7 +509,7 @@ class Serializer : public ThreadStackResource {
   }
 
  private:
-  const char* ReadOnlyObjectType(intptr_t cid);
+  const char* ReadOnlyObjectType(intptr_t cid, bool is_canonical);
   void FlushProfile();
 
   Heap* heap_;
@@ -513,6 +531,7 @@ class Serializer : public ThreadStackResource {
 
   intptr_t dispatch_table_size_ = 0;
   intptr_t bytes_heap_allocated_ = 0;
+  intptr_t data_encoding_position_ = -1;
   intptr_t instructions_table_len_ = 0;
 
   // True if writing VM snapshot, false for Isolate snapshot.
@@ -611,6 +630,10 @@ class Deserializer : public ThreadStackResource {
                intptr_t offset = 0);
   ~Deserializer();
 
+  // Creates a deserializer for filling clusters on a helper thread. It shares
+  // the ref array of [parent] and reads from [position] in its stream.
+  Deserializer(const Deserializer& parent, intptr_t position);
+
   // Verifies the image alignment.
   //
   // Returns ApiError::null() on success and an ApiError with an an appropriate
@@ -693,6 +716,62 @@ class Deserializer : public ThreadStackResource {
 
   DeserializationCluster* ReadCluster();
 
+  // Fills all clusters that CanReadFillConcurrently, using helper threads if
+  // their fill sections are large enough. [fill_positions] holds the stream
+  // position of each cluster's fill section.
+  void ReadFillConcurrently(const intptr_t* fill_positions, bool primary);
+
+  // Collected when --print_snapshot_load_stats is given. The first fields are
+  // the microseconds spent in each phase of Deserialize: [canonical_sets] is
+  // part of [alloc] and [canonicalize] is part of [post_load].
+  struct LoadStats {
+    int64_t alloc = 0;
+    int64_t canonical_sets = 0;
+    int64_t fill = 0;
+    int64_t post_load = 0;
+    int64_t canonicalize = 0;
+    // Strings whose hash was read from the snapshot instead of computed.
+    int64_t strings = 0;
+    // Canonical objects hashed into existing canonical tables, because the
+    // tables could not be built from the snapshot's layout.
+    int64_t canonicalized_objects = 0;
+  };
+
+  // Adds the time until it goes out of scope to [stat] of [d]'s stats. Does
+  // nothing if [d] is nullptr or stats are not collected.
+  class LoadTimer : public ValueObject {
+   public:
+    LoadTimer(Deserializer* d, int64_t LoadStats::*stat);
+    ~LoadTimer();
+
+   private:
+    Deserializer* const d_;
+    int64_t LoadStats::*const stat_;
+    const int64_t start_;
+
+    DISALLOW_COPY_AND_ASSIGN(LoadTimer);
+  };
+
+  void PrintLoadStats() const;
+
+  // Adds [value] to [stat] if stats are collected.
+  void AddLoadStat(int64_t LoadStats::*stat, int64_t value);
+
+  // The stats of the most recent load that collected them. Used by tests.
+  static LoadStats last_load_stats() { return last_load_stats_; }
+
+  // Whether the CodeSourceMap cluster is read on first access instead of
+  // during deserialization.
+  bool CanReadCodeSourceMapsLazily() const;
+
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+  // Reads a CodeSourceMap left in the program snapshot of the current isolate
+  // group by a lazy CodeSourceMap cluster. [position] is the stream position
+  // of its fill data.
+  static CodeSourceMapPtr ReadLazyCodeSourceMap(Thread* thread,
+                                                intptr_t position);
+#endif
+
   void ReadDispatchTable() {
     ReadDispatchTable(&stream_, /*deferred=*/false, -1, -1);
   }
@@ -707,6 +786,9 @@ class Deserializer : public ThreadStackResource {
   Snapshot::Kind kind() const { return kind_; }
   FieldTable* initial_field_table() const { return initial_field_table_; }
   bool is_non_root_unit() const { return is_non_root_unit_; }
+  // Whether the buffer is the embedder's snapshot mapping, which may be
+  // released after loading if the isolate group allows it.
+  void set_buffer_is_mapped(bool value) { buffer_is_mapped_ = value; }
   void set_code_start_index(intptr_t value) { code_start_index_ = value; }
   intptr_t code_start_index() { return code_start_index_; }
   const InstructionsTable& instructions_table() const {
@@ -731,6 +813,9 @@ class Deserializer : public ThreadStackResource {
   FieldTable* initial_field_table_;
   const bool is_non_root_unit_;
   InstructionsTable& instructions_table_;
+  LoadStats load_stats_;
+  static LoadStats last_load_stats_;
+  bool buffer_is_mapped_ = true;
 };
 
 #define ReadFromTo(obj, ...) d->ReadFromTo(obj, ##__VA_ARGS__);
@@ -768,6 +853,8 @@ class FullSnapshotWriter {
   void WriteProgramSnapshot(ZoneGrowableArray<Object*>* objects,
                             GrowableArray<LoadingUnitSerializationData*>* data);
 
+  void CompressData(Serializer* serializer);
+
   Thread* thread_;
   Snapshot::Kind kind_;
   NonStreamingWriteStream* const vm_snapshot_data_;
@@ -784,6 +871,8 @@ class FullSnapshotWriter {
   intptr_t mapped_text_size_ = 0;
   intptr_t heap_vm_size_ = 0;
   intptr_t heap_isolate_size_ = 0;
+  intptr_t uncompressed_isolate_size_ = 0;
+  int64_t compression_micros_ = 0;
 
   V8SnapshotProfileWriter* profile_writer_ = nullptr;
 
@@ -807,12 +896,20 @@ class FullSnapshotReader {
   ApiErrorPtr ConvertToApiError(char* message);
   void InitializeBSS();
 
+  // Reads the encoding of the data at [offset]. If it is compressed,
+  // decompresses it into [decompressed_data_] and updates [buffer_], [size_]
+  // and [offset] to refer to it.
+  //
+  // Returns null on success and a malloc()ed error on failure.
+  char* DecompressData(intptr_t* offset);
+
   Snapshot::Kind kind_;
   Thread* thread_;
   const uint8_t* buffer_;
   intptr_t size_;
   const uint8_t* data_image_;
   const uint8_t* instructions_image_;
+  std::unique_ptr<uint8_t[]> decompressed_data_;
 
   DISALLOW_COPY_AND_ASSIGN(FullSnapshotReader);
 };
@@ -1207,6 +1207,9 @@ ErrorPtr ClassFinalizer::LoadClassMembers(const Class& cls) {
   if (setjmp(*jump.Set()) == 0) {
 #if !defined(DART_PRECOMPILED_RUNTIME)
     cls.EnsureDeclarationLoaded();
+    // Classes of libraries which were loaded on first use may still be
+    // pending.
+    FinalizeTypesInClass(cls);
 #endif
     ASSERT(cls.is_type_finalized());
     ClassFinalizer::FinalizeClass(cls);
@@ -5,6 +5,7 @@
 #include "vm/compiler/aot/aot_call_specializer.h"
 
 #include "vm/bit_vector.h"
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/aot/precompiler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
 #include "vm/compiler/backend/flow_graph_compiler.h"
@@ -36,6 +37,12 @@ DEFINE_FLAG(int,
             5,
             "If a call receiver is known to be of at most this many classes, "
             "generate exhaustive class tests instead of a megamorphic call");
+DEFINE_FLAG(int,
+            aot_profile_receiver_coverage,
+            90,
+            "Percentage of calls recorded in the AOT profile which the most "
+            "frequent receiver classes of a call must cover for the call to "
+            "be devirtualized speculatively.");
 
 // Quick access to the current isolate and zone.
 #define IG (isolate_group())
@@ -939,6 +946,10 @@ void AotCallSpecializer::VisitInstanceCall(InstanceCallInstr* instr) {
     }
   }
 
+  if (targets.is_empty() && TryDevirtualizeUsingProfile(instr)) {
+    return;
+  }
+
   // More than one target. Generate generic polymorphic call without
   // deoptimization.
   if (targets.length() > 0) {
@@ -953,6 +964,64 @@ void AotCallSpecializer::VisitInstanceCall(InstanceCallInstr* instr) {
   }
 }
 
+bool AotCallSpecializer::TryDevirtualizeUsingProfile(InstanceCallInstr* instr) {
+  const AotProfile* profile = CompilerState::Current().aot_profile();
+  if (profile == nullptr) {
+    return false;
+  }
+  // Calls inlined into this graph were specialized along with their callee,
+  // and their positions refer to the callee.
+  if (instr->has_inlining_id() &&
+      instr->inlining_id() != flow_graph()->inlining_id()) {
+    return false;
+  }
+  const AotProfile::FunctionProfile* function_profile =
+      profile->LookupFunction(flow_graph()->function());
+  if (function_profile == nullptr) {
+    return false;
+  }
+  const AotProfile::CallSite* site =
+      function_profile->LookupCallSite(instr->token_pos());
+  if (site == nullptr || site->receivers().is_empty()) {
+    return false;
+  }
+
+  // Check the most frequent receiver classes, and leave the others to a
+  // generic call.
+  const auto& receivers = site->receivers();
+  const Array& args_desc_array =
+      Array::Handle(Z, instr->GetArgumentsDescriptor());
+  const ICData& ic_data = ICData::ZoneHandle(
+      Z, ICData::New(flow_graph()->function(), instr->function_name(),
+                     args_desc_array, DeoptId::kNone,
+                     /* args_tested = */ 1, ICData::kOptimized));
+  Class& cls = Class::Handle(Z);
+  Function& target = Function::Handle(Z);
+  intptr_t total = 0;
+  intptr_t covered = 0;
+  for (intptr_t i = 0; i < receivers.length(); i++) {
+    total += receivers[i].count;
+    if (i >= FLAG_max_polymorphic_checks) continue;
+    cls = IG->class_table()->At(receivers[i].cid);
+    target = instr->ResolveForReceiverClass(cls);
+    if (target.IsNull()) continue;
+    ic_data.AddReceiverCheck(receivers[i].cid, target, receivers[i].count);
+    covered += receivers[i].count;
+  }
+  if (covered == 0 ||
+      covered * 100 < total * FLAG_aot_profile_receiver_coverage) {
+    return false;
+  }
+
+  const CallTargets* targets = CallTargets::Create(Z, ic_data);
+  PolymorphicInstanceCallInstr* call = PolymorphicInstanceCallInstr::FromCall(
+      Z, instr, *targets, /* complete = */ false);
+  call->set_targets_from_profile();
+  call->set_total_call_count(total);
+  instr->ReplaceWith(call, current_iterator());
+  return true;
+}
+
 void AotCallSpecializer::VisitStaticCall(StaticCallInstr* instr) {
   if (TryInlineFieldAccess(instr)) {
     return;
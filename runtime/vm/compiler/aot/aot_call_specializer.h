@@ -38,6 +38,10 @@ class AotCallSpecializer : public CallSpecializer {
 
   bool TryCreateICDataForUniqueTarget(InstanceCallInstr* call);
 
+  // Replace a call whose receivers are known from the AOT profile by checks
+  // for its most frequent receiver classes, followed by a generic call.
+  bool TryDevirtualizeUsingProfile(InstanceCallInstr* call);
+
   bool RecognizeRuntimeTypeGetter(InstanceCallInstr* call);
   bool TryReplaceWithHaveSameRuntimeType(TemplateDartCall<0>* call);
 
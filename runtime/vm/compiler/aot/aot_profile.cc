@@ -0,0 +1,478 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/aot/aot_profile.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "platform/text_buffer.h"
+#include "vm/class_table.h"
+#include "vm/dart.h"
+#include "vm/flags.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/program_visitor.h"
+#include "vm/startup_trace.h"
+
+namespace dart {
+
+DECLARE_FLAG(charp, write_aot_profile_to);
+
+DEFINE_FLAG(charp,
+            use_aot_profile,
+            nullptr,
+            "Guide devirtualization, inlining and block layout of AOT "
+            "compiled code by the profile in the given file.");
+
+void AotProfile::CallSite::AddReceiver(intptr_t cid, intptr_t count) {
+  for (intptr_t i = 0; i < receivers_.length(); i++) {
+    if (receivers_[i].cid == cid) {
+      receivers_[i].count += count;
+      return;
+    }
+  }
+  receivers_.Add({cid, count});
+}
+
+// Collects the call counts of unoptimized code into a text buffer.
+class AotProfileWriter : public FunctionVisitor {
+ public:
+  AotProfileWriter(Zone* zone, ClassTable* class_table)
+      : zone_(zone),
+        class_table_(class_table),
+        buffer_(64 * KB),
+        code_(Code::Handle(zone)),
+        descriptors_(PcDescriptors::Handle(zone)),
+        cls_(Class::Handle(zone)),
+        library_(Library::Handle(zone)),
+        url_(String::Handle(zone)) {}
+
+  void VisitFunction(const Function& function) {
+    if (!function.WasExecuted()) {
+      return;
+    }
+    // Every executed function is listed, so that gen_snapshot can tell
+    // functions which never ran. The usage counter is reset when a function
+    // is optimized, so it cannot rank functions and only their execution is
+    // recorded.
+    buffer_.Printf("function 1 %s\n",
+                   StartupTrace::FunctionKey(zone_, function));
+
+    if (function.ic_data_array() == Array::null()) {
+      return;
+    }
+    code_ = function.unoptimized_code();
+    if (code_.IsNull()) {
+      code_ = function.CurrentCode();
+      if (code_.IsNull() || code_.is_optimized()) {
+        return;
+      }
+    }
+    ZoneGrowableArray<const ICData*>* ic_data_map =
+        new (zone_) ZoneGrowableArray<const ICData*>();
+    function.RestoreICDataMap(ic_data_map, /*clone_ic_data=*/false);
+
+    descriptors_ = code_.pc_descriptors();
+    PcDescriptors::Iterator iter(descriptors_,
+                                 UntaggedPcDescriptors::kIcCall |
+                                     UntaggedPcDescriptors::kUnoptStaticCall);
+    while (iter.MoveNext()) {
+      const intptr_t deopt_id = iter.DeoptId();
+      if (deopt_id < 0 || deopt_id >= ic_data_map->length() ||
+          (*ic_data_map)[deopt_id] == nullptr || !iter.TokenPos().IsReal()) {
+        continue;
+      }
+      WriteCallSite(iter.TokenPos(), *(*ic_data_map)[deopt_id]);
+    }
+  }
+
+  const TextBuffer& buffer() const { return buffer_; }
+
+ private:
+  void WriteCallSite(TokenPosition token_pos, const ICData& ic_data) {
+    buffer_.Printf("call %" Pd32 " %" Pd "\n", token_pos.Serialize(),
+                   ic_data.AggregateCount());
+    if (ic_data.is_static_call()) {
+      return;
+    }
+    // Calls which test two arguments record a check per receiver and
+    // argument class, so the receiver counts are summed first.
+    AotProfile::CallSite site(zone_);
+    for (intptr_t i = 0, n = ic_data.NumberOfChecks(); i < n; i++) {
+      const intptr_t count = ic_data.GetCountAt(i);
+      if (count > 0) {
+        site.AddReceiver(ic_data.GetReceiverClassIdAt(i), count);
+      }
+    }
+    for (intptr_t i = 0; i < site.receivers().length(); i++) {
+      cls_ = class_table_->At(site.receivers()[i].cid);
+      library_ = cls_.library();
+      if (library_.IsNull()) {
+        continue;
+      }
+      url_ = library_.url();
+      buffer_.Printf("receiver %" Pd " %s %s\n", site.receivers()[i].count,
+                     url_.ToCString(), cls_.ScrubbedNameCString());
+    }
+  }
+
+  Zone* zone_;
+  ClassTable* class_table_;
+  TextBuffer buffer_;
+  Code& code_;
+  PcDescriptors& descriptors_;
+  Class& cls_;
+  Library& library_;
+  String& url_;
+};
+
+const char* AotProfile::Collect(Thread* thread) {
+  Zone* zone = thread->zone();
+  IsolateGroup* isolate_group = thread->isolate_group();
+  AotProfileWriter writer(zone, isolate_group->class_table());
+  ProgramVisitor::WalkProgram(zone, isolate_group, &writer);
+  return zone->MakeCopyOfString(writer.buffer().buffer());
+}
+
+void AotProfile::WriteIfRequested(Thread* thread) {
+  const char* filename = FLAG_write_aot_profile_to;
+  if (filename == nullptr) {
+    return;
+  }
+  if ((Dart::file_write_callback() == nullptr) ||
+      (Dart::file_open_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("warning: Could not access file callbacks.\n");
+    return;
+  }
+
+  const char* contents = Collect(thread);
+  void* file = Dart::file_open_callback()(filename, /*write=*/true);
+  if (file == nullptr) {
+    OS::PrintErr("warning: Failed to write AOT profile: %s\n", filename);
+    return;
+  }
+  Dart::file_write_callback()(contents, strlen(contents), file);
+  Dart::file_close_callback()(file);
+}
+
+static int CompareReceivers(const AotProfile::Receiver* a,
+                            const AotProfile::Receiver* b) {
+  if (a->count > b->count) return -1;
+  if (a->count < b->count) return 1;
+  return 0;
+}
+
+// Splits off the next space separated field of [line]. Returns false if
+// there is none.
+static bool NextField(const char** line, const char** start, intptr_t* len) {
+  const char* p = *line;
+  while (*p == ' ') p++;
+  *start = p;
+  while (*p != ' ' && *p != '\0') p++;
+  *len = p - *start;
+  *line = p;
+  return *len > 0;
+}
+
+static bool FieldIs(const char* start, intptr_t len, const char* name) {
+  return (len == static_cast<intptr_t>(strlen(name))) &&
+         (strncmp(start, name, len) == 0);
+}
+
+static bool NextInteger(const char** line, intptr_t* value) {
+  const char* start;
+  intptr_t len;
+  if (!NextField(line, &start, &len)) {
+    return false;
+  }
+  char* end;
+  errno = 0;
+  *value = strtoll(start, &end, 10);
+  return errno == 0 && end == start + len;
+}
+
+// Returns the rest of [line] without leading spaces, or nullptr if it is
+// empty.
+static const char* RestOfLine(const char* line) {
+  while (*line == ' ') line++;
+  return *line == '\0' ? nullptr : line;
+}
+
+AotProfile* AotProfile::Parse(Zone* zone,
+                              IsolateGroup* isolate_group,
+                              const char* contents,
+                              intptr_t length) {
+  AotProfile* profile = new (zone) AotProfile(zone);
+  return profile->ReadLines(isolate_group, contents, length) ? profile
+                                                             : nullptr;
+}
+
+bool AotProfile::ReadLines(IsolateGroup* isolate_group,
+                           const char* contents,
+                           intptr_t length) {
+  // Maps "<library url> <class name>" to the class id.
+  CStringIntMap class_ids(zone_);
+  ClassTable* class_table = isolate_group->class_table();
+  Class& cls = Class::Handle(zone_);
+  Library& library = Library::Handle(zone_);
+  String& url = String::Handle(zone_);
+  for (intptr_t cid = kInstanceCid; cid < class_table->NumCids(); cid++) {
+    if (!class_table->HasValidClassAt(cid)) continue;
+    cls = class_table->At(cid);
+    library = cls.library();
+    if (library.IsNull()) continue;
+    url = library.url();
+    const char* key = OS::SCreate(zone_, "%s %s", url.ToCString(),
+                                  cls.ScrubbedNameCString());
+    if (!class_ids.HasKey(key)) {
+      class_ids.Insert({key, cid});
+    }
+  }
+
+  FunctionProfile* function = nullptr;
+  CallSite* call_site = nullptr;
+  intptr_t line_start = 0;
+  for (intptr_t i = 0; i <= length; i++) {
+    if (i < length && contents[i] != '\n') continue;
+    intptr_t line_end = i;
+    if (line_end > line_start && contents[line_end - 1] == '\r') {
+      line_end--;
+    }
+    const char* line =
+        zone_->MakeCopyOfStringN(contents + line_start, line_end - line_start);
+    line_start = i + 1;
+
+    const char* tag;
+    intptr_t tag_length;
+    if (!NextField(&line, &tag, &tag_length)) {
+      continue;
+    }
+    if (FieldIs(tag, tag_length, "sampled")) {
+      if (!functions_.is_empty()) {
+        return false;
+      }
+      is_sampled_ = true;
+    } else if (FieldIs(tag, tag_length, "function")) {
+      intptr_t count;
+      const char* name;
+      if (!NextInteger(&line, &count) ||
+          (name = RestOfLine(line)) == nullptr) {
+        return false;
+      }
+      const intptr_t index = function_indices_.LookupValue(name);
+      if (index != CStringIntMapKeyValueTrait::kNoValue) {
+        function = functions_[index];
+      } else {
+        function = new (zone_) FunctionProfile(zone_);
+        function_indices_.Insert({name, functions_.length()});
+        functions_.Add(function);
+      }
+      if (count > 0) {
+        function->was_executed_ = true;
+      }
+      call_site = nullptr;
+    } else if (FieldIs(tag, tag_length, "call")) {
+      intptr_t token_pos;
+      intptr_t count;
+      if (function == nullptr || !NextInteger(&line, &token_pos) ||
+          !NextInteger(&line, &count)) {
+        return false;
+      }
+      // Calls desugared from the same expression share its position.
+      call_site = function->call_sites_.Lookup(token_pos);
+      if (call_site == nullptr) {
+        call_site = new (zone_) CallSite(zone_);
+        function->call_sites_.Insert(token_pos, call_site);
+      }
+      call_site->count_ += count;
+      function->max_call_count_ =
+          Utils::Maximum(function->max_call_count_, call_site->count_);
+    } else if (FieldIs(tag, tag_length, "receiver")) {
+      intptr_t count;
+      const char* key;
+      if (call_site == nullptr || !NextInteger(&line, &count) ||
+          (key = RestOfLine(line)) == nullptr) {
+        return false;
+      }
+      const intptr_t cid = class_ids.LookupValue(key);
+      // Classes which are not part of the program any more are dropped.
+      if (cid != CStringIntMapKeyValueTrait::kNoValue) {
+        call_site->AddReceiver(cid, count);
+      }
+    } else {
+      return false;
+    }
+  }
+
+  for (intptr_t i = 0; i < functions_.length(); i++) {
+    auto it = functions_[i]->call_sites_.GetIterator();
+    for (auto* pair = it.Next(); pair != nullptr; pair = it.Next()) {
+      pair->value->receivers_.Sort(CompareReceivers);
+    }
+  }
+  return true;
+}
+
+AotProfile* AotProfile::ReadIfRequested(Zone* zone,
+                                        IsolateGroup* isolate_group) {
+  const char* filename = FLAG_use_aot_profile;
+  if (filename == nullptr) {
+    return nullptr;
+  }
+  if ((Dart::file_read_callback() == nullptr) ||
+      (Dart::file_open_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("warning: Could not access file callbacks.\n");
+    return nullptr;
+  }
+  void* file = Dart::file_open_callback()(filename, /*write=*/false);
+  if (file == nullptr) {
+    OS::PrintErr("warning: Failed to read AOT profile: %s\n", filename);
+    return nullptr;
+  }
+  uint8_t* data = nullptr;
+  intptr_t length = 0;
+  Dart::file_read_callback()(&data, &length, file);
+  Dart::file_close_callback()(file);
+  if (data == nullptr || length < 0) {
+    OS::PrintErr("warning: Failed to read AOT profile: %s\n", filename);
+    return nullptr;
+  }
+
+  AotProfile* profile = Parse(zone, isolate_group,
+                              reinterpret_cast<const char*>(data), length);
+  // The embedder's read callback allocates the buffer with malloc.
+  free(data);
+  if (profile == nullptr) {
+    OS::PrintErr("warning: Malformed AOT profile: %s\n", filename);
+    return nullptr;
+  }
+  return profile;
+}
+
+// Whether the JIT counts the invocations of [function], so that it is
+// executed if and only if it is listed in a profile.
+static bool IsProfiled(const Function& function) {
+  return !function.IsDispatcherOrImplicitAccessor() &&
+         !function.IsMethodExtractor() && !function.IsFfiTrampoline() &&
+         !function.ForceOptimize() && !function.is_intrinsic();
+}
+
+// Collects the functions with code which never ran according to a profile.
+class ColdFunctionCollector : public FunctionVisitor {
+ public:
+  ColdFunctionCollector(Zone* zone, const AotProfile* profile)
+      : profile_(profile),
+        cold_functions_(
+            GrowableObjectArray::Handle(zone, GrowableObjectArray::New())),
+        num_hot_(0) {}
+
+  void VisitFunction(const Function& function) {
+    if (!function.HasCode() || !IsProfiled(function)) {
+      return;
+    }
+    // Code of functions which were not sampled is placed like code which
+    // never ran, even though they may have run between samples.
+    const AotProfile::FunctionProfile* function_profile =
+        profile_->LookupFunction(function);
+    if ((function_profile == nullptr) || !function_profile->was_executed()) {
+      cold_functions_.Add(function);
+    } else {
+      num_hot_++;
+    }
+  }
+
+  const GrowableObjectArray& cold_functions() const { return cold_functions_; }
+  intptr_t num_hot() const { return num_hot_; }
+
+ private:
+  const AotProfile* profile_;
+  GrowableObjectArray& cold_functions_;
+  intptr_t num_hot_;
+};
+
+ArrayPtr AotProfile::ColdFunctions(Thread* thread) const {
+  ColdFunctionCollector collector(zone_, this);
+  ProgramVisitor::WalkProgram(zone_, thread->isolate_group(), &collector);
+  // Do not move all code if the profile is of another program.
+  if (collector.num_hot() == 0) {
+    OS::PrintErr("warning: No function of the AOT profile was found: %s\n",
+                 FLAG_use_aot_profile);
+    return Array::null();
+  }
+  return Array::MakeFixedLength(collector.cold_functions());
+}
+
+void AotProfile::MoveColdCodeToEnd(Thread* thread,
+                                   GrowableArray<CodePtr>* codes) {
+  Zone* zone = thread->zone();
+  const Array& cold_functions = Array::Handle(
+      zone, thread->isolate_group()->object_store()->cold_functions());
+  if (cold_functions.IsNull()) {
+    return;
+  }
+  DirectChainedHashMap<IdentitySetKeyValueTrait<FunctionPtr>> is_cold(zone);
+  for (intptr_t i = 0; i < cold_functions.Length(); i++) {
+    is_cold.Insert(Function::RawCast(cold_functions.At(i)));
+  }
+
+  GrowableArray<CodePtr> cold_codes(zone, cold_functions.Length());
+  Code& code = Code::Handle(zone);
+  intptr_t num_hot = 0;
+  for (intptr_t i = 0; i < codes->length(); i++) {
+    code = codes->At(i);
+    if (code.IsFunctionCode() && is_cold.HasKey(code.function())) {
+      cold_codes.Add(code.ptr());
+    } else {
+      (*codes)[num_hot++] = code.ptr();
+    }
+  }
+  for (intptr_t i = 0; i < cold_codes.length(); i++) {
+    (*codes)[num_hot + i] = cold_codes[i];
+  }
+}
+
+bool AotProfile::IsCold(const Function& function) const {
+  if (!IsProfiled(function)) {
+    return false;
+  }
+  const FunctionProfile* profile = LookupFunction(function);
+  if (profile == nullptr) {
+    // A function may run between the samples of the profiler.
+    return !is_sampled_;
+  }
+  return !profile->was_executed();
+}
+
+const AotProfile::FunctionProfile* AotProfile::LookupFunction(
+    const Function& function) const {
+  intptr_t index =
+      function_indices_.LookupValue(StartupTrace::FunctionKey(zone_, function));
+  // The AOT runtime has no token positions, so a sampled profile lists all
+  // closures of the same name under that name.
+  if ((index == CStringIntMapKeyValueTrait::kNoValue) && is_sampled_ &&
+      function.IsClosureFunction()) {
+    index = function_indices_.LookupValue(function.ToFullyQualifiedCString());
+  }
+  if (index == CStringIntMapKeyValueTrait::kNoValue) {
+    return nullptr;
+  }
+  return functions_[index];
+}
+
+intptr_t AotProfile::CallCount(const Function& function,
+                               TokenPosition token_pos) const {
+  const FunctionProfile* profile = LookupFunction(function);
+  if (profile == nullptr) {
+    return -1;
+  }
+  const CallSite* site = profile->LookupCallSite(token_pos);
+  return site == nullptr ? -1 : site->count();
+}
+
+}  // namespace dart
@@ -0,0 +1,172 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_AOT_AOT_PROFILE_H_
+#define RUNTIME_VM_COMPILER_AOT_AOT_PROFILE_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+#include "vm/hash_map.h"
+#include "vm/tagged_pointer.h"
+#include "vm/token_position.h"
+
+namespace dart {
+
+class Function;
+class IsolateGroup;
+class Thread;
+class Zone;
+
+// An AOT profile records the type feedback the JIT collected in unoptimized
+// code: which functions ran, how often each call site in them ran and, for
+// instance calls, which receiver classes it saw.
+//
+// The JIT writes a profile with --write_aot_profile_to when an isolate shuts
+// down. gen_snapshot reads it back with --use_aot_profile and uses it to
+// devirtualize calls speculatively, to rank call sites for inlining and to
+// move code which never ran out of the way of the hot path.
+//
+// The AOT runtime has no counters, but with --profiler it writes the
+// functions seen by the sampling profiler instead, with their tick counts
+// (see ProfilerService::WriteAotProfile). Such a profile has no
+// call sites, so it only guides the placement of code. Since a function can
+// run between samples, a sampled profile never shows a function to be cold.
+//
+// The profile is a text file. Functions are identified like in startup
+// traces (see StartupTrace::FunctionKey), so that closures of the same name
+// do not share an entry. Call sites are identified by the token position of
+// the call in its function, and receiver classes by their library URL and
+// name, so a profile remains usable as long as the program is compiled from
+// the same sources. A sampled profile starts with a "sampled" line, and lists
+// closures by their name only, since the AOT runtime has no token positions.
+//
+//   sampled
+//   function <count> <function key>
+//   call <token position> <count>
+//   receiver <count> <library url> <class name>
+class AotProfile : public ZoneAllocated {
+ public:
+  struct Receiver {
+    intptr_t cid;
+    intptr_t count;
+  };
+
+  class CallSite : public ZoneAllocated {
+   public:
+    explicit CallSite(Zone* zone) : count_(0), receivers_(zone, 1) {}
+
+    // Number of times the call ran in unoptimized code.
+    intptr_t count() const { return count_; }
+
+    // The receiver classes seen by an instance call, most frequent first.
+    const GrowableArray<Receiver>& receivers() const { return receivers_; }
+
+   private:
+    friend class AotProfile;
+    friend class AotProfileWriter;
+
+    void AddReceiver(intptr_t cid, intptr_t count);
+
+    intptr_t count_;
+    GrowableArray<Receiver> receivers_;
+  };
+
+  class FunctionProfile : public ZoneAllocated {
+   public:
+    explicit FunctionProfile(Zone* zone)
+        : was_executed_(false), max_call_count_(0), call_sites_(zone) {}
+
+    // Only whether the function ran is known: the JIT resets the usage
+    // counter of a function when it optimizes it, so the count of a
+    // function line is not comparable between functions.
+    bool was_executed() const { return was_executed_; }
+    intptr_t max_call_count() const { return max_call_count_; }
+
+    // Returns nullptr if no call at [token_pos] was recorded.
+    const CallSite* LookupCallSite(TokenPosition token_pos) const {
+      return call_sites_.Lookup(token_pos.Serialize());
+    }
+
+   private:
+    friend class AotProfile;
+
+    bool was_executed_;
+    intptr_t max_call_count_;
+    IntMap<CallSite*> call_sites_;
+  };
+
+  // Returns the profile of all functions of [thread]'s isolate group.
+  static const char* Collect(Thread* thread);
+
+  // Writes the profile of all functions of [thread]'s isolate group to
+  // --write_aot_profile_to, if given.
+  static void WriteIfRequested(Thread* thread);
+
+  // Parses the profile in [contents]. Returns nullptr if it is malformed.
+  static AotProfile* Parse(Zone* zone,
+                           IsolateGroup* isolate_group,
+                           const char* contents,
+                           intptr_t length);
+
+  // Reads the profile given with --use_aot_profile. Returns nullptr if no
+  // profile was given or it could not be read.
+  //
+  // Receiver classes are resolved to class ids, so the profile has to be
+  // read after the final class ids were assigned.
+  static AotProfile* ReadIfRequested(Zone* zone, IsolateGroup* isolate_group);
+
+  // Moves the code of the functions which the precompiler found to be cold
+  // (see ColdFunctions) to the end of [codes], so that it forms a cold
+  // region at the end of the instructions image and the code which runs is
+  // packed into fewer pages. Hot and cold code keep their relative order.
+  static void MoveColdCodeToEnd(Thread* thread, GrowableArray<CodePtr>* codes);
+
+  // Returns nullptr if [function] has no profile.
+  const FunctionProfile* LookupFunction(const Function& function) const;
+
+  // Whether the profile was written from the samples of the profiler rather
+  // than from the counters of the JIT.
+  bool is_sampled() const { return is_sampled_; }
+
+  // Whether [function] never ran according to the profile. Functions whose
+  // invocations are not counted are never cold, and neither are functions
+  // missing from a sampled profile.
+  bool IsCold(const Function& function) const;
+
+  // Returns the recorded count of the call at [token_pos] in [function], or
+  // -1 if the call was not recorded.
+  intptr_t CallCount(const Function& function, TokenPosition token_pos) const;
+
+  // Returns the functions with code which never ran according to the
+  // profile, or which were never sampled if the profile is sampled. Returns
+  // null if no other function with code is in the profile, since the profile
+  // is then of another program.
+  ArrayPtr ColdFunctions(Thread* thread) const;
+
+ private:
+  explicit AotProfile(Zone* zone)
+      : zone_(zone),
+        is_sampled_(false),
+        function_indices_(zone),
+        functions_(zone, 16) {}
+
+  bool ReadLines(IsolateGroup* isolate_group,
+                 const char* contents,
+                 intptr_t length);
+
+  Zone* zone_;
+  bool is_sampled_;
+  CStringIntMap function_indices_;
+  GrowableArray<FunctionProfile*> functions_;
+
+  DISALLOW_COPY_AND_ASSIGN(AotProfile);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_AOT_AOT_PROFILE_H_
@@ -0,0 +1,363 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/aot/aot_profile.h"
+
+#include "vm/compiler/backend/il.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/compiler/compiler_state.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(DART_PRECOMPILER)
+
+DECLARE_FLAG(int, max_polymorphic_checks);
+
+static const char* kProfiledScript = R"(
+    class B {
+      int toInline() => 1;
+    }
+    class C {
+      int toInline() => 2;
+    }
+
+    testInlining(dynamic arg) => arg.toInline();
+
+    neverCalled() {}
+
+    main() {
+      for (var i = 0; i < 10; i++) {
+        testInlining(B());
+      }
+      testInlining(C());
+    }
+  )";
+
+static AotProfile* ParseProfile(Thread* thread, const char* contents) {
+  return AotProfile::Parse(thread->zone(), thread->isolate_group(), contents,
+                           strlen(contents));
+}
+
+// Returns the token position of the only instance call in [function].
+static TokenPosition FindCallPosition(const Function& function) {
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({CompilerPass::kComputeSSA});
+  TokenPosition token_pos = TokenPosition::kNoSource;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      if (auto call = it.Current()->AsInstanceCall()) {
+        token_pos = call->token_pos();
+      }
+    }
+  }
+  EXPECT(token_pos.IsReal());
+  return token_pos;
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_Parse) {
+  const auto& root_library = Library::Handle(LoadTestScript(kProfiledScript));
+  const auto& function =
+      Function::Handle(GetFunction(root_library, "testInlining"));
+  const auto& never_called =
+      Function::Handle(GetFunction(root_library, "neverCalled"));
+  const auto& class_b = Class::Handle(GetClass(root_library, "B"));
+  const auto& class_c = Class::Handle(GetClass(root_library, "C"));
+  const auto& url = String::Handle(root_library.url());
+
+  const char* contents = OS::SCreate(
+      thread->zone(),
+      "function 11 %s\n"
+      "call 42 11\n"
+      "receiver 1 %s C\n"
+      "receiver 10 %s B\n"
+      "receiver 3 %s Removed\n"
+      "call 42 1\n",
+      function.ToFullyQualifiedCString(), url.ToCString(), url.ToCString(),
+      url.ToCString());
+  const AotProfile* profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+
+  const AotProfile::FunctionProfile* function_profile =
+      profile->LookupFunction(function);
+  EXPECT(function_profile != nullptr);
+  EXPECT(function_profile->was_executed());
+  EXPECT_EQ(12, function_profile->max_call_count());
+  EXPECT(profile->LookupFunction(never_called) == nullptr);
+
+  // Records of the same call are merged, and classes which do not exist are
+  // dropped. The most frequent receiver comes first.
+  const AotProfile::CallSite* site =
+      function_profile->LookupCallSite(TokenPosition::Deserialize(42));
+  EXPECT(site != nullptr);
+  EXPECT_EQ(12, site->count());
+  EXPECT_EQ(2, site->receivers().length());
+  EXPECT_EQ(class_b.id(), site->receivers()[0].cid);
+  EXPECT_EQ(10, site->receivers()[0].count);
+  EXPECT_EQ(class_c.id(), site->receivers()[1].cid);
+  EXPECT_EQ(1, site->receivers()[1].count);
+  EXPECT_EQ(12, profile->CallCount(function, TokenPosition::Deserialize(42)));
+  EXPECT_EQ(-1, profile->CallCount(function, TokenPosition::Deserialize(7)));
+
+  EXPECT(!profile->IsCold(function));
+  EXPECT(profile->IsCold(never_called));
+
+  // Only whether a function ran is kept, not its count.
+  contents = OS::SCreate(thread->zone(), "function 0 %s\nfunction 3 %s\n",
+                         never_called.ToFullyQualifiedCString(),
+                         function.ToFullyQualifiedCString());
+  profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+  EXPECT(!profile->LookupFunction(never_called)->was_executed());
+  EXPECT(profile->LookupFunction(function)->was_executed());
+  EXPECT(profile->IsCold(never_called));
+
+  EXPECT(ParseProfile(thread, "call 42 1\n") == nullptr);
+  EXPECT(ParseProfile(thread, "function x main\n") == nullptr);
+  EXPECT(ParseProfile(thread, "unknown 1\n") == nullptr);
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_ParseSampled) {
+  const auto& root_library = Library::Handle(LoadTestScript(kProfiledScript));
+  const auto& function =
+      Function::Handle(GetFunction(root_library, "testInlining"));
+  const auto& never_called =
+      Function::Handle(GetFunction(root_library, "neverCalled"));
+
+  const char* contents = OS::SCreate(thread->zone(), "sampled\nfunction 5 %s\n",
+                                     function.ToFullyQualifiedCString());
+  const AotProfile* profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+  EXPECT(profile->is_sampled());
+  EXPECT(profile->LookupFunction(function)->was_executed());
+
+  // Functions which were not sampled may have run between samples.
+  EXPECT(!profile->IsCold(function));
+  EXPECT(!profile->IsCold(never_called));
+
+  contents = OS::SCreate(thread->zone(), "function 5 %s\n",
+                         function.ToFullyQualifiedCString());
+  profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+  EXPECT(!profile->is_sampled());
+  EXPECT(profile->IsCold(never_called));
+
+  // The header has to come first.
+  contents = OS::SCreate(thread->zone(), "function 5 %s\nsampled\n",
+                         function.ToFullyQualifiedCString());
+  EXPECT(ParseProfile(thread, contents) == nullptr);
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_Closures) {
+  const char* kScript = R"(
+    closures() => [() => 1, () => 2];
+
+    main() {
+      final list = closures();
+      for (var i = 0; i < 10; i++) {
+        list[0]();
+      }
+    }
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  Invoke(root_library, "main");
+  const auto& closures = GrowableObjectArray::Handle(
+      GrowableObjectArray::RawCast(Invoke(root_library, "closures")));
+  const auto& called = Function::Handle(
+      Closure::Cast(Object::Handle(closures.At(0))).function());
+  const auto& not_called = Function::Handle(
+      Closure::Cast(Object::Handle(closures.At(1))).function());
+  const char* name = called.ToFullyQualifiedCString();
+  EXPECT_STREQ(name, not_called.ToFullyQualifiedCString());
+
+  // Closures of the same name have separate entries.
+  const AotProfile* profile =
+      ParseProfile(thread, AotProfile::Collect(thread));
+  EXPECT(profile != nullptr);
+  EXPECT(profile->LookupFunction(called) != nullptr);
+  EXPECT(profile->LookupFunction(not_called) == nullptr);
+  EXPECT(!profile->IsCold(called));
+  EXPECT(profile->IsCold(not_called));
+
+  // A sampled profile lists both under their name.
+  const char* contents =
+      OS::SCreate(thread->zone(), "sampled\nfunction 5 %s\n", name);
+  profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+  EXPECT(profile->LookupFunction(called) != nullptr);
+  EXPECT(profile->LookupFunction(not_called) != nullptr);
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_CollectAndParse) {
+  const auto& root_library = Library::Handle(LoadTestScript(kProfiledScript));
+  const auto& function =
+      Function::Handle(GetFunction(root_library, "testInlining"));
+  const auto& never_called =
+      Function::Handle(GetFunction(root_library, "neverCalled"));
+  const auto& class_b = Class::Handle(GetClass(root_library, "B"));
+  const auto& class_c = Class::Handle(GetClass(root_library, "C"));
+
+  Invoke(root_library, "main");
+
+  const AotProfile* profile =
+      ParseProfile(thread, AotProfile::Collect(thread));
+  EXPECT(profile != nullptr);
+  const AotProfile::FunctionProfile* function_profile =
+      profile->LookupFunction(function);
+  EXPECT(function_profile != nullptr);
+  EXPECT(!profile->IsCold(function));
+  EXPECT(profile->IsCold(never_called));
+
+  const AotProfile::CallSite* site =
+      function_profile->LookupCallSite(FindCallPosition(function));
+  EXPECT(site != nullptr);
+  EXPECT_EQ(11, site->count());
+  EXPECT_EQ(2, site->receivers().length());
+  EXPECT_EQ(class_b.id(), site->receivers()[0].cid);
+  EXPECT_EQ(10, site->receivers()[0].count);
+  EXPECT_EQ(class_c.id(), site->receivers()[1].cid);
+  EXPECT_EQ(1, site->receivers()[1].count);
+}
+
+// Returns the call which replaced the instance call in [function] after
+// devirtualization by [profile], or nullptr if the call was not replaced.
+static PolymorphicInstanceCallInstr* DevirtualizeUsingProfile(
+    const Function& function,
+    const AotProfile* profile) {
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  CompilerState::Current().set_aot_profile(profile);
+  FlowGraph* flow_graph = pipeline.RunPasses({
+      CompilerPass::kComputeSSA,
+      CompilerPass::kApplyICData,
+  });
+  PolymorphicInstanceCallInstr* result = nullptr;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      if (auto call = it.Current()->AsPolymorphicInstanceCall()) {
+        result = call;
+      }
+    }
+  }
+  return result;
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_DevirtualizeUsingProfile) {
+  const auto& root_library = Library::Handle(LoadTestScript(kProfiledScript));
+  const auto& function =
+      Function::Handle(GetFunction(root_library, "testInlining"));
+  const auto& class_b = Class::Handle(GetClass(root_library, "B"));
+  const auto& url = String::Handle(root_library.url());
+  const char* name = function.ToFullyQualifiedCString();
+  const int32_t call_pos = FindCallPosition(function).Serialize();
+
+  // Without a profile the receivers of the call are unknown.
+  EXPECT(DevirtualizeUsingProfile(function, nullptr) == nullptr);
+
+  SetFlagScope<int> sfs(&FLAG_max_polymorphic_checks, 1);
+
+  // B covers 90% of the calls, which is enough to check for it first.
+  const char* contents = OS::SCreate(
+      thread->zone(),
+      "function 10 %s\n"
+      "call %" Pd32 " 10\n"
+      "receiver 9 %s B\n"
+      "receiver 1 %s C\n",
+      name, call_pos, url.ToCString(), url.ToCString());
+  PolymorphicInstanceCallInstr* call =
+      DevirtualizeUsingProfile(function, ParseProfile(thread, contents));
+  EXPECT(call != nullptr);
+  EXPECT(call->targets_from_profile());
+  EXPECT(!call->complete());
+  EXPECT_EQ(1, call->NumberOfChecks());
+  EXPECT_EQ(class_b.id(), call->targets()[0].cid_start);
+  EXPECT_EQ(10, call->total_call_count());
+
+  // B covers only 80% of the calls.
+  contents = OS::SCreate(thread->zone(),
+                         "function 10 %s\n"
+                         "call %" Pd32 " 10\n"
+                         "receiver 8 %s B\n"
+                         "receiver 2 %s C\n",
+                         name, call_pos, url.ToCString(), url.ToCString());
+  EXPECT(DevirtualizeUsingProfile(function, ParseProfile(thread, contents)) ==
+         nullptr);
+}
+
+ISOLATE_UNIT_TEST_CASE(AotProfile_MoveColdCodeToEnd) {
+  const char* kScript = R"(
+    int a() => 1;
+    int b() => 2;
+    int c() => 3;
+    int d() => 4;
+
+    main() => a() + b() + c() + d();
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  Invoke(root_library, "main");
+
+  const char* names[] = {"a", "b", "c", "d"};
+  GrowableArray<const Function*> functions;
+  for (const char* name : names) {
+    const auto& function =
+        Function::ZoneHandle(GetFunction(root_library, name));
+    EXPECT(function.HasCode());
+    functions.Add(&function);
+  }
+
+  // b and d never ran.
+  const char* contents = OS::SCreate(
+      thread->zone(), "function 1 %s\nfunction 1 %s\nfunction 1 %s\n",
+      Function::Handle(GetFunction(root_library, "main"))
+          .ToFullyQualifiedCString(),
+      functions[0]->ToFullyQualifiedCString(),
+      functions[2]->ToFullyQualifiedCString());
+  const AotProfile* profile = ParseProfile(thread, contents);
+  EXPECT(profile != nullptr);
+  const auto& cold_functions =
+      Array::Handle(profile->ColdFunctions(thread));
+  EXPECT(!cold_functions.IsNull());
+  bool is_cold[] = {false, false, false, false};
+  for (intptr_t i = 0; i < cold_functions.Length(); i++) {
+    for (intptr_t j = 0; j < functions.length(); j++) {
+      if (cold_functions.At(i) == functions[j]->ptr()) {
+        is_cold[j] = true;
+      }
+    }
+  }
+  EXPECT(!is_cold[0]);
+  EXPECT(is_cold[1]);
+  EXPECT(!is_cold[2]);
+  EXPECT(is_cold[3]);
+
+  GrowableArray<CodePtr> codes;
+  for (intptr_t i = 0; i < functions.length(); i++) {
+    codes.Add(functions[i]->CurrentCode());
+  }
+  auto object_store = thread->isolate_group()->object_store();
+  object_store->set_cold_functions(cold_functions);
+  AotProfile::MoveColdCodeToEnd(thread, &codes);
+  object_store->set_cold_functions(Array::null_array());
+
+  EXPECT(codes[0] == functions[0]->CurrentCode());
+  EXPECT(codes[1] == functions[2]->CurrentCode());
+  EXPECT(codes[2] == functions[1]->CurrentCode());
+  EXPECT(codes[3] == functions[3]->CurrentCode());
+
+  // A profile of another program leaves the code in place.
+  EXPECT(ParseProfile(thread, "function 1 unknown\n")->ColdFunctions(thread) ==
+         Array::null());
+}
+
+#endif  // defined(DART_PRECOMPILER)
+
+}  // namespace dart
@@ -11,9 +11,11 @@
 #include "vm/closure_functions_cache.h"
 #include "vm/code_patcher.h"
 #include "vm/compiler/aot/aot_call_specializer.h"
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/aot/precompiler_tracer.h"
 #include "vm/compiler/assembler/assembler.h"
 #include "vm/compiler/assembler/disassembler.h"
+#include "vm/compiler/backend/block_scheduler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
 #include "vm/compiler/backend/constant_propagator.h"
 #include "vm/compiler/backend/flow_graph.h"
@@ -47,6 +49,7 @@
 #include "vm/regexp_parser.h"
 #include "vm/resolver.h"
 #include "vm/runtime_entry.h"
+#include "vm/startup_trace.h"
 #include "vm/symbols.h"
 #include "vm/tags.h"
 #include "vm/timeline.h"
@@ -474,6 +477,10 @@ void Precompiler::DoCompileAll() {
 
       ClassFinalizer::SortClasses();
 
+      // The profile refers to classes which have to be mapped to their final
+      // class ids.
+      profile_ = AotProfile::ReadIfRequested(Z, IG);
+
       // Collects type usage information which allows us to decide when/how to
       // optimize runtime type tests.
       TypeUsageInfo type_usage_info(T);
@@ -494,6 +501,7 @@ void Precompiler::DoCompileAll() {
 
       {
         CompilerState state(thread_, /*is_aot=*/true, /*is_optimizing=*/true);
+        state.set_aot_profile(profile_);
         PrecompileConstructors();
       }
 
@@ -662,6 +670,17 @@ void Precompiler::DoCompileAll() {
       retained_reasons_writer_ = nullptr;
     }
 
+    if (profile_ != nullptr) {
+      // The serializer places the code of these functions after the code
+      // which ran (see AotProfile::MoveColdCodeToEnd).
+      IG->object_store()->set_cold_functions(
+          Array::Handle(Z, profile_->ColdFunctions(T)));
+      profile_ = nullptr;
+    }
+    // The serializer places the code of these functions first (see
+    // StartupTrace::OrderCodeObjects).
+    IG->object_store()->set_startup_functions(
+        Array::Handle(Z, StartupTrace::ReadStartupFunctions(T)));
     zone_ = NULL;
   }
 
@@ -3131,6 +3150,7 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
       CompilerState compiler_state(thread(), /*is_aot=*/true, optimized(),
                                    CompilerState::ShouldTrace(function));
       compiler_state.set_function(function);
+      compiler_state.set_aot_profile(precompiler_->profile());
 
       {
         ic_data_array = new (zone) ZoneGrowableArray<const ICData*>();
@@ -3155,10 +3175,17 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
         FlowGraphPrinter::PrintGraph("Unoptimized Compilation", flow_graph);
       }
 
+      const bool reorder_blocks =
+          FlowGraph::ShouldReorderBlocks(function, optimized());
+      if (reorder_blocks) {
+        TIMELINE_DURATION(thread(), CompilerVerbose,
+                          "BlockScheduler::AssignEdgeWeights");
+        BlockScheduler::AssignEdgeWeights(flow_graph);
+      }
+
       CompilerPassState pass_state(thread(), flow_graph, &speculative_policy,
                                    precompiler_);
-      pass_state.reorder_blocks =
-          FlowGraph::ShouldReorderBlocks(function, optimized());
+      pass_state.reorder_blocks = reorder_blocks;
 
       if (function.ForceOptimize()) {
         ASSERT(optimized());
@@ -29,6 +29,7 @@ class GrowableObjectArray;
 class String;
 class Precompiler;
 class FlowGraph;
+class AotProfile;
 class PrecompilerTracer;
 class RetainedReasonsWriter;
 
@@ -254,6 +255,9 @@ class Precompiler : public ValueObject {
 
   static Precompiler* Instance() { return singleton_; }
 
+  // The profile given with --use_aot_profile, or nullptr.
+  const AotProfile* profile() const { return profile_; }
+
   void AddField(const Field& field);
   void AddTableSelector(const compiler::TableSelector* selector);
 
@@ -396,6 +400,7 @@ class Precompiler : public ValueObject {
 
   Phase phase_ = Phase::kPreparation;
   PrecompilerTracer* tracer_ = nullptr;
+  AotProfile* profile_ = nullptr;
   RetainedReasonsWriter* retained_reasons_writer_ = nullptr;
   bool is_tracing_ = false;
 };
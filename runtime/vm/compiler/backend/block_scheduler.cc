@@ -6,6 +6,7 @@
 
 #include "vm/allocation.h"
 #include "vm/code_patcher.h"
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/backend/flow_graph.h"
 #include "vm/compiler/jit/compiler.h"
 
@@ -51,6 +52,7 @@ void BlockScheduler::AssignEdgeWeights(FlowGraph* flow_graph) {
     return;
   }
   if (CompilerState::Current().is_aot()) {
+    MarkColdTargetsAOT(flow_graph);
     return;
   }
 
@@ -93,6 +95,37 @@ void BlockScheduler::AssignEdgeWeights(FlowGraph* flow_graph) {
   }
 }
 
+// AOT code has no edge counters, but the AOT profile records how often each
+// call ran in the JIT. A branch target whose first call never ran is assumed
+// to be cold.
+void BlockScheduler::MarkColdTargetsAOT(FlowGraph* flow_graph) {
+  const AotProfile* aot_profile = CompilerState::Current().aot_profile();
+  if (aot_profile == nullptr) {
+    return;
+  }
+  const AotProfile::FunctionProfile* profile =
+      aot_profile->LookupFunction(flow_graph->function());
+  if (profile == nullptr || !profile->was_executed()) {
+    return;
+  }
+
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    TargetEntryInstr* target = block_it.Current()->AsTargetEntry();
+    if (target == nullptr) continue;
+    for (ForwardInstructionIterator it(target); !it.Done(); it.Advance()) {
+      Instruction* current = it.Current();
+      if (!current->IsInstanceCall() && !current->IsStaticCall()) continue;
+      const AotProfile::CallSite* site =
+          profile->LookupCallSite(current->token_pos());
+      if (site != nullptr) {
+        target->set_is_cold(site->count() == 0);
+        break;
+      }
+    }
+  }
+}
+
 // A weighted control-flow graph edge.
 struct Edge {
   Edge(BlockEntryInstr* source, BlockEntryInstr* target, double weight)
@@ -239,7 +272,8 @@ void BlockScheduler::ReorderBlocksJIT(FlowGraph* flow_graph) {
 }
 
 // Moves blocks ending in a throw/rethrow, as well as any block post-dominated
-// by such a throwing block, to the end.
+// by such a throwing block, to the end. Blocks dominated by a cold target
+// are placed in front of them.
 void BlockScheduler::ReorderBlocksAOT(FlowGraph* flow_graph) {
   if (!FLAG_reorder_basic_blocks) {
     return;
@@ -250,6 +284,18 @@ void BlockScheduler::ReorderBlocksAOT(FlowGraph* flow_graph) {
   GrowableArray<bool> is_terminating(block_count);
   is_terminating.FillWith(false, 0, block_count);
 
+  // Dominators precede the blocks they dominate in reverse postorder.
+  GrowableArray<bool> is_cold(block_count);
+  is_cold.FillWith(false, 0, block_count);
+  for (intptr_t i = 0; i < block_count; ++i) {
+    auto block = reverse_postorder[i];
+    auto target = block->AsTargetEntry();
+    auto dominator = block->dominator();
+    is_cold[block->preorder_number()] =
+        (target != nullptr && target->is_cold()) ||
+        (dominator != nullptr && is_cold[dominator->preorder_number()]);
+  }
+
   // Any block in the worklist is marked and any of its unconditional
   // predecessors need to be marked as well.
   GrowableArray<BlockEntryInstr*> worklist;
@@ -281,13 +327,23 @@ void BlockScheduler::ReorderBlocksAOT(FlowGraph* flow_graph) {
     }
   }
 
-  // Emit code in reverse postorder but move any throwing blocks (except the
-  // function entry, which needs to come first) to the very end.
+  // Emit code in reverse postorder but move any cold blocks and then any
+  // throwing blocks (except the function entry, which needs to come first)
+  // to the very end.
   auto codegen_order = flow_graph->CodegenBlockOrder(true);
   for (intptr_t i = 0; i < block_count; ++i) {
     auto block = reverse_postorder[i];
     const intptr_t preorder_nr = block->preorder_number();
-    if (!is_terminating[preorder_nr] || block->IsFunctionEntry()) {
+    if ((!is_terminating[preorder_nr] && !is_cold[preorder_nr]) ||
+        block->IsFunctionEntry()) {
+      codegen_order->Add(block);
+    }
+  }
+  for (intptr_t i = 0; i < block_count; ++i) {
+    auto block = reverse_postorder[i];
+    const intptr_t preorder_nr = block->preorder_number();
+    if (!is_terminating[preorder_nr] && is_cold[preorder_nr] &&
+        !block->IsFunctionEntry()) {
       codegen_order->Add(block);
     }
   }
@@ -21,6 +21,7 @@ class BlockScheduler : public AllStatic {
   static void ReorderBlocks(FlowGraph* flow_graph);
 
  private:
+  static void MarkColdTargetsAOT(FlowGraph* flow_graph);
   static void ReorderBlocksAOT(FlowGraph* flow_graph);
   static void ReorderBlocksJIT(FlowGraph* flow_graph);
 };
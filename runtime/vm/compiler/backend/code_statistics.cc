@@ -12,6 +12,9 @@ CombinedCodeStatistics::CombinedCodeStatistics() {
   object_header_bytes_ = 0;
   return_const_count_ = 0;
   return_const_with_load_field_count_ = 0;
+  spill_count_ = 0;
+  reload_count_ = 0;
+  spilling_functions_count_ = 0;
   intptr_t i = 0;
 
 #define DO(type, attrs)                                                        \
@@ -105,6 +108,41 @@ void CombinedCodeStatistics::DumpStatistics() {
   OS::PrintErr("% 8" Pd " return-constant-with-load-field functions\n",
                return_const_with_load_field_count_);
   OS::PrintErr("--------------------\n");
+  OS::PrintErr("% 8" Pd " spills\n", spill_count_);
+  OS::PrintErr("% 8" Pd " reloads\n", reload_count_);
+  for (intptr_t i = 0; i < spilling_functions_count_; i++) {
+    const SpillEntry& entry = spilling_functions_[i];
+    OS::PrintErr("% 8" Pd " spills % 8" Pd " reloads    -    %s\n",
+                 entry.spill_count, entry.reload_count, entry.name);
+  }
+  OS::PrintErr("--------------------\n");
+}
+
+void CombinedCodeStatistics::AddSpillingFunction(const char* name,
+                                                 intptr_t spill_count,
+                                                 intptr_t reload_count) {
+  // Keep the functions sorted by the total number of stack moves.
+  const intptr_t moves = spill_count + reload_count;
+  intptr_t i = spilling_functions_count_;
+  while (i > 0) {
+    const SpillEntry& previous = spilling_functions_[i - 1];
+    if (previous.spill_count + previous.reload_count >= moves) {
+      break;
+    }
+    if (i < kMaxSpillingFunctions) {
+      spilling_functions_[i] = previous;
+    }
+    i--;
+  }
+  if (i == kMaxSpillingFunctions) {
+    return;
+  }
+  spilling_functions_[i].name = name;
+  spilling_functions_[i].spill_count = spill_count;
+  spilling_functions_[i].reload_count = reload_count;
+  if (spilling_functions_count_ < kMaxSpillingFunctions) {
+    spilling_functions_count_++;
+  }
 }
 
 int CombinedCodeStatistics::CompareEntries(const void* a, const void* b) {
@@ -125,6 +163,8 @@ CodeStatistics::CodeStatistics(compiler::Assembler* assembler)
   instruction_bytes_ = 0;
   unaccounted_bytes_ = 0;
   alignment_bytes_ = 0;
+  spill_count_ = 0;
+  reload_count_ = 0;
 
   stack_index_ = -1;
   for (intptr_t i = 0; i < kStackSize; i++)
@@ -132,9 +172,34 @@ CodeStatistics::CodeStatistics(compiler::Assembler* assembler)
 }
 
 void CodeStatistics::Begin(Instruction* instruction) {
+  // Block entries and gotos emit the moves on control flow edges.
+  if (auto* move = instruction->AsParallelMove()) {
+    CountStackMoves(move);
+  } else if (auto* block = instruction->AsBlockEntry()) {
+    if (block->HasParallelMove()) {
+      CountStackMoves(block->parallel_move());
+    }
+  } else if (auto* jump = instruction->AsGoto()) {
+    if (jump->HasParallelMove()) {
+      CountStackMoves(jump->parallel_move());
+    }
+  }
   SpecialBegin(static_cast<intptr_t>(instruction->statistics_tag()));
 }
 
+void CodeStatistics::CountStackMoves(ParallelMoveInstr* parallel_move) {
+  for (intptr_t i = 0; i < parallel_move->NumMoves(); i++) {
+    const MoveOperands* move = parallel_move->MoveOperandsAt(i);
+    if (move->IsRedundant()) continue;
+    if (move->dest().HasStackIndex() && !move->src().IsConstant()) {
+      spill_count_++;
+    }
+    if (move->src().HasStackIndex()) {
+      reload_count_++;
+    }
+  }
+}
+
 void CodeStatistics::End(Instruction* instruction) {
   SpecialEnd(static_cast<intptr_t>(instruction->statistics_tag()));
 }
@@ -199,6 +264,8 @@ void CodeStatistics::AppendTo(CombinedCodeStatistics* stat) {
   stat->unaccounted_bytes_ += unaccounted_bytes_;
   ASSERT(stat->unaccounted_bytes_ >= 0);
   stat->alignment_bytes_ += alignment_bytes_;
+  stat->spill_count_ += spill_count_;
+  stat->reload_count_ += reload_count_;
   stat->object_header_bytes_ += Instructions::HeaderSize();
 
   if (returns_constant) stat->return_const_count_++;
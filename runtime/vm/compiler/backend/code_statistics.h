@@ -45,6 +45,12 @@ class CombinedCodeStatistics {
 
   void DumpStatistics();
 
+  // Records spill and reload counts of a single function, so that the
+  // functions with most stack traffic can be listed.
+  void AddSpillingFunction(const char* name,
+                           intptr_t spill_count,
+                           intptr_t reload_count);
+
   static EntryCounter SlowPathCounterFor(Instruction::Tag tag) {
     return static_cast<CombinedCodeStatistics::EntryCounter>(
         CombinedCodeStatistics::kTagGraphEntrySlowPath + tag);
@@ -55,18 +61,30 @@ class CombinedCodeStatistics {
 
   static int CompareEntries(const void* a, const void* b);
 
+  static const intptr_t kMaxSpillingFunctions = 20;
+
   typedef struct {
     const char* name;
     intptr_t bytes;
     intptr_t count;
   } Entry;
 
+  typedef struct {
+    const char* name;
+    intptr_t spill_count;
+    intptr_t reload_count;
+  } SpillEntry;
+
   Entry entries_[kNumEntries];
+  SpillEntry spilling_functions_[kMaxSpillingFunctions];
+  intptr_t spilling_functions_count_;
   intptr_t unaccounted_bytes_;
   intptr_t alignment_bytes_;
   intptr_t object_header_bytes_;
   intptr_t return_const_count_;
   intptr_t return_const_with_load_field_count_;
+  intptr_t spill_count_;
+  intptr_t reload_count_;
 };
 
 class CodeStatistics {
@@ -83,9 +101,16 @@ class CodeStatistics {
 
   void Finalize();
 
+  // Number of moves emitted by parallel moves which store a value into
+  // a stack slot (spills) or load a value from one (reloads).
+  intptr_t spill_count() const { return spill_count_; }
+  intptr_t reload_count() const { return reload_count_; }
+
  private:
   static const int kStackSize = 8;
 
+  void CountStackMoves(ParallelMoveInstr* move);
+
   compiler::Assembler* assembler_;
 
   typedef struct {
@@ -97,6 +122,8 @@ class CodeStatistics {
   intptr_t instruction_bytes_;
   intptr_t unaccounted_bytes_;
   intptr_t alignment_bytes_;
+  intptr_t spill_count_;
+  intptr_t reload_count_;
 
   intptr_t stack_[kStackSize];
   intptr_t stack_index_;
@@ -0,0 +1,47 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/code_statistics.h"
+
+#include "vm/compiler/backend/il.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#define Reg(index) (static_cast<Register>(index))
+#define RegLoc(index) Location::RegisterLocation(Reg(index))
+#define SlotLoc(index) Location::StackSlot(index, FPREG)
+
+ISOLATE_UNIT_TEST_CASE(CodeStatistics_SpillsAndReloads) {
+  compiler::ObjectPoolBuilder object_pool_builder;
+  compiler::Assembler assembler(&object_pool_builder);
+  CodeStatistics stats(&assembler);
+
+  ParallelMoveInstr* parallel_move = new ParallelMoveInstr();
+  parallel_move->AddMove(SlotLoc(0), RegLoc(0));  // Spill.
+  parallel_move->AddMove(RegLoc(1), SlotLoc(1));  // Reload.
+  parallel_move->AddMove(SlotLoc(2), SlotLoc(3));  // Spill and reload.
+  parallel_move->AddMove(RegLoc(2), RegLoc(3));
+  parallel_move->AddMove(RegLoc(4), RegLoc(4));  // Redundant.
+  // Constants are rematerialized rather than spilled.
+  ConstantInstr* constant = new ConstantInstr(Smi::ZoneHandle(Smi::New(42)));
+  parallel_move->AddMove(SlotLoc(4), Location::Constant(constant));
+  stats.Begin(parallel_move);
+  stats.End(parallel_move);
+  EXPECT_EQ(2, stats.spill_count());
+  EXPECT_EQ(2, stats.reload_count());
+
+  // Moves on control flow edges are attached to gotos.
+  JoinEntryInstr* join =
+      new JoinEntryInstr(1, kInvalidTryIndex, DeoptId::kNone);
+  GotoInstr* jump = new GotoInstr(join, DeoptId::kNone);
+  jump->GetParallelMove()->AddMove(SlotLoc(5), RegLoc(5));
+  stats.Begin(jump);
+  stats.End(jump);
+  EXPECT_EQ(3, stats.spill_count());
+  EXPECT_EQ(2, stats.reload_count());
+}
+
+}  // namespace dart
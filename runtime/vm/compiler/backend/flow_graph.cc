@@ -2069,9 +2069,165 @@ static void UnboxPhi(PhiInstr* phi, bool is_aot) {
   phi->set_representation(unboxed);
 }
 
+// Whether the integer [constant] can be unboxed into [rep] without
+// truncation.
+static bool FitsIntegerRepresentation(ConstantInstr* constant,
+                                      Representation rep) {
+  if (!constant->value().IsInteger()) {
+    return false;
+  }
+  const int64_t value = Integer::Cast(constant->value()).AsInt64Value();
+  switch (rep) {
+    case kUnboxedInt64:
+      return true;
+    case kUnboxedInt32:
+      return Utils::IsInt(32, value);
+    case kUnboxedUint32:
+      return Utils::IsUint(32, value);
+    default:
+      return false;
+  }
+}
+
+static bool IsIntegerConstant(Definition* def) {
+  return (def->representation() == kTagged) && def->IsConstant() &&
+         def->AsConstant()->value().IsInteger();
+}
+
+// Returns the unboxed representation of the candidate [phi] given the
+// representations of its inputs so far, or kTagged if none of them is
+// unboxed yet.
+static Representation JoinIntegerRepresentations(
+    PhiInstr* phi,
+    const BitVector& is_candidate) {
+  Representation rep = kTagged;
+  for (intptr_t i = 0; i < phi->InputCount(); i++) {
+    Definition* input = phi->InputAt(i)->definition();
+    Representation input_rep = input->representation();
+    if ((input == phi) || IsIntegerConstant(input)) continue;
+    if (input_rep == kTagged) {
+      // Still undecided candidates are skipped, other tagged phis only
+      // merge integer constants.
+      if (is_candidate.Contains(input->ssa_temp_index())) continue;
+      input_rep = kUnboxedInt64;
+    }
+    if (rep == kTagged) {
+      rep = input_rep;
+    } else if ((rep != input_rep) && (rep != kUnboxedInt64)) {
+      rep = (input_rep != kUnboxedInt64) &&
+                    RangeUtils::Fits(phi->range(),
+                                     RangeBoundary::kRangeBoundaryInt32)
+                ? kUnboxedInt32
+                : kUnboxedInt64;
+    }
+  }
+  if (rep == kTagged) {
+    return rep;
+  }
+  for (intptr_t i = 0; i < phi->InputCount(); i++) {
+    Definition* input = phi->InputAt(i)->definition();
+    if (IsIntegerConstant(input) &&
+        !FitsIntegerRepresentation(input->AsConstant(), rep)) {
+      return kUnboxedInt64;
+    }
+  }
+  return rep;
+}
+
+// Unboxes integer phis which merge only unboxed integers, integer constants
+// and other such phis. This keeps loop variables unboxed across back-edges
+// even if their initial value is a constant, as is common for counters and
+// for the accumulators of hash and checksum loops.
+//
+// The phis of nested loops use each other across back-edges, so candidates
+// are chosen optimistically and pruned until every input of a remaining
+// candidate is unboxed. The representation of a candidate is then the join
+// of the representations of its inputs in the lattice
+//
+//   kTagged (undecided) < kUnboxedInt32, kUnboxedUint32 < kUnboxedInt64
+//
+// where the join of kUnboxedInt32 and kUnboxedUint32 is kUnboxedInt32 only
+// if the range of the phi fits into 32 bits.
+static void UnboxIntegerPhis(FlowGraph* flow_graph) {
+  Zone* zone = flow_graph->zone();
+  GrowableArray<PhiInstr*> candidates;
+  BitVector is_candidate(zone, flow_graph->current_ssa_temp_index());
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    JoinEntryInstr* join_entry = block_it.Current()->AsJoinEntry();
+    if (join_entry == nullptr) continue;
+    for (PhiIterator it(join_entry); !it.Done(); it.Advance()) {
+      PhiInstr* phi = it.Current();
+      if ((phi->representation() == kTagged) && phi->Type()->IsInt() &&
+          !phi->Type()->can_be_sentinel() && phi->HasSSATemp()) {
+        candidates.Add(phi);
+        is_candidate.Add(phi->ssa_temp_index());
+      }
+    }
+  }
+  if (candidates.is_empty()) {
+    return;
+  }
+
+  auto is_unboxable_input = [&](PhiInstr* phi, Definition* input) {
+    if ((input == phi) || IsIntegerConstant(input) ||
+        IsUnboxedInteger(input->representation())) {
+      return true;
+    }
+    return input->IsPhi() && input->HasSSATemp() &&
+           is_candidate.Contains(input->ssa_temp_index());
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto phi : candidates) {
+      if (!is_candidate.Contains(phi->ssa_temp_index())) continue;
+      for (intptr_t i = 0; i < phi->InputCount(); i++) {
+        if (!is_unboxable_input(phi, phi->InputAt(i)->definition())) {
+          is_candidate.Remove(phi->ssa_temp_index());
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Candidates which merge only constants and each other stay tagged. The
+  // phis which use them are unboxed into kUnboxedInt64, which can represent
+  // any of their values.
+  for (;;) {
+    changed = true;
+    while (changed) {
+      changed = false;
+      for (auto phi : candidates) {
+        if (!is_candidate.Contains(phi->ssa_temp_index())) continue;
+        const Representation rep =
+            JoinIntegerRepresentations(phi, is_candidate);
+        if (rep != phi->representation()) {
+          phi->set_representation(rep);
+          changed = true;
+        }
+      }
+    }
+
+    bool removed = false;
+    for (auto phi : candidates) {
+      if (is_candidate.Contains(phi->ssa_temp_index()) &&
+          (phi->representation() == kTagged)) {
+        is_candidate.Remove(phi->ssa_temp_index());
+        removed = true;
+      }
+    }
+    if (!removed) break;
+  }
+}
+
 void FlowGraph::SelectRepresentations() {
   const auto is_aot = CompilerState::Current().is_aot();
 
+  UnboxIntegerPhis(this);
+
   // First we decide for each phi if it is beneficial to unbox it. If so, we
   // change it's `phi->representation()`
   for (BlockIterator block_it = reverse_postorder_iterator(); !block_it.Done();
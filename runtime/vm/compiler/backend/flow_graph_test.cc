@@ -81,6 +81,87 @@ ISOLATE_UNIT_TEST_CASE(FlowGraph_UnboxInt64Phi) {
 }
 #endif  // defined(TARGET_ARCH_IS_64_BIT)
 
+// The phis of a nested Uint32 loop use each other across back-edges and
+// start out from a constant, yet both stay unboxed as Uint32.
+ISOLATE_UNIT_TEST_CASE(FlowGraph_UnboxUint32PhisOfNestedLoops) {
+  using compiler::BlockBuilder;
+
+  CompilerState S(thread, /*is_aot=*/true, /*is_optimizing=*/true);
+  FlowGraphBuilderHelper H;
+
+  auto normal_entry = H.flow_graph()->graph_entry()->normal_entry();
+  auto outer_header = H.JoinEntry();
+  auto outer_body = H.TargetEntry();
+  auto outer_exit = H.TargetEntry();
+  auto inner_header = H.JoinEntry();
+  auto inner_body = H.TargetEntry();
+  auto inner_exit = H.TargetEntry();
+
+  PhiInstr* outer_var;
+  PhiInstr* inner_var;
+  Definition* add1;
+
+  {
+    BlockBuilder builder(H.flow_graph(), normal_entry);
+    builder.AddInstruction(new GotoInstr(outer_header, S.GetNextDeoptId()));
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), outer_header);
+    outer_var = H.Phi(outer_header, {{normal_entry, H.IntConstant(0)},
+                                     {inner_exit, &inner_var}});
+    builder.AddPhi(outer_var);
+    builder.AddBranch(new RelationalOpInstr(
+                          InstructionSource(), Token::kLT, new Value(outer_var),
+                          new Value(H.IntConstant(1000)), kMintCid,
+                          S.GetNextDeoptId(), Instruction::kNotSpeculative),
+                      outer_body, outer_exit);
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), outer_body);
+    builder.AddInstruction(new GotoInstr(inner_header, S.GetNextDeoptId()));
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), inner_header);
+    inner_var = H.Phi(inner_header,
+                      {{outer_body, outer_var}, {inner_body, &add1}});
+    builder.AddPhi(inner_var);
+    builder.AddBranch(new RelationalOpInstr(
+                          InstructionSource(), Token::kLT, new Value(inner_var),
+                          new Value(H.IntConstant(100)), kMintCid,
+                          S.GetNextDeoptId(), Instruction::kNotSpeculative),
+                      inner_body, inner_exit);
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), inner_body);
+    add1 = builder.AddDefinition(new BinaryUint32OpInstr(
+        Token::kADD, new Value(inner_var), new Value(H.IntConstant(1)),
+        S.GetNextDeoptId()));
+    builder.AddInstruction(new GotoInstr(inner_header, S.GetNextDeoptId()));
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), inner_exit);
+    builder.AddInstruction(new GotoInstr(outer_header, S.GetNextDeoptId()));
+  }
+
+  {
+    BlockBuilder builder(H.flow_graph(), outer_exit);
+    builder.AddReturn(new Value(outer_var));
+  }
+
+  H.FinishGraph();
+
+  FlowGraphTypePropagator::Propagate(H.flow_graph());
+  H.flow_graph()->SelectRepresentations();
+
+  EXPECT_PROPERTY(outer_var, it.representation() == kUnboxedUint32);
+  EXPECT_PROPERTY(inner_var, it.representation() == kUnboxedUint32);
+}
+
 ISOLATE_UNIT_TEST_CASE(FlowGraph_LateVariablePhiUnboxing) {
   using compiler::BlockBuilder;
 
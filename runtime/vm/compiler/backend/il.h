@@ -797,6 +797,11 @@ class Instruction : public ZoneAllocated {
     return GetDeoptId();
   }
 
+  // Deopt id for a copy of this instruction, which deoptimizes to the same
+  // target. Unlike deopt_id(), does not require the instruction to be able
+  // to deoptimize.
+  intptr_t deopt_id_for_copy() const { return GetDeoptId(); }
+
   static const ICData* GetICData(
       const ZoneGrowableArray<const ICData*>& ic_data_array,
       intptr_t deopt_id,
@@ -1857,7 +1862,8 @@ class TargetEntryInstr : public BlockEntryInstr {
                    intptr_t stack_depth = 0)
       : BlockEntryInstr(block_id, try_index, deopt_id, stack_depth),
         predecessor_(NULL),
-        edge_weight_(0.0) {}
+        edge_weight_(0.0),
+        is_cold_(false) {}
 
   DECLARE_INSTRUCTION(TargetEntry)
 
@@ -1865,6 +1871,11 @@ class TargetEntryInstr : public BlockEntryInstr {
   void set_edge_weight(double weight) { edge_weight_ = weight; }
   void adjust_edge_weight(double scale_factor) { edge_weight_ *= scale_factor; }
 
+  // Whether the code starting at this target is not expected to run, e.g.
+  // because it never ran according to the AOT profile.
+  bool is_cold() const { return is_cold_; }
+  void set_is_cold(bool value) { is_cold_ = value; }
+
   virtual intptr_t PredecessorCount() const {
     return (predecessor_ == NULL) ? 0 : 1;
   }
@@ -1886,6 +1897,7 @@ class TargetEntryInstr : public BlockEntryInstr {
 
   BlockEntryInstr* predecessor_;
   double edge_weight_;
+  bool is_cold_;
 
   DISALLOW_COPY_AND_ASSIGN(TargetEntryInstr);
 };
@@ -4259,6 +4271,11 @@ class PolymorphicInstanceCallInstr : public InstanceCallBaseInstr {
 
   bool complete() const { return complete_; }
 
+  // Whether the targets were taken from the receivers recorded in the AOT
+  // profile, so that receivers of other classes are expected as well.
+  bool targets_from_profile() const { return targets_from_profile_; }
+  void set_targets_from_profile() { targets_from_profile_ = true; }
+
   virtual CompileType ComputeType() const;
 
   bool HasOnlyDispatcherOrImplicitAccessorTargets() const;
@@ -4320,6 +4337,7 @@ class PolymorphicInstanceCallInstr : public InstanceCallBaseInstr {
 
   const CallTargets& targets_;
   const bool complete_;
+  bool targets_from_profile_ = false;
   intptr_t total_call_count_;
 
   friend class PolymorphicInliner;
@@ -5703,6 +5721,7 @@ class LoadIndexedInstr : public TemplateDefinition<2, NoThrow> {
 
   Value* array() const { return inputs_[0]; }
   Value* index() const { return inputs_[1]; }
+  bool index_unboxed() const { return index_unboxed_; }
   intptr_t index_scale() const { return index_scale_; }
   intptr_t class_id() const { return class_id_; }
   bool aligned() const { return alignment_ == kAlignedAccess; }
@@ -5950,9 +5969,11 @@ class StoreIndexedInstr : public TemplateInstruction<3, NoThrow> {
   Value* index() const { return inputs_[kIndexPos]; }
   Value* value() const { return inputs_[kValuePos]; }
 
+  bool index_unboxed() const { return index_unboxed_; }
   intptr_t index_scale() const { return index_scale_; }
   intptr_t class_id() const { return class_id_; }
   bool aligned() const { return alignment_ == kAlignedAccess; }
+  StoreBarrierType emit_store_barrier() const { return emit_store_barrier_; }
 
   bool ShouldEmitStoreBarrier() const {
     if (array()->definition() == value()->definition()) {
@@ -6597,6 +6618,7 @@ class LoadClassIdInstr : public TemplateDefinition<1, NoThrow, Pure> {
   virtual Definition* Canonicalize(FlowGraph* flow_graph);
 
   Value* object() const { return inputs_[0]; }
+  bool input_can_be_smi() const { return input_can_be_smi_; }
 
   virtual bool ComputeCanDeoptimize() const { return false; }
 
@@ -8226,6 +8248,7 @@ class CheckStackOverflowInstr : public TemplateInstruction<0, NoThrow> {
   bool in_loop() const { return loop_depth_ > 0; }
   intptr_t stack_depth() const { return stack_depth_; }
   intptr_t loop_depth() const { return loop_depth_; }
+  Kind kind() const { return kind_; }
 
   DECLARE_INSTRUCTION(CheckStackOverflow)
 
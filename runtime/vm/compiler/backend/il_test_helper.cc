@@ -92,6 +92,35 @@ ObjectPtr Invoke(const Library& lib, const char* name) {
   return Api::UnwrapHandle(result);
 }
 
+intptr_t CountInstructions(FlowGraph* flow_graph, Instruction::Tag tag) {
+  intptr_t count = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      if (it.Current()->tag() == tag) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+intptr_t CountSimdOps(FlowGraph* flow_graph, SimdOpInstr::Kind kind) {
+  intptr_t count = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      SimdOpInstr* op = it.Current()->AsSimdOp();
+      if (op != nullptr && op->kind() == kind) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
 FlowGraph* TestPipeline::RunPasses(
     std::initializer_list<CompilerPass::Id> passes) {
   // The table dispatch transformation needs a precompiler, which is not
@@ -65,6 +65,12 @@ TypeParameterPtr GetFunctionTypeParameter(const Function& fun, intptr_t index);
 
 ObjectPtr Invoke(const Library& lib, const char* name);
 
+// Returns the number of instructions with the given tag in the flow graph.
+intptr_t CountInstructions(FlowGraph* flow_graph, Instruction::Tag tag);
+
+// Returns the number of SIMD operations of the given kind in the flow graph.
+intptr_t CountSimdOps(FlowGraph* flow_graph, SimdOpInstr::Kind kind);
+
 class TestPipeline : public ValueObject {
  public:
   explicit TestPipeline(const Function& function,
@@ -5,6 +5,7 @@
 #include "vm/compiler/backend/inliner.h"
 
 #include "vm/compiler/aot/aot_call_specializer.h"
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/aot/precompiler.h"
 #include "vm/compiler/backend/block_scheduler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
@@ -72,6 +73,12 @@ DEFINE_FLAG(int,
             inlining_recursion_depth_threshold,
             1,
             "Inline recursive function calls up to threshold recursion depth.");
+DEFINE_FLAG(int,
+            aot_cold_inlining_depth_threshold,
+            1,
+            "Inline function calls up to threshold nesting depth in AOT "
+            "compiled functions which never ran according to the AOT "
+            "profile.");
 DEFINE_FLAG(int,
             max_inlined_per_depth,
             500,
@@ -354,16 +361,50 @@ class CallSites : public ValueObject {
     }
   }
 
+  // Returns the number of times [call] ran according to the AOT profile of
+  // its function, if there is one, or a static estimate otherwise. Calls
+  // missing from the profile are assumed to be as hot as the hottest call.
+  static intptr_t AotCallCount(const AotProfile::FunctionProfile* profile,
+                               Instruction* call,
+                               intptr_t nesting_depth) {
+    if (profile == nullptr) {
+      return AotCallCountApproximation(nesting_depth);
+    }
+    const AotProfile::CallSite* site =
+        profile->LookupCallSite(call->token_pos());
+    return site != nullptr ? site->count() : profile->max_call_count();
+  }
+
+  static const AotProfile::FunctionProfile* LookupProfile(
+      const FlowGraph* graph) {
+    const AotProfile* aot_profile = CompilerState::Current().aot_profile();
+    if (aot_profile == nullptr) {
+      return nullptr;
+    }
+    const AotProfile::FunctionProfile* profile =
+        aot_profile->LookupFunction(graph->function());
+    // Without any executed call the profile cannot rank the calls.
+    if (profile == nullptr || profile->max_call_count() == 0) {
+      return nullptr;
+    }
+    return profile;
+  }
+
   // Computes the ratio for each call site in a method, defined as the
   // number of times a call site is executed over the maximum number of
   // times any call site is executed in the method. JIT uses actual call
-  // counts whereas AOT uses a static estimate based on nesting depth.
-  void ComputeCallSiteRatio(intptr_t static_call_start_ix,
+  // counts whereas AOT uses the AOT profile, if given, or a static estimate
+  // based on nesting depth.
+  void ComputeCallSiteRatio(const FlowGraph* graph,
+                            intptr_t static_call_start_ix,
                             intptr_t instance_call_start_ix) {
     const intptr_t num_static_calls =
         static_calls_.length() - static_call_start_ix;
     const intptr_t num_instance_calls =
         instance_calls_.length() - instance_call_start_ix;
+    const bool is_aot = CompilerState::Current().is_aot();
+    const AotProfile::FunctionProfile* profile =
+        is_aot ? LookupProfile(graph) : nullptr;
 
     intptr_t max_count = 0;
     GrowableArray<intptr_t> instance_call_counts(num_instance_calls);
@@ -371,9 +412,8 @@ class CallSites : public ValueObject {
       const InstanceCallInfo& info =
           instance_calls_[i + instance_call_start_ix];
       intptr_t aggregate_count =
-          CompilerState::Current().is_aot()
-              ? AotCallCountApproximation(info.nesting_depth)
-              : info.call->CallCount();
+          is_aot ? AotCallCount(profile, info.call, info.nesting_depth)
+                 : info.call->CallCount();
       instance_call_counts.Add(aggregate_count);
       if (aggregate_count > max_count) max_count = aggregate_count;
     }
@@ -382,9 +422,8 @@ class CallSites : public ValueObject {
     for (intptr_t i = 0; i < num_static_calls; ++i) {
       const StaticCallInfo& info = static_calls_[i + static_call_start_ix];
       intptr_t aggregate_count =
-          CompilerState::Current().is_aot()
-              ? AotCallCountApproximation(info.nesting_depth)
-              : info.call->CallCount();
+          is_aot ? AotCallCount(profile, info.call, info.nesting_depth)
+                 : info.call->CallCount();
       static_call_counts.Add(aggregate_count);
       if (aggregate_count > max_count) max_count = aggregate_count;
     }
@@ -518,7 +557,7 @@ class CallSites : public ValueObject {
         }
       }
     }
-    ComputeCallSiteRatio(static_call_start_ix, instance_call_start_ix);
+    ComputeCallSiteRatio(graph, static_call_start_ix, instance_call_start_ix);
   }
 
  private:
@@ -604,6 +643,10 @@ class PolymorphicInliner : public ValueObject {
   bool CheckInlinedDuplicate(const Function& target);
   bool CheckNonInlinedDuplicate(const Function& target);
 
+  // Whether the decision graph ends in a call for receivers of classes
+  // which were not inlined.
+  bool HasFallback() const;
+
   bool TryInliningPoly(const TargetInfo& target);
   bool TryInlineRecognizedMethod(intptr_t receiver_cid, const Function& target);
 
@@ -1568,8 +1611,11 @@ class CallSiteInliner : public ValueObject {
                              call_info.length()));
     for (intptr_t call_idx = 0; call_idx < call_info.length(); ++call_idx) {
       PolymorphicInstanceCallInstr* call = call_info[call_idx].call;
-      // PolymorphicInliner introduces deoptimization paths.
-      if (!call->complete() && !FLAG_polymorphic_with_deopt) {
+      // PolymorphicInliner introduces deoptimization paths, except for calls
+      // devirtualized by the AOT profile, which keep a generic call for other
+      // receivers.
+      if (!call->complete() && !FLAG_polymorphic_with_deopt &&
+          !call->targets_from_profile()) {
         TRACE_INLINING(THR_Print("  => %s\n     Bailout: call with checks\n",
                                  call->function_name().ToCString()));
         continue;
@@ -1796,6 +1842,12 @@ bool PolymorphicInliner::CheckNonInlinedDuplicate(const Function& target) {
   return false;
 }
 
+bool PolymorphicInliner::HasFallback() const {
+  // Receivers of a call devirtualized by the AOT profile can be of any
+  // class, and cannot be checked without deoptimization.
+  return !non_inlined_variants_->is_empty() || call_->targets_from_profile();
+}
+
 bool PolymorphicInliner::TryInliningPoly(const TargetInfo& target_info) {
   if ((!CompilerState::Current().is_aot() ||
        owner_->inliner_->speculative_policy()->AllowsSpeculativeInlining()) &&
@@ -1923,7 +1975,7 @@ TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
     // 1. Guard the body with a class id check.  We don't need any check if
     // it's the last test and global analysis has told us that the call is
     // complete.
-    if (is_last_test && non_inlined_variants_->is_empty()) {
+    if (is_last_test && !HasFallback()) {
       // If it is the last variant use a check class id instruction which can
       // deoptimize, followed unconditionally by the body. Omit the check if
       // we know that we have covered all possible classes.
@@ -2114,9 +2166,15 @@ TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
   ASSERT(!call_->HasPushArguments());
 
   // Handle any non-inlined variants.
-  if (!non_inlined_variants_->is_empty()) {
+  if (HasFallback()) {
+    // The fallback of a call devirtualized by the AOT profile is a generic
+    // call, which does not test the classes of its targets, so it keeps the
+    // original targets if all of them were inlined.
+    const CallTargets& fallback_targets = non_inlined_variants_->is_empty()
+                                              ? variants_
+                                              : *non_inlined_variants_;
     PolymorphicInstanceCallInstr* fallback_call =
-        PolymorphicInstanceCallInstr::FromCall(Z, call_, *non_inlined_variants_,
+        PolymorphicInstanceCallInstr::FromCall(Z, call_, fallback_targets,
                                                call_->complete());
     fallback_call->set_ssa_temp_index(
         owner_->caller_graph()->alloc_ssa_temp_index());
@@ -2368,6 +2426,14 @@ bool FlowGraphInliner::AlwaysInline(const Function& function) {
   return false;
 }
 
+static bool IsColdInAotProfile(const Function& function) {
+  const AotProfile* profile = CompilerState::Current().aot_profile();
+  // A sampled profile misses functions which ran between samples, so only
+  // a counted profile shows that a function never ran.
+  return (profile != nullptr) && !profile->is_sampled() &&
+         profile->IsCold(function);
+}
+
 int FlowGraphInliner::Inline() {
   // Collect some early graph information assuming it is non-specialized
   // so that the cached approximation may be used later for an early
@@ -2399,6 +2465,13 @@ int FlowGraphInliner::Inline() {
   }
 
   intptr_t inlining_depth_threshold = FLAG_inlining_depth_threshold;
+  // Code which never ran is not worth the compile time and code size of
+  // deep inlining.
+  if (IsColdInAotProfile(top)) {
+    inlining_depth_threshold =
+        Utils::Minimum<intptr_t>(inlining_depth_threshold,
+                                 FLAG_aot_cold_inlining_depth_threshold);
+  }
 
   CallSiteInliner inliner(this, inlining_depth_threshold);
   inliner.InlineCalls();
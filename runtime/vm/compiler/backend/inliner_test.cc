@@ -4,6 +4,7 @@
 
 #include "vm/compiler/backend/inliner.h"
 
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/backend/il.h"
 #include "vm/compiler/backend/il_printer.h"
 #include "vm/compiler/backend/il_test_helper.h"
@@ -13,6 +14,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, aot_cold_inlining_depth_threshold);
+
 // Test that the redefinition for an inlined polymorphic function used with
 // multiple receiver cids does not have a concrete type.
 ISOLATE_UNIT_TEST_CASE(Inliner_PolyInliningRedefinition) {
@@ -246,6 +249,145 @@ ISOLATE_UNIT_TEST_CASE(Inliner_List_generate) {
   }));
 }
 
+// Test that inlining a call devirtualized by the AOT profile keeps a generic
+// call for other receivers, since the call cannot deoptimize.
+ISOLATE_UNIT_TEST_CASE(Inliner_PolyInliningWithFallback) {
+  const char* kScript = R"(
+    class B {
+      int toInline() => 1;
+    }
+    class C {
+      int toInline() => 2;
+    }
+
+    testInlining(dynamic arg) => arg.toInline();
+
+    main() {
+      for (var i = 0; i < 10; i++) {
+        testInlining(B());
+        testInlining(C());
+      }
+    }
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function =
+      Function::Handle(GetFunction(root_library, "testInlining"));
+
+  Invoke(root_library, "main");
+
+  // The profile records B and C as the receivers of the call.
+  const char* contents = AotProfile::Collect(thread);
+  const AotProfile* profile = AotProfile::Parse(
+      thread->zone(), thread->isolate_group(), contents, strlen(contents));
+  EXPECT(profile != nullptr);
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  CompilerState::Current().set_aot_profile(profile);
+  FlowGraph* flow_graph = pipeline.RunPasses({
+      CompilerPass::kComputeSSA,
+      CompilerPass::kApplyICData,
+      CompilerPass::kTryOptimizePatterns,
+      CompilerPass::kSetOuterInliningId,
+      CompilerPass::kTypePropagation,
+      CompilerPass::kApplyClassIds,
+      CompilerPass::kInlining,
+  });
+
+  intptr_t load_cids = 0;
+  intptr_t class_id_checks = 0;
+  intptr_t generic_calls = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      Instruction* current = it.Current();
+      if (current->IsLoadClassId()) load_cids++;
+      if (current->IsCheckClassId()) class_id_checks++;
+      if (auto call = current->AsPolymorphicInstanceCall()) {
+        // The fallback is not inlined again.
+        EXPECT(!call->complete());
+        EXPECT(!call->targets_from_profile());
+        generic_calls++;
+      }
+    }
+  }
+  EXPECT_EQ(1, load_cids);
+  EXPECT_EQ(0, class_id_checks);
+  EXPECT_EQ(1, generic_calls);
+}
+
+// Returns the number of static calls left in [function] after inlining
+// using the given profile.
+static intptr_t CountStaticCallsAfterInlining(const Function& function,
+                                              const AotProfile* profile) {
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  CompilerState::Current().set_aot_profile(profile);
+  FlowGraph* flow_graph = pipeline.RunPasses({
+      CompilerPass::kComputeSSA,
+      CompilerPass::kApplyICData,
+      CompilerPass::kTryOptimizePatterns,
+      CompilerPass::kSetOuterInliningId,
+      CompilerPass::kTypePropagation,
+      CompilerPass::kApplyClassIds,
+      CompilerPass::kInlining,
+  });
+
+  intptr_t static_calls = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      if (it.Current()->IsStaticCall()) static_calls++;
+    }
+  }
+  return static_calls;
+}
+
+// Test that functions which never ran according to a counted profile are
+// inlined less deeply, while those which ran and those missing from a
+// sampled profile are not.
+ISOLATE_UNIT_TEST_CASE(Inliner_ColdFunctionInliningDepth) {
+  const char* kScript = R"(
+    int leaf() => 1;
+    int mid() => leaf() + 1;
+    int top() => mid() + 1;
+
+    int test() => top() + 1;
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "test"));
+  const auto& top = Function::Handle(GetFunction(root_library, "top"));
+  const char* test_name = function.ToFullyQualifiedCString();
+  const char* top_name = top.ToFullyQualifiedCString();
+
+  // Calls made by inlined functions are not considered below the threshold.
+  SetFlagScope<int> sfs(&FLAG_aot_cold_inlining_depth_threshold, 1);
+
+  const char* contents = OS::SCreate(thread->zone(), "function 5 %s\n",
+                                     test_name);
+  const AotProfile* profile = AotProfile::Parse(
+      thread->zone(), thread->isolate_group(), contents, strlen(contents));
+  EXPECT(profile != nullptr);
+  EXPECT_EQ(0, CountStaticCallsAfterInlining(function, profile));
+
+  // Only top() is inlined into the cold function, leaving its call to mid().
+  contents = OS::SCreate(thread->zone(), "function 0 %s\nfunction 5 %s\n",
+                         test_name, top_name);
+  profile = AotProfile::Parse(thread->zone(), thread->isolate_group(),
+                              contents, strlen(contents));
+  EXPECT(profile != nullptr);
+  EXPECT_EQ(1, CountStaticCallsAfterInlining(function, profile));
+
+  contents = OS::SCreate(thread->zone(), "sampled\nfunction 5 %s\n",
+                         top_name);
+  profile = AotProfile::Parse(thread->zone(), thread->isolate_group(),
+                              contents, strlen(contents));
+  EXPECT(profile != nullptr);
+  EXPECT_EQ(0, CountStaticCallsAfterInlining(function, profile));
+}
+
 #endif  // defined(DART_PRECOMPILER)
 
 }  // namespace dart
@@ -1877,6 +1877,7 @@ void FlowGraphAllocator::SpillBetween(LiveRange* range,
   TRACE_ALLOC(THR_Print("spill v%" Pd " [%" Pd ", %" Pd ") "
                         "between [%" Pd ", %" Pd ")\n",
                         range->vreg(), range->Start(), range->End(), from, to));
+  from = HoistSpillPosition(range, from);
   LiveRange* tail = range->SplitAt(from);
 
   if (tail->Start() < to) {
@@ -1894,23 +1895,29 @@ void FlowGraphAllocator::SpillAfter(LiveRange* range, intptr_t from) {
   TRACE_ALLOC(THR_Print("spill v%" Pd " [%" Pd ", %" Pd ") after %" Pd "\n",
                         range->vreg(), range->Start(), range->End(), from));
 
-  // When spilling the value inside the loop check if this spill can
-  // be moved outside.
-  LoopInfo* loop_info = BlockEntryAt(from)->loop_info();
-  if (loop_info != nullptr) {
-    if ((range->Start() <= loop_info->header()->start_pos()) &&
-        RangeHasOnlyUnconstrainedUsesInLoop(range, loop_info->id())) {
-      ASSERT(loop_info->header()->start_pos() <= from);
-      from = loop_info->header()->start_pos();
-      TRACE_ALLOC(
-          THR_Print("  moved spill position to loop header %" Pd "\n", from));
-    }
-  }
-
+  from = HoistSpillPosition(range, from);
   LiveRange* tail = range->SplitAt(from);
   Spill(tail);
 }
 
+intptr_t FlowGraphAllocator::HoistSpillPosition(LiveRange* range,
+                                                intptr_t from) {
+  // When spilling the value inside the loop check if this spill can
+  // be moved outside. Otherwise the value would have to be reloaded on
+  // every back edge into the register it occupies at the loop header.
+  LoopInfo* loop_info = BlockEntryAt(from)->loop_info();
+  while ((loop_info != nullptr) &&
+         (range->Start() <= loop_info->header()->start_pos()) &&
+         RangeHasOnlyUnconstrainedUsesInLoop(range, loop_info->id())) {
+    ASSERT(loop_info->header()->start_pos() <= from);
+    from = loop_info->header()->start_pos();
+    TRACE_ALLOC(
+        THR_Print("  moved spill position to loop header %" Pd "\n", from));
+    loop_info = loop_info->outer();
+  }
+  return from;
+}
+
 void FlowGraphAllocator::AllocateSpillSlotFor(LiveRange* range) {
   ASSERT(range->spill_slot().IsInvalid());
 
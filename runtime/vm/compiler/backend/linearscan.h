@@ -248,6 +248,11 @@ class FlowGraphAllocator : public ValueObject {
   // position preceding the to position.
   void SpillBetween(LiveRange* range, intptr_t from, intptr_t to);
 
+  // Move the position at which the given live range is spilled to the
+  // header of the outermost enclosing loop in which the range has only
+  // unconstrained uses.
+  intptr_t HoistSpillPosition(LiveRange* range, intptr_t from);
+
   // Mark the live range as a live object pointer at all safepoints
   // contained in the range.
   void MarkAsObjectAtSafepoints(LiveRange* range);
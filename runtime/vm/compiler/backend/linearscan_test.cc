@@ -0,0 +1,113 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/linearscan.h"
+
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/backend/loops.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(DART_PRECOMPILER)
+
+// Returns the number of moves of the given parallel move which store a
+// value into a stack slot.
+static intptr_t CountSpills(ParallelMoveInstr* parallel_move) {
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < parallel_move->NumMoves(); i++) {
+    const MoveOperands* move = parallel_move->MoveOperandsAt(i);
+    if (!move->IsRedundant() && move->dest().HasStackIndex() &&
+        !move->src().IsConstant()) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// Returns the number of spills in the given block, including those on its
+// incoming and outgoing control flow edges.
+static intptr_t CountSpills(BlockEntryInstr* block) {
+  intptr_t count = 0;
+  if (block->HasParallelMove()) {
+    count += CountSpills(block->parallel_move());
+  }
+  for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+    if (ParallelMoveInstr* move = it.Current()->AsParallelMove()) {
+      count += CountSpills(move);
+    } else if (GotoInstr* jump = it.Current()->AsGoto()) {
+      if (jump->HasParallelMove()) {
+        count += CountSpills(jump->parallel_move());
+      }
+    }
+  }
+  return count;
+}
+
+ISOLATE_UNIT_TEST_CASE(IRTest_RegisterAllocator_HoistSpillOutOfNestedLoop) {
+  // The values x, y and z are live across the call in the inner loop,
+  // which clobbers all registers, but are not used by either loop. They
+  // are spilled once before the outer loop instead of on every iteration
+  // of the outer loop.
+  const char* kScript =
+      R"(
+      bool done = false;
+      int counter = 0;
+
+      @pragma('vm:never-inline')
+      bool step() {
+        counter++;
+        if (counter % 3 != 0) return true;
+        if (counter > 30) done = true;
+        return false;
+      }
+
+      @pragma('vm:never-inline')
+      int test(int a, int b) {
+        final x = a * b;
+        final y = a + b;
+        final z = a - b;
+        while (!done) {
+          while (step()) {}
+        }
+        return x * y * z;
+      }
+
+      main() => test(3, 4);
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "test"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+
+  intptr_t spills_in_loops = 0;
+  intptr_t spills_outside_loops = 0;
+  intptr_t loop_depth = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    BlockEntryInstr* block = block_it.Current();
+    if (LoopInfo* loop = block->loop_info()) {
+      loop_depth = Utils::Maximum(loop_depth, loop->NestingDepth());
+      spills_in_loops += CountSpills(block);
+    } else {
+      spills_outside_loops += CountSpills(block);
+    }
+  }
+  EXPECT_EQ(2, loop_depth);
+  EXPECT_EQ(0, spills_in_loops);
+  EXPECT(spills_outside_loops >= 3);
+
+  pipeline.CompileGraphAndAttachFunction();
+  const auto& result = Object::Handle(Invoke(root_library, "main"));
+  EXPECT(result.IsInteger());
+  EXPECT_EQ(-84, Integer::Cast(result).AsInt64Value());
+}
+
+#endif  // defined(DART_PRECOMPILER)
+
+}  // namespace dart
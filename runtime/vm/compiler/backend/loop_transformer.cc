@@ -0,0 +1,153 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_transformer.h"
+
+#include "vm/bit_vector.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, trace_optimization);
+
+void LoopTransformer::TransformLoops(const char* verb) {
+  const LoopHierarchy& loop_hierarchy = flow_graph_->GetLoopHierarchy();
+  loop_hierarchy.ComputeInduction();
+
+  GrowableArray<Candidate*> candidates;
+  const auto& headers = loop_hierarchy.headers();
+  for (intptr_t i = 0; i < headers.length(); ++i) {
+    Candidate* candidate = AnalyzeLoop(headers[i]->loop_info());
+    if (candidate != nullptr) {
+      candidates.Add(candidate);
+    }
+  }
+  if (candidates.is_empty()) {
+    return;
+  }
+
+  for (intptr_t i = 0; i < candidates.length(); ++i) {
+    if (FLAG_trace_optimization) {
+      THR_Print("%s loop B%" Pd "\n", verb, candidates[i]->header->block_id());
+    }
+    TransformLoop(candidates[i]);
+  }
+
+  flow_graph_->DiscoverBlocks();
+  GrowableArray<BitVector*> dominance_frontier;
+  flow_graph_->ComputeDominators(&dominance_frontier);
+}
+
+bool LoopTransformer::FindBlocks(LoopInfo* loop, Candidate* candidate) const {
+  if (loop->inner() != nullptr || loop->back_edges().length() != 1) {
+    return false;
+  }
+  JoinEntryInstr* header = loop->header()->AsJoinEntry();
+  TargetEntryInstr* body = loop->back_edges()[0]->AsTargetEntry();
+  if (header == nullptr || body == nullptr ||
+      header->PredecessorCount() != 2 || body->PredecessorAt(0) != header) {
+    return false;
+  }
+  BlockEntryInstr* preheader = header->PredecessorAt(0) == body
+                                   ? header->PredecessorAt(1)
+                                   : header->PredecessorAt(0);
+  if (!preheader->last_instruction()->IsGoto() ||
+      preheader->try_index() != header->try_index() ||
+      body->try_index() != header->try_index()) {
+    return false;
+  }
+  candidate->loop = loop;
+  candidate->preheader = preheader;
+  candidate->header = header;
+  candidate->body = body;
+  candidate->preheader_index = header->IndexOfPredecessor(preheader);
+  return true;
+}
+
+bool LoopTransformer::FindIndex(Candidate* candidate) const {
+  BranchInstr* branch = candidate->header->last_instruction()->AsBranch();
+  if (branch == nullptr || branch->true_successor() != candidate->body) {
+    return false;
+  }
+  RelationalOpInstr* compare = branch->comparison()->AsRelationalOp();
+  if (compare == nullptr || compare->kind() != Token::kLT ||
+      !IsInvariant(candidate, compare->right()->definition())) {
+    return false;
+  }
+  PhiInstr* index = compare->left()->definition()->AsPhi();
+  int64_t stride = 0;
+  if (index == nullptr || index->GetBlock() != candidate->header ||
+      !InductionVar::IsLinear(candidate->loop->LookupInduction(index),
+                              &stride) ||
+      stride != 1) {
+    return false;
+  }
+  candidate->index = index;
+  candidate->limit = compare->right()->definition();
+  candidate->compare = compare;
+  return true;
+}
+
+bool LoopTransformer::IsInvariant(Candidate* candidate, Definition* def) const {
+  return !candidate->loop->Contains(def->GetBlock());
+}
+
+Instruction* LoopTransformer::AppendGuard(
+    Candidate* candidate,
+    Instruction* cursor,
+    ComparisonInstr* compare,
+    GrowableArray<TargetEntryInstr*>* failures) {
+  BlockEntryInstr* block = cursor->GetBlock();
+  BranchInstr* branch = new (zone()) BranchInstr(compare, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor, branch, nullptr, FlowGraph::kEffect);
+  block->set_last_instruction(branch);
+  TargetEntryInstr* success = NewTarget(candidate->preheader);
+  TargetEntryInstr* failure = NewTarget(candidate->preheader);
+  *branch->true_successor_address() = success;
+  *branch->false_successor_address() = failure;
+  failures->Add(failure);
+  return success;
+}
+
+ConstantInstr* LoopTransformer::Int64Constant(int64_t value) {
+  return flow_graph_->GetConstant(
+      Integer::ZoneHandle(zone(), Integer::New(value, Heap::kOld)),
+      kUnboxedInt64);
+}
+
+TargetEntryInstr* LoopTransformer::NewTarget(BlockEntryInstr* inherit) {
+  return new (zone()) TargetEntryInstr(flow_graph_->allocate_block_id(),
+                                       inherit->try_index(), DeoptId::kNone);
+}
+
+JoinEntryInstr* LoopTransformer::NewJoin(BlockEntryInstr* inherit) {
+  return new (zone()) JoinEntryInstr(flow_graph_->allocate_block_id(),
+                                     inherit->try_index(), DeoptId::kNone);
+}
+
+Instruction* LoopTransformer::LinkGoto(Instruction* cursor,
+                                       JoinEntryInstr* target) {
+  GotoInstr* jump = new (zone()) GotoInstr(target, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor, jump, nullptr, FlowGraph::kEffect);
+  cursor->GetBlock()->set_last_instruction(jump);
+  return jump;
+}
+
+PhiInstr* LoopTransformer::AddPhi(JoinEntryInstr* join,
+                                  intptr_t input_count,
+                                  Representation representation) {
+  PhiInstr* phi = new (zone()) PhiInstr(join, input_count);
+  flow_graph_->AllocateSSAIndexes(phi);
+  phi->set_representation(representation);
+  phi->mark_alive();
+  join->InsertPhi(phi);
+  return phi;
+}
+
+void LoopTransformer::SetPhiInput(PhiInstr* phi, intptr_t i, Definition* def) {
+  Value* input = new (zone()) Value(def);
+  phi->SetInputAt(i, input);
+  def->AddInputUse(input);
+}
+
+}  // namespace dart
@@ -0,0 +1,114 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_LOOP_TRANSFORMER_H_
+#define RUNTIME_VM_COMPILER_BACKEND_LOOP_TRANSFORMER_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/allocation.h"
+#include "vm/compiler/backend/flow_graph.h"
+#include "vm/compiler/backend/il.h"
+#include "vm/compiler/backend/loops.h"
+
+namespace dart {
+
+// Base class of passes which insert a specialized copy of a simple counted
+// loop in front of it:
+//
+//     if (guards) {
+//       for (; i < n'; i += k) { <specialized body> }
+//     }
+//     for (; i < n; i++) { <original body> }
+//
+// A simple counted loop consists of a header and a single body block, which
+// are entered from a preheader ending in a goto, and its header tests
+//
+//     for (i = init; i < n; i++)
+//
+// for a loop invariant n. Subclasses decide which of these loops qualify,
+// and build the guards and the copy with the helpers below.
+class LoopTransformer : public ValueObject {
+ public:
+  explicit LoopTransformer(FlowGraph* flow_graph) : flow_graph_(flow_graph) {}
+  virtual ~LoopTransformer() {}
+
+ protected:
+  // A loop which passed analysis. Subclasses extend this with what their
+  // transformation needs to know about the loop.
+  struct Candidate : public ZoneAllocated {
+    Candidate()
+        : loop(nullptr),
+          preheader(nullptr),
+          header(nullptr),
+          body(nullptr),
+          preheader_index(-1),
+          index(nullptr),
+          limit(nullptr),
+          compare(nullptr) {}
+
+    LoopInfo* loop;
+    BlockEntryInstr* preheader;
+    JoinEntryInstr* header;
+    TargetEntryInstr* body;
+    intptr_t preheader_index;
+    PhiInstr* index;
+    Definition* limit;
+    RelationalOpInstr* compare;
+  };
+
+  // Analyzes all loops before transforming any of them, since the
+  // transformation invalidates the loop information, and recomputes the
+  // dominators if any loop was transformed. The given verb is used for
+  // tracing.
+  void TransformLoops(const char* verb);
+
+  // Returns a candidate for the given loop if it qualifies, or nullptr.
+  virtual Candidate* AnalyzeLoop(LoopInfo* loop) = 0;
+
+  // Inserts the specialized copy of the candidate.
+  virtual void TransformLoop(Candidate* candidate) = 0;
+
+  // Records the blocks of the loop if it consists of a header and a single
+  // body block, entered from a preheader ending in a goto, all within the
+  // same try block.
+  bool FindBlocks(LoopInfo* loop, Candidate* candidate) const;
+
+  // Records the index and limit of the loop if its header ends in a branch
+  // testing i < n, where i is a header phi with stride 1 and n is loop
+  // invariant.
+  bool FindIndex(Candidate* candidate) const;
+
+  bool IsInvariant(Candidate* candidate, Definition* def) const;
+
+  // Appends a branch on the given comparison after the cursor, and returns
+  // the block entered if it is true. The block entered otherwise is added
+  // to failures.
+  Instruction* AppendGuard(Candidate* candidate,
+                           Instruction* cursor,
+                           ComparisonInstr* compare,
+                           GrowableArray<TargetEntryInstr*>* failures);
+
+  ConstantInstr* Int64Constant(int64_t value);
+  TargetEntryInstr* NewTarget(BlockEntryInstr* inherit);
+  JoinEntryInstr* NewJoin(BlockEntryInstr* inherit);
+  Instruction* LinkGoto(Instruction* cursor, JoinEntryInstr* target);
+  PhiInstr* AddPhi(JoinEntryInstr* join,
+                   intptr_t input_count,
+                   Representation representation);
+  void SetPhiInput(PhiInstr* phi, intptr_t i, Definition* def);
+
+  Zone* zone() const { return flow_graph_->zone(); }
+
+  FlowGraph* flow_graph_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LoopTransformer);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_LOOP_TRANSFORMER_H_
@@ -0,0 +1,426 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_vectorizer.h"
+
+#include "vm/compiler/backend/flow_graph_compiler.h"
+#include "vm/compiler/runtime_api.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            vectorize_loops,
+            true,
+            "Vectorize simple counted loops over typed data.");
+
+// Number of Float64List elements processed per vector loop iteration.
+static constexpr intptr_t kLanes = 2;
+
+LoopVectorizer::LoopVectorizer(FlowGraph* flow_graph)
+    : LoopTransformer(flow_graph), vector_defs_() {}
+
+void LoopVectorizer::Optimize(FlowGraph* flow_graph) {
+  if (!FLAG_vectorize_loops || flow_graph->IsCompiledForOsr() ||
+      !FlowGraphCompiler::SupportsUnboxedSimd128()) {
+    return;
+  }
+#if defined(TARGET_ARCH_IS_64_BIT)
+  // The vector loop indexes arrays with the unboxed loop index, which is
+  // only a single register on 64-bit targets.
+  LoopVectorizer vectorizer(flow_graph);
+  vectorizer.TransformLoops("Vectorizing");
+#endif
+}
+
+LoopTransformer::Candidate* LoopVectorizer::AnalyzeLoop(LoopInfo* loop) {
+  Candidate* candidate = new (zone()) Candidate();
+  return Analyze(loop, candidate) ? candidate : nullptr;
+}
+
+void LoopVectorizer::TransformLoop(LoopTransformer::Candidate* candidate) {
+  Vectorize(static_cast<Candidate*>(candidate));
+}
+
+bool LoopVectorizer::Analyze(LoopInfo* loop, Candidate* candidate) {
+  if (!FindBlocks(loop, candidate) || !FindIndex(candidate)) {
+    return false;
+  }
+
+  // The loop index must be the only phi: i = init, init + 1, ...
+  JoinEntryInstr* header = candidate->header;
+  PhiInstr* index = candidate->index;
+  if (header->phis()->length() != 1 || !index->is_alive() ||
+      index->representation() != kUnboxedInt64 ||
+      candidate->compare->operation_cid() != kMintCid) {
+    return false;
+  }
+  Value* increment = index->InputAt(1 - candidate->preheader_index);
+  if (increment->definition()->GetBlock() != candidate->body ||
+      !increment->definition()->HasOnlyUse(increment)) {
+    return false;
+  }
+  int64_t initial_value = 0;
+  candidate->increment = increment->definition();
+  candidate->initial =
+      index->InputAt(candidate->preheader_index)->definition();
+  candidate->initial_is_non_negative =
+      InductionVar::IsConstant(loop->LookupInduction(index)->initial(),
+                               &initial_value) &&
+      initial_value >= 0;
+
+  // The header only tests i < n.
+  Instruction* current = header->next();
+  if (CheckStackOverflowInstr* check = current->AsCheckStackOverflow()) {
+    candidate->stack_check = check;
+    current = current->next();
+  }
+  if (current != header->last_instruction()) {
+    return false;
+  }
+
+  if (!AnalyzeBody(candidate)) {
+    return false;
+  }
+
+  // The vector loop reuses the environment of the stack overflow check.
+  if (CheckStackOverflowInstr* check = candidate->stack_check) {
+    for (Environment::DeepIterator it(check->env()); !it.Done();
+         it.Advance()) {
+      Definition* def = it.CurrentValue()->definition();
+      if (def != index && !IsInvariant(candidate, def)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool LoopVectorizer::AnalyzeBody(Candidate* candidate) {
+  vector_defs_.Clear();
+  bool has_store = false;
+  for (ForwardInstructionIterator it(candidate->body); !it.Done();
+       it.Advance()) {
+    Instruction* current = it.Current();
+    if (current == candidate->increment || current->IsGoto()) {
+      continue;
+    }
+    if (CheckStackOverflowInstr* check = current->AsCheckStackOverflow()) {
+      if (candidate->stack_check != nullptr) {
+        return false;
+      }
+      candidate->stack_check = check;
+    } else if (CheckBoundBase* check = current->AsCheckBoundBase()) {
+      // Made redundant by the guard of the vector loop.
+      if (!IsIndex(candidate, check->index())) {
+        return false;
+      }
+    } else if (current->IsBoxInt64() || current->IsUnboxInt64() ||
+               current->IsIntConverter()) {
+      if (!IsIndex(candidate, current->InputAt(0))) {
+        return false;
+      }
+    } else if (LoadUntaggedInstr* load = current->AsLoadUntagged()) {
+      if (load->offset() !=
+              compiler::target::TypedDataBase::data_field_offset() ||
+          !IsInvariant(candidate, load->object()->definition())) {
+        return false;
+      }
+      vector_defs_.Insert({load, load});
+    } else if (LoadIndexedInstr* load = current->AsLoadIndexed()) {
+      if (load->class_id() != kTypedDataFloat64ArrayCid ||
+          load->index_scale() != kDoubleSize ||
+          !IsIndex(candidate, load->index()) ||
+          !AddArray(candidate, load->array())) {
+        return false;
+      }
+      vector_defs_.Insert({load, load});
+    } else if (BinaryDoubleOpInstr* op = current->AsBinaryDoubleOp()) {
+      switch (op->op_kind()) {
+        case Token::kADD:
+        case Token::kSUB:
+        case Token::kMUL:
+        case Token::kDIV:
+          break;
+        default:
+          return false;
+      }
+      if (!IsVectorizable(candidate, op->left()) ||
+          !IsVectorizable(candidate, op->right())) {
+        return false;
+      }
+      vector_defs_.Insert({op, op});
+    } else if (StoreIndexedInstr* store = current->AsStoreIndexed()) {
+      if (store->class_id() != kTypedDataFloat64ArrayCid ||
+          store->index_scale() != kDoubleSize ||
+          !IsIndex(candidate, store->index()) ||
+          !AddArray(candidate, store->array()) ||
+          !IsVectorizable(candidate, store->value())) {
+        return false;
+      }
+      has_store = true;
+    } else {
+      return false;
+    }
+  }
+  // Loops without stores would be reductions, which cannot be reassociated
+  // without changing floating-point results.
+  return has_store;
+}
+
+// Returns true if the value is the loop index, possibly behind bounds checks
+// and representation changes.
+bool LoopVectorizer::IsIndex(Candidate* candidate, Value* value) const {
+  Definition* def = value->definition();
+  while (def != candidate->index) {
+    if (CheckBoundBase* check = def->AsCheckBoundBase()) {
+      def = check->index()->definition();
+    } else if (def->IsBoxInt64() || def->IsUnboxInt64() ||
+               def->IsIntConverter()) {
+      def = def->InputAt(0)->definition();
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if the value has a Float64x2 counterpart in the vector loop:
+// either it is computed element-wise, or it is a loop invariant double
+// which can be splatted.
+bool LoopVectorizer::IsVectorizable(Candidate* candidate, Value* value) const {
+  Definition* def = value->definition();
+  if (vector_defs_.LookupValue(def) != nullptr) {
+    return !def->IsLoadUntagged();
+  }
+  return IsInvariant(candidate, def) &&
+         def->representation() == kUnboxedDouble;
+}
+
+// Records the typed data object accessed through the given array value,
+// which must be loop invariant.
+bool LoopVectorizer::AddArray(Candidate* candidate, Value* value) {
+  Definition* array = value->definition();
+  if (LoadUntaggedInstr* load = array->AsLoadUntagged()) {
+    if (load->offset() !=
+        compiler::target::TypedDataBase::data_field_offset()) {
+      return false;
+    }
+    array = load->object()->definition();
+  } else if (array->representation() != kTagged) {
+    return false;
+  }
+  if (!IsInvariant(candidate, array)) {
+    return false;
+  }
+  for (intptr_t i = 0; i < candidate->arrays.length(); ++i) {
+    if (candidate->arrays[i] == array) {
+      return true;
+    }
+  }
+  candidate->arrays.Add(array);
+  return true;
+}
+
+// Inserts the vector loop between the preheader and the header of the
+// candidate:
+//
+//   preheader:     guards, each branching to scalar_entry on failure
+//   vector_header: phi(init, i_v + 2), [stack check], if (i_v + 2 <= n)
+//   vector_body:   <body on Float64x2 values>, goto vector_header
+//   vector_exit:   goto scalar_entry
+//   scalar_entry:  phi(init, ..., init, i_v), goto header
+//
+// Join predecessors are ordered by block id, so blocks are allocated in an
+// order which matches the phi inputs created below.
+void LoopVectorizer::Vectorize(Candidate* candidate) {
+  const InstructionSource source =
+      candidate->header->last_instruction()->source();
+  GotoInstr* preheader_goto =
+      candidate->preheader->last_instruction()->AsGoto();
+  Instruction* cursor = preheader_goto->previous();
+  preheader_goto->UnuseAllInputs();
+
+  // All arrays must be internal Float64Lists, which never overlap.
+  GrowableArray<TargetEntryInstr*> failures;
+  for (intptr_t i = 0; i < candidate->arrays.length(); ++i) {
+    LoadClassIdInstr* cid =
+        new (zone()) LoadClassIdInstr(new (zone()) Value(candidate->arrays[i]));
+    cursor = flow_graph_->AppendTo(cursor, cid, nullptr, FlowGraph::kValue);
+    ConstantInstr* expected = flow_graph_->GetConstant(
+        Smi::ZoneHandle(zone(), Smi::New(kTypedDataFloat64ArrayCid)));
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) StrictCompareInstr(source, Token::kEQ_STRICT,
+                                        new (zone()) Value(cid),
+                                        new (zone()) Value(expected),
+                                        /*needs_number_check=*/false,
+                                        DeoptId::kNone),
+        &failures);
+  }
+
+  // All iterations of the loop must be in bounds.
+  if (!candidate->initial_is_non_negative) {
+    ConstantInstr* zero = Int64Constant(0);
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) RelationalOpInstr(
+            source, Token::kLTE, new (zone()) Value(zero),
+            new (zone()) Value(candidate->initial), kMintCid, DeoptId::kNone,
+            Instruction::kNotSpeculative),
+        &failures);
+  }
+  for (intptr_t i = 0; i < candidate->arrays.length(); ++i) {
+    Definition* length = new (zone())
+        LoadFieldInstr(new (zone()) Value(candidate->arrays[i]),
+                       Slot::TypedDataBase_length(), source);
+    cursor = flow_graph_->AppendTo(cursor, length, nullptr, FlowGraph::kValue);
+    if (length->representation() != kUnboxedInt64) {
+      length = UnboxInstr::Create(kUnboxedInt64, new (zone()) Value(length),
+                                  DeoptId::kNone,
+                                  Instruction::kNotSpeculative);
+      cursor =
+          flow_graph_->AppendTo(cursor, length, nullptr, FlowGraph::kValue);
+    }
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) RelationalOpInstr(
+            source, Token::kLTE, new (zone()) Value(candidate->limit),
+            new (zone()) Value(length), kMintCid, DeoptId::kNone,
+            Instruction::kNotSpeculative),
+        &failures);
+  }
+
+  JoinEntryInstr* vector_header = NewJoin(candidate->header);
+  TargetEntryInstr* vector_body = NewTarget(candidate->header);
+  TargetEntryInstr* vector_exit = NewTarget(candidate->header);
+  JoinEntryInstr* scalar_entry = NewJoin(candidate->header);
+  // Splats of loop invariant values go to the end of the last guard.
+  Instruction* invariant_cursor = LinkGoto(cursor, vector_header);
+
+  // Vector loop header.
+  PhiInstr* vector_index = AddPhi(vector_header, 2, kUnboxedInt64);
+  cursor = vector_header;
+  if (CheckStackOverflowInstr* check = candidate->stack_check) {
+    CheckStackOverflowInstr* copy = new (zone())
+        CheckStackOverflowInstr(check->source(), check->stack_depth(),
+                                check->loop_depth(), check->deopt_id(),
+                                check->kind());
+    cursor = flow_graph_->AppendTo(cursor, copy, check->env(),
+                                   FlowGraph::kEffect);
+    copy->ReplaceInEnvironment(candidate->index, vector_index);
+  }
+  ConstantInstr* lanes = Int64Constant(kLanes);
+  BinaryInt64OpInstr* next = new (zone()) BinaryInt64OpInstr(
+      Token::kADD, new (zone()) Value(vector_index), new (zone()) Value(lanes),
+      DeoptId::kNone, Instruction::kNotSpeculative);
+  cursor = flow_graph_->AppendTo(cursor, next, nullptr, FlowGraph::kValue);
+  BranchInstr* branch = new (zone()) BranchInstr(
+      new (zone()) RelationalOpInstr(
+          source, Token::kLTE, new (zone()) Value(next),
+          new (zone()) Value(candidate->limit), kMintCid, DeoptId::kNone,
+          Instruction::kNotSpeculative),
+      DeoptId::kNone);
+  flow_graph_->AppendTo(cursor, branch, nullptr, FlowGraph::kEffect);
+  vector_header->set_last_instruction(branch);
+  *branch->true_successor_address() = vector_body;
+  *branch->false_successor_address() = vector_exit;
+  SetPhiInput(vector_index, 0, candidate->initial);
+  SetPhiInput(vector_index, 1, next);
+
+  // Vector loop body.
+  cursor = EmitVectorBody(candidate, vector_body, invariant_cursor,
+                          vector_index);
+  LinkGoto(cursor, vector_header);
+
+  // The scalar loop finishes the remaining iterations, or all of them if
+  // any guard failed.
+  LinkGoto(vector_exit, scalar_entry);
+  PhiInstr* scalar_index =
+      AddPhi(scalar_entry, failures.length() + 1, kUnboxedInt64);
+  for (intptr_t i = 0; i < failures.length(); ++i) {
+    LinkGoto(failures[i], scalar_entry);
+    SetPhiInput(scalar_index, i, candidate->initial);
+  }
+  SetPhiInput(scalar_index, failures.length(), vector_index);
+  LinkGoto(scalar_entry, candidate->header);
+
+  // The header is now entered from scalar_entry instead of the preheader.
+  // Since scalar_entry has the highest block id, it comes last.
+  ASSERT(candidate->body->block_id() < scalar_entry->block_id());
+  PhiInstr* index = candidate->index;
+  index->InputAt(0)->RemoveFromUseList();
+  index->InputAt(1)->RemoveFromUseList();
+  SetPhiInput(index, 0, candidate->increment);
+  SetPhiInput(index, 1, scalar_index);
+}
+
+Instruction* LoopVectorizer::EmitVectorBody(Candidate* candidate,
+                                            Instruction* cursor,
+                                            Instruction* invariant_cursor,
+                                            Definition* vector_index) {
+  vector_defs_.Clear();
+  for (ForwardInstructionIterator it(candidate->body); !it.Done();
+       it.Advance()) {
+    Instruction* current = it.Current();
+    if (LoadUntaggedInstr* load = current->AsLoadUntagged()) {
+      LoadUntaggedInstr* copy = new (zone()) LoadUntaggedInstr(
+          new (zone()) Value(load->object()->definition()), load->offset());
+      cursor = flow_graph_->AppendTo(cursor, copy, nullptr, FlowGraph::kValue);
+      vector_defs_.Insert({load, copy});
+    } else if (LoadIndexedInstr* load = current->AsLoadIndexed()) {
+      LoadIndexedInstr* vector_load = new (zone()) LoadIndexedInstr(
+          new (zone()) Value(VectorArray(load->array())),
+          new (zone()) Value(vector_index), /*index_unboxed=*/true,
+          load->index_scale(), kTypedDataFloat64x2ArrayCid,
+          load->aligned() ? kAlignedAccess : kUnalignedAccess, DeoptId::kNone,
+          load->source());
+      cursor = flow_graph_->AppendTo(cursor, vector_load, nullptr,
+                                     FlowGraph::kValue);
+      vector_defs_.Insert({load, vector_load});
+    } else if (BinaryDoubleOpInstr* op = current->AsBinaryDoubleOp()) {
+      SimdOpInstr* vector_op = SimdOpInstr::Create(
+          SimdOpInstr::KindForOperator(kFloat64x2Cid, op->op_kind()),
+          new (zone()) Value(VectorValue(op->left(), invariant_cursor)),
+          new (zone()) Value(VectorValue(op->right(), invariant_cursor)),
+          DeoptId::kNone);
+      cursor =
+          flow_graph_->AppendTo(cursor, vector_op, nullptr, FlowGraph::kValue);
+      vector_defs_.Insert({op, vector_op});
+    } else if (StoreIndexedInstr* store = current->AsStoreIndexed()) {
+      StoreIndexedInstr* vector_store = new (zone()) StoreIndexedInstr(
+          new (zone()) Value(VectorArray(store->array())),
+          new (zone()) Value(vector_index),
+          new (zone()) Value(VectorValue(store->value(), invariant_cursor)),
+          kNoStoreBarrier, /*index_unboxed=*/true, store->index_scale(),
+          kTypedDataFloat64x2ArrayCid,
+          store->aligned() ? kAlignedAccess : kUnalignedAccess,
+          DeoptId::kNone, store->source(), Instruction::kNotSpeculative);
+      cursor = flow_graph_->AppendTo(cursor, vector_store, nullptr,
+                                     FlowGraph::kEffect);
+    }
+    // Everything else only deals with the scalar loop index and bounds.
+  }
+  return cursor;
+}
+
+Definition* LoopVectorizer::VectorArray(Value* array) {
+  Definition* copy = vector_defs_.LookupValue(array->definition());
+  return copy != nullptr ? copy : array->definition();
+}
+
+Definition* LoopVectorizer::VectorValue(Value* value,
+                                        Instruction* invariant_cursor) {
+  Definition* def = value->definition();
+  Definition* vector = vector_defs_.LookupValue(def);
+  if (vector == nullptr) {
+    vector = SimdOpInstr::Create(MethodRecognizer::kFloat64x2Splat,
+                                 new (zone()) Value(def), DeoptId::kNone);
+    flow_graph_->InsertBefore(invariant_cursor, vector, nullptr,
+                              FlowGraph::kValue);
+    vector_defs_.Insert({def, vector});
+  }
+  return vector;
+}
+
+}  // namespace dart
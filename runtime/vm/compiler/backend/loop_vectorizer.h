@@ -0,0 +1,90 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
+#define RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/compiler/backend/loop_transformer.h"
+#include "vm/hash_map.h"
+
+namespace dart {
+
+// Vectorizes simple counted loops over Float64List elements.
+//
+// A loop qualifies if it consists of a header and a single body block, its
+// only induction is
+//
+//     for (int i = init; i < n; i++)
+//
+// with loop invariant init and n, and its body only loads and stores
+// elements [i] of loop invariant Float64Lists, combining them with each
+// other and with loop invariant doubles by +, -, * and /. Such a loop
+// is preceded by a copy operating on Float64x2 values, two elements per
+// iteration, which hands the remaining iterations to the original loop:
+//
+//     if (all arrays are internal Float64Lists &&
+//         init >= 0 && n <= array.length for all arrays) {
+//       for (; i + 2 <= n; i += 2) { <body on Float64x2 values> }
+//     }
+//     for (; i < n; i++) { <original body> }
+//
+// The guard makes bounds checks redundant in the vector loop, and since
+// internal typed data never overlap, it also ensures that lanes of one
+// iteration never depend on each other. Floating-point results are
+// unchanged since every lane performs exactly the scalar operations.
+class LoopVectorizer : public LoopTransformer {
+ public:
+  explicit LoopVectorizer(FlowGraph* flow_graph);
+
+  static void Optimize(FlowGraph* flow_graph);
+
+ private:
+  struct Candidate : public LoopTransformer::Candidate {
+    Candidate()
+        : increment(nullptr),
+          initial(nullptr),
+          stack_check(nullptr),
+          initial_is_non_negative(false),
+          arrays() {}
+
+    Definition* increment;
+    Definition* initial;
+    CheckStackOverflowInstr* stack_check;
+    bool initial_is_non_negative;
+    GrowableArray<Definition*> arrays;
+  };
+
+  typedef RawPointerKeyValueTrait<Definition, Definition*> DefinitionKV;
+
+  virtual LoopTransformer::Candidate* AnalyzeLoop(LoopInfo* loop);
+  virtual void TransformLoop(LoopTransformer::Candidate* candidate);
+
+  bool Analyze(LoopInfo* loop, Candidate* candidate);
+  bool AnalyzeBody(Candidate* candidate);
+  bool IsIndex(Candidate* candidate, Value* value) const;
+  bool IsVectorizable(Candidate* candidate, Value* value) const;
+  bool AddArray(Candidate* candidate, Value* value);
+
+  void Vectorize(Candidate* candidate);
+  Instruction* EmitVectorBody(Candidate* candidate,
+                              Instruction* cursor,
+                              Instruction* invariant_cursor,
+                              Definition* vector_index);
+  Definition* VectorArray(Value* array);
+  Definition* VectorValue(Value* value, Instruction* invariant_cursor);
+
+  // Maps definitions of the scalar loop to their counterparts in the vector
+  // loop. During analysis, maps vectorizable definitions to themselves.
+  DirectChainedHashMap<DefinitionKV> vector_defs_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopVectorizer);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
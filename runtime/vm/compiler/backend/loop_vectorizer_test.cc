@@ -0,0 +1,85 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_vectorizer.h"
+
+#include "vm/compiler/backend/flow_graph_compiler.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(DART_PRECOMPILER) && defined(TARGET_ARCH_IS_64_BIT)
+
+ISOLATE_UNIT_TEST_CASE(IRTest_LoopVectorizer_Map) {
+  if (!FlowGraphCompiler::SupportsUnboxedSimd128()) {
+    return;
+  }
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      void scale(Float64List dst, Float64List src, double k) {
+        for (int i = 0; i < dst.length; i++) {
+          dst[i] = src[i] * k;
+        }
+      }
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "scale"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  EXPECT_EQ(1, CountSimdOps(flow_graph, SimdOpInstr::kFloat64x2Mul));
+  EXPECT_EQ(1, CountSimdOps(flow_graph, SimdOpInstr::kFloat64x2Splat));
+
+  pipeline.CompileGraphAndAttachFunction();
+
+  // An odd length leaves an iteration to the scalar loop.
+  const intptr_t kLength = 5;
+  const auto& dst =
+      TypedData::Handle(TypedData::New(kTypedDataFloat64ArrayCid, kLength));
+  const auto& src =
+      TypedData::Handle(TypedData::New(kTypedDataFloat64ArrayCid, kLength));
+  for (intptr_t i = 0; i < kLength; i++) {
+    src.SetFloat64(i * kDoubleSize, i + 0.5);
+  }
+  const auto& arguments = Array::Handle(Array::New(3));
+  arguments.SetAt(0, dst);
+  arguments.SetAt(1, src);
+  arguments.SetAt(2, Double::Handle(Double::New(3.0)));
+  const auto& result =
+      Object::Handle(DartEntry::InvokeFunction(function, arguments));
+  EXPECT(result.IsNull());
+  for (intptr_t i = 0; i < kLength; i++) {
+    EXPECT_EQ((i + 0.5) * 3.0, dst.GetFloat64(i * kDoubleSize));
+  }
+}
+
+ISOLATE_UNIT_TEST_CASE(IRTest_LoopVectorizer_CrossIterationDependency) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      void shift(Float64List list) {
+        for (int i = 0; i < list.length - 1; i++) {
+          list[i] = list[i + 1] * 2.0;
+        }
+      }
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "shift"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  EXPECT_EQ(0, CountSimdOps(flow_graph, SimdOpInstr::kFloat64x2Mul));
+}
+
+#endif  // defined(DART_PRECOMPILER) && defined(TARGET_ARCH_IS_64_BIT)
+
+}  // namespace dart
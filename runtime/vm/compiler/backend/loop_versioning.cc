@@ -0,0 +1,642 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_versioning.h"
+
+#include "vm/compiler/backend/range_analysis.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            version_loops,
+            true,
+            "Version loops to hoist bounds and null checks out of them.");
+DEFINE_FLAG(bool, unroll_loops, true, "Unroll small counted loops.");
+DEFINE_FLAG(int,
+            loop_unroll_factor,
+            4,
+            "Number of iterations performed by an unrolled loop iteration.");
+DEFINE_FLAG(int,
+            max_unrolled_loop_size,
+            8,
+            "Maximum number of instructions in a loop to unroll.");
+
+// Maximum number of instructions in a loop to version.
+static constexpr intptr_t kMaxVersionedLoopSize = 64;
+
+// Maximum distance between a checked index and the loop index. Keeps the
+// arithmetic of the guards far from overflowing.
+static constexpr int64_t kMaxIndexOffset = 1024;
+
+LoopVersioning::LoopVersioning(FlowGraph* flow_graph, Mode mode)
+    : LoopTransformer(flow_graph),
+      mode_(mode),
+      unroll_factor_(mode == kUnroll ? FLAG_loop_unroll_factor : 1),
+      copies_() {}
+
+void LoopVersioning::VersionLoops(FlowGraph* flow_graph) {
+  if (!FLAG_version_loops || flow_graph->IsCompiledForOsr()) {
+    return;
+  }
+  LoopVersioning versioning(flow_graph, kVersion);
+  versioning.TransformLoops("Versioning");
+}
+
+void LoopVersioning::UnrollLoops(FlowGraph* flow_graph) {
+  if (!FLAG_unroll_loops || FLAG_loop_unroll_factor < 2 ||
+      flow_graph->IsCompiledForOsr()) {
+    return;
+  }
+  LoopVersioning unrolling(flow_graph, kUnroll);
+  unrolling.TransformLoops("Unrolling");
+}
+
+LoopTransformer::Candidate* LoopVersioning::AnalyzeLoop(LoopInfo* loop) {
+  Candidate* candidate = new (zone()) Candidate();
+  return Analyze(loop, candidate) ? candidate : nullptr;
+}
+
+void LoopVersioning::TransformLoop(LoopTransformer::Candidate* candidate) {
+  Transform(static_cast<Candidate*>(candidate));
+}
+
+bool LoopVersioning::Analyze(LoopInfo* loop, Candidate* candidate) {
+  // Outside of try blocks, with the loop index among the header phis.
+  if (!FindBlocks(loop, candidate) ||
+      candidate->header->try_index() != kInvalidTryIndex ||
+      !FindIndex(candidate)) {
+    return false;
+  }
+  JoinEntryInstr* header = candidate->header;
+  switch (candidate->compare->operation_cid()) {
+    case kSmiCid:
+      // The unrolled loop computes n - (k - 1), which is simpler to guard
+      // against overflow on unboxed values.
+      if (mode_ == kUnroll) {
+        return false;
+      }
+      break;
+    case kMintCid:
+      break;
+    default:
+      return false;
+  }
+
+  // Loops entered from the exit of another copy only run its remaining
+  // iterations.
+  Definition* initial =
+      candidate->index->InputAt(candidate->preheader_index)->definition();
+  if (initial->IsPhi() && initial->GetBlock() == candidate->preheader) {
+    return false;
+  }
+
+  for (PhiIterator it(header); !it.Done(); it.Advance()) {
+    if (!it.Current()->is_alive()) {
+      return false;
+    }
+  }
+  if (!AnalyzeBlock(candidate, header) ||
+      !AnalyzeBlock(candidate, candidate->body)) {
+    return false;
+  }
+  if (mode_ == kUnroll) {
+    return !candidate->has_checks &&
+           candidate->size <= FLAG_max_unrolled_loop_size;
+  }
+  return candidate->size <= kMaxVersionedLoopSize && AnalyzeChecks(candidate);
+}
+
+bool LoopVersioning::AnalyzeBlock(Candidate* candidate,
+                                  BlockEntryInstr* block) {
+  for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (current == block->last_instruction()) {
+      break;
+    }
+    if (!CanCopy(current)) {
+      return false;
+    }
+    if (current->IsCheckStackOverflow()) {
+      continue;
+    }
+    // The original header runs once more when the copy exits.
+    if (block == candidate->header && current->IsStoreIndexed()) {
+      return false;
+    }
+    if (current->IsCheckBoundBase() || current->IsCheckNull()) {
+      candidate->has_checks = true;
+    }
+    candidate->size++;
+  }
+  return true;
+}
+
+// Collects the checks of the body which a guard in front of the copy
+// makes redundant in all of its iterations. Checks in the header cannot be
+// removed, since the header also runs for i == n.
+bool LoopVersioning::AnalyzeChecks(Candidate* candidate) {
+  for (ForwardInstructionIterator it(candidate->body); !it.Done();
+       it.Advance()) {
+    Instruction* current = it.Current();
+    int64_t offset = 0;
+    if (CheckBoundBase* check = current->AsCheckBoundBase()) {
+      if (!CanRemoveBoundsCheck(candidate, check, &offset)) {
+        continue;
+      }
+      if (candidate->lengths.is_empty() || offset < candidate->min_offset) {
+        candidate->min_offset = offset;
+      }
+      Definition* length = check->length()->definition();
+      intptr_t i = 0;
+      while (i < candidate->lengths.length() &&
+             candidate->lengths[i] != length) {
+        i++;
+      }
+      if (i == candidate->lengths.length()) {
+        candidate->lengths.Add(length);
+        candidate->max_offsets.Add(offset);
+      } else if (offset > candidate->max_offsets[i]) {
+        candidate->max_offsets[i] = offset;
+      }
+      candidate->removed_checks.Add(check);
+    } else if (CheckNullInstr* check = current->AsCheckNull()) {
+      Definition* value = check->value()->definition();
+      if (!IsInvariant(candidate, value)) {
+        continue;
+      }
+      if (!candidate->non_null_values.Contains(value)) {
+        candidate->non_null_values.Add(value);
+      }
+      candidate->removed_checks.Add(check);
+    }
+  }
+  return !candidate->removed_checks.is_empty();
+}
+
+// Returns true if the check tests an index i + c against a loop invariant
+// length, where i is the loop index and c is a small constant.
+bool LoopVersioning::CanRemoveBoundsCheck(Candidate* candidate,
+                                          CheckBoundBase* check,
+                                          int64_t* offset) const {
+  Definition* length = check->length()->definition();
+  if (!IsInvariant(candidate, length) ||
+      (length->representation() != kTagged &&
+       length->representation() != kUnboxedInt64)) {
+    return false;
+  }
+  // The copy uses the index in place of the check.
+  Definition* index = check->index()->definition();
+  if (check->representation() != index->representation()) {
+    return false;
+  }
+  // Conversions preserve indices within [0, length).
+  while (index->IsBoxInteger() || index->IsUnboxInteger() ||
+         index->IsIntConverter()) {
+    index = index->InputAt(0)->definition();
+  }
+  InductionVar* induc = candidate->loop->LookupInduction(index);
+  return induc != nullptr &&
+         candidate->loop->LookupInduction(candidate->index)
+             ->CanComputeDifferenceWith(induc, offset) &&
+         -kMaxIndexOffset <= *offset && *offset <= kMaxIndexOffset;
+}
+
+bool LoopVersioning::CanCopy(Instruction* instr) const {
+  if (LoadFieldInstr* load = instr->AsLoadField()) {
+    return !load->calls_initializer();
+  }
+  return instr->IsBinaryIntegerOp() || instr->IsBinaryDoubleOp() ||
+         instr->IsBox() || instr->IsUnbox() || instr->IsIntConverter() ||
+         instr->IsLoadUntagged() || instr->IsLoadClassId() ||
+         instr->IsLoadIndexed() || instr->IsStoreIndexed() ||
+         instr->IsCheckArrayBound() || instr->IsGenericCheckBound() ||
+         instr->IsCheckNull() || instr->IsCheckSmi() ||
+         instr->IsCheckStackOverflow();
+}
+
+bool LoopVersioning::IsRemovedCheck(Candidate* candidate,
+                                    Instruction* instr) const {
+  return candidate->removed_checks.Contains(instr);
+}
+
+// Inserts the copy between the preheader and the header of the candidate:
+//
+//   preheader:   guards, each branching to exit_join on failure
+//   copy_header: phis(init, ...), copy of header, if (i' < n')
+//   copy_body:   k copies of header and body, goto copy_header
+//   copy_exit:   goto exit_join
+//   exit_join:   phis(init, ..., init, phis of copy_header), goto header
+//
+// Join predecessors are ordered by block id, so blocks are allocated in an
+// order which matches the phi inputs created below.
+void LoopVersioning::Transform(Candidate* candidate) {
+  JoinEntryInstr* header = candidate->header;
+  const intptr_t back_edge_index = 1 - candidate->preheader_index;
+  GotoInstr* preheader_goto =
+      candidate->preheader->last_instruction()->AsGoto();
+  Instruction* cursor = preheader_goto->previous();
+  preheader_goto->UnuseAllInputs();
+
+  GrowableArray<TargetEntryInstr*> failures;
+  Definition* limit = candidate->limit;
+  if (mode_ == kVersion) {
+    cursor = AppendVersioningGuards(candidate, cursor, &failures);
+  } else {
+    cursor = AppendUnrollingGuards(candidate, cursor, &failures, &limit);
+  }
+
+  JoinEntryInstr* copy_header = NewJoin(header);
+  TargetEntryInstr* copy_body = NewTarget(header);
+  TargetEntryInstr* copy_exit = NewTarget(header);
+  JoinEntryInstr* exit_join =
+      failures.is_empty() ? nullptr : NewJoin(header);
+  LinkGoto(cursor, copy_header);
+
+  // Copy of the header, with the test of the loop index.
+  copies_.Clear();
+  GrowableArray<PhiInstr*> copy_phis;
+  for (PhiIterator it(header); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    PhiInstr* copy = AddPhi(copy_header, 2, phi->representation());
+    if (!Range::IsUnknown(phi->range())) {
+      copy->set_range(*phi->range());
+    }
+    copies_.Update({phi, copy});
+    copy_phis.Add(copy);
+  }
+  cursor = EmitCopies(candidate, header, copy_header,
+                      /*is_first_iteration=*/true);
+  BranchInstr* branch = header->last_instruction()->AsBranch();
+  BranchInstr* copy_branch = new (zone()) BranchInstr(
+      candidate->compare->CopyWithNewOperands(
+          CopyValue(candidate->compare->left()), new (zone()) Value(limit)),
+      branch->deopt_id_for_copy());
+  flow_graph_->AppendTo(cursor, copy_branch, nullptr, FlowGraph::kEffect);
+  CopyEnvironment(branch, copy_branch);
+  copy_header->set_last_instruction(copy_branch);
+  *copy_branch->true_successor_address() = copy_body;
+  *copy_branch->false_successor_address() = copy_exit;
+
+  // Copies of the body. Since i + k - 1 < n, only the first iteration
+  // needs to test the loop index.
+  cursor = copy_body;
+  GrowableArray<Definition*> next_values;
+  for (intptr_t k = 0; k < unroll_factor_; ++k) {
+    if (k > 0) {
+      next_values.Clear();
+      for (PhiIterator it(header); !it.Done(); it.Advance()) {
+        next_values.Add(LookupCopy(
+            it.Current()->InputAt(back_edge_index)->definition()));
+      }
+      intptr_t i = 0;
+      for (PhiIterator it(header); !it.Done(); it.Advance()) {
+        copies_.Update({it.Current(), next_values[i++]});
+      }
+      cursor = EmitCopies(candidate, header, cursor,
+                          /*is_first_iteration=*/false);
+    }
+    cursor = EmitCopies(candidate, candidate->body, cursor,
+                        /*is_first_iteration=*/k == 0);
+  }
+  LinkGoto(cursor, copy_header);
+  intptr_t i = 0;
+  for (PhiIterator it(header); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    SetPhiInput(copy_phis[i], 0,
+                phi->InputAt(candidate->preheader_index)->definition());
+    SetPhiInput(copy_phis[i], 1,
+                LookupCopy(phi->InputAt(back_edge_index)->definition()));
+    i++;
+  }
+
+  // The original loop runs the remaining iterations, or all of them if any
+  // guard failed.
+  GrowableArray<Definition*> entry_values;
+  if (exit_join == nullptr) {
+    LinkGoto(copy_exit, header);
+    for (intptr_t i = 0; i < copy_phis.length(); ++i) {
+      entry_values.Add(copy_phis[i]);
+    }
+  } else {
+    LinkGoto(copy_exit, exit_join);
+    for (intptr_t i = 0; i < failures.length(); ++i) {
+      LinkGoto(failures[i], exit_join);
+    }
+    intptr_t j = 0;
+    for (PhiIterator it(header); !it.Done(); it.Advance()) {
+      PhiInstr* phi = it.Current();
+      PhiInstr* exit_phi =
+          AddPhi(exit_join, failures.length() + 1, phi->representation());
+      Definition* initial =
+          phi->InputAt(candidate->preheader_index)->definition();
+      for (intptr_t i = 0; i < failures.length(); ++i) {
+        SetPhiInput(exit_phi, i, initial);
+      }
+      SetPhiInput(exit_phi, failures.length(), copy_phis[j++]);
+      entry_values.Add(exit_phi);
+    }
+    LinkGoto(exit_join, header);
+  }
+
+  // The header is now entered from the new blocks instead of the
+  // preheader. Since these have the highest block ids, they come last.
+  ASSERT(candidate->body->block_id() < copy_exit->block_id());
+  intptr_t j = 0;
+  for (PhiIterator it(header); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    Definition* back_edge = phi->InputAt(back_edge_index)->definition();
+    phi->InputAt(0)->RemoveFromUseList();
+    phi->InputAt(1)->RemoveFromUseList();
+    SetPhiInput(phi, 0, back_edge);
+    SetPhiInput(phi, 1, entry_values[j++]);
+  }
+}
+
+Instruction* LoopVersioning::AppendVersioningGuards(
+    Candidate* candidate,
+    Instruction* cursor,
+    GrowableArray<TargetEntryInstr*>* failures) {
+  const InstructionSource source = candidate->compare->source();
+
+  // Loop invariant values are not null.
+  for (intptr_t i = 0; i < candidate->non_null_values.length(); ++i) {
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) StrictCompareInstr(
+            source, Token::kNE_STRICT,
+            new (zone()) Value(candidate->non_null_values[i]),
+            new (zone()) Value(flow_graph_->constant_null()),
+            /*needs_number_check=*/false, DeoptId::kNone),
+        failures);
+  }
+
+  // All checked indices are in bounds: init + c >= 0 and n + c <= length.
+  if (!candidate->lengths.is_empty()) {
+    InductionVar* induc = candidate->loop->LookupInduction(candidate->index);
+    int64_t initial_value = 0;
+    if (!InductionVar::IsConstant(induc->initial(), &initial_value) ||
+        initial_value < -candidate->min_offset) {
+      Definition* initial = AppendInt64(
+          &cursor, candidate->index->InputAt(candidate->preheader_index)
+                       ->definition());
+      cursor = AppendGuard(
+          candidate, cursor,
+          new (zone()) RelationalOpInstr(
+              source, Token::kLTE,
+              new (zone()) Value(Int64Constant(-candidate->min_offset)),
+              new (zone()) Value(initial), kMintCid, DeoptId::kNone,
+              Instruction::kNotSpeculative),
+          failures);
+    }
+  }
+  for (intptr_t i = 0; i < candidate->lengths.length(); ++i) {
+    Definition* length = candidate->lengths[i];
+    const int64_t offset = candidate->max_offsets[i];
+    if (length == candidate->limit && offset <= 0) {
+      continue;
+    }
+    Definition* limit = AppendInt64(&cursor, candidate->limit);
+    Definition* bound = AppendInt64(&cursor, length);
+    if (offset != 0) {
+      bound = new (zone()) BinaryInt64OpInstr(
+          Token::kSUB, new (zone()) Value(bound),
+          new (zone()) Value(Int64Constant(offset)), DeoptId::kNone,
+          Instruction::kNotSpeculative);
+      cursor = flow_graph_->AppendTo(cursor, bound, nullptr, FlowGraph::kValue);
+    }
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) RelationalOpInstr(source, Token::kLTE,
+                                       new (zone()) Value(limit),
+                                       new (zone()) Value(bound), kMintCid,
+                                       DeoptId::kNone,
+                                       Instruction::kNotSpeculative),
+        failures);
+  }
+
+  // The copy uses non-nullable redefinitions in place of null checks.
+  for (intptr_t i = 0; i < candidate->non_null_values.length(); ++i) {
+    Definition* value = candidate->non_null_values[i];
+    RedefinitionInstr* redefinition =
+        new (zone()) RedefinitionInstr(new (zone()) Value(value));
+    redefinition->set_constrained_type(
+        new (zone()) CompileType(value->Type()->CopyNonNullable()));
+    cursor = flow_graph_->AppendTo(cursor, redefinition, nullptr,
+                                   FlowGraph::kValue);
+    candidate->non_null_redefinitions.Add(redefinition);
+  }
+  return cursor;
+}
+
+Instruction* LoopVersioning::AppendUnrollingGuards(
+    Candidate* candidate,
+    Instruction* cursor,
+    GrowableArray<TargetEntryInstr*>* failures,
+    Definition** limit) {
+  ASSERT(candidate->limit->representation() == kUnboxedInt64);
+  const int64_t delta = unroll_factor_ - 1;
+
+  // n - (k - 1) does not overflow.
+  if (!RangeUtils::IsWithin(candidate->limit->range(), kMinInt64 + delta,
+                            kMaxInt64)) {
+    cursor = AppendGuard(
+        candidate, cursor,
+        new (zone()) RelationalOpInstr(
+            candidate->compare->source(), Token::kLTE,
+            new (zone()) Value(Int64Constant(kMinInt64 + delta)),
+            new (zone()) Value(candidate->limit), kMintCid, DeoptId::kNone,
+            Instruction::kNotSpeculative),
+        failures);
+  }
+  *limit = new (zone()) BinaryInt64OpInstr(
+      Token::kSUB, new (zone()) Value(candidate->limit),
+      new (zone()) Value(Int64Constant(delta)), DeoptId::kNone,
+      Instruction::kNotSpeculative);
+  return flow_graph_->AppendTo(cursor, *limit, nullptr, FlowGraph::kValue);
+}
+
+// Returns the given integer as an unboxed int64, converting it after the
+// cursor if necessary.
+Definition* LoopVersioning::AppendInt64(Instruction** cursor,
+                                        Definition* def) {
+  if (def->representation() == kUnboxedInt64) {
+    return def;
+  }
+  ASSERT(def->representation() == kTagged);
+  Definition* unboxed =
+      UnboxInstr::Create(kUnboxedInt64, new (zone()) Value(def),
+                         DeoptId::kNone, Instruction::kNotSpeculative);
+  *cursor = flow_graph_->AppendTo(*cursor, unboxed, nullptr, FlowGraph::kValue);
+  return unboxed;
+}
+
+// Appends copies of the instructions of the given block, except for its
+// last instruction, and for stack overflow checks of the header in all but
+// the first iteration.
+Instruction* LoopVersioning::EmitCopies(Candidate* candidate,
+                                        BlockEntryInstr* block,
+                                        Instruction* cursor,
+                                        bool is_first_iteration) {
+  for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (current == block->last_instruction()) {
+      break;
+    }
+    if (!is_first_iteration && block == candidate->header &&
+        current->IsCheckStackOverflow()) {
+      continue;
+    }
+    if (IsRemovedCheck(candidate, current)) {
+      Definition* replacement = nullptr;
+      if (CheckBoundBase* check = current->AsCheckBoundBase()) {
+        replacement = LookupCopy(check->index()->definition());
+      } else {
+        Definition* value = current->AsCheckNull()->value()->definition();
+        intptr_t i = 0;
+        while (candidate->non_null_values[i] != value) {
+          i++;
+        }
+        replacement = candidate->non_null_redefinitions[i];
+      }
+      copies_.Update({current->AsDefinition(), replacement});
+      continue;
+    }
+    Instruction* copy = CopyInstruction(current);
+    Definition* def = current->AsDefinition();
+    cursor = flow_graph_->AppendTo(
+        cursor, copy, nullptr,
+        def != nullptr && def->HasSSATemp() ? FlowGraph::kValue
+                                            : FlowGraph::kEffect);
+    CopyEnvironment(current, copy);
+    if (def != nullptr) {
+      Definition* copy_def = copy->AsDefinition();
+      if (!Range::IsUnknown(def->range())) {
+        copy_def->set_range(*def->range());
+      }
+      copies_.Update({def, copy_def});
+    }
+  }
+  return cursor;
+}
+
+Instruction* LoopVersioning::CopyInstruction(Instruction* instr) {
+  const intptr_t deopt_id = instr->deopt_id_for_copy();
+  if (BinaryInt64OpInstr* op = instr->AsBinaryInt64Op()) {
+    return new (zone()) BinaryInt64OpInstr(
+        op->op_kind(), CopyValue(op->left()), CopyValue(op->right()),
+        deopt_id, op->SpeculativeModeOfInputs());
+  }
+  if (BinaryIntegerOpInstr* op = instr->AsBinaryIntegerOp()) {
+    return BinaryIntegerOpInstr::Make(
+        op->representation(), op->op_kind(), CopyValue(op->left()),
+        CopyValue(op->right()), deopt_id, op->can_overflow(),
+        op->is_truncating(), op->range(), op->SpeculativeModeOfInputs());
+  }
+  if (BinaryDoubleOpInstr* op = instr->AsBinaryDoubleOp()) {
+    return new (zone()) BinaryDoubleOpInstr(
+        op->op_kind(), CopyValue(op->left()), CopyValue(op->right()),
+        deopt_id, op->source(), op->SpeculativeModeOfInputs());
+  }
+  if (BoxInstr* box = instr->AsBox()) {
+    return BoxInstr::Create(box->from_representation(),
+                            CopyValue(box->value()));
+  }
+  if (UnboxInstr* unbox = instr->AsUnbox()) {
+    UnboxInstr* copy =
+        UnboxInstr::Create(unbox->representation(), CopyValue(unbox->value()),
+                           deopt_id, unbox->SpeculativeModeOfInputs());
+    if (unbox->IsUnboxInteger() && unbox->AsUnboxInteger()->is_truncating()) {
+      copy->AsUnboxInteger()->mark_truncating();
+    }
+    return copy;
+  }
+  if (IntConverterInstr* conv = instr->AsIntConverter()) {
+    IntConverterInstr* copy = new (zone()) IntConverterInstr(
+        conv->from(), conv->to(), CopyValue(conv->value()), deopt_id);
+    if (conv->is_truncating()) {
+      copy->mark_truncating();
+    }
+    return copy;
+  }
+  if (LoadUntaggedInstr* load = instr->AsLoadUntagged()) {
+    return new (zone())
+        LoadUntaggedInstr(CopyValue(load->object()), load->offset());
+  }
+  if (LoadClassIdInstr* load = instr->AsLoadClassId()) {
+    return new (zone()) LoadClassIdInstr(CopyValue(load->object()),
+                                         load->representation(),
+                                         load->input_can_be_smi());
+  }
+  if (LoadFieldInstr* load = instr->AsLoadField()) {
+    return new (zone()) LoadFieldInstr(CopyValue(load->instance()),
+                                       load->slot(), load->source(),
+                                       /*calls_initializer=*/false, deopt_id);
+  }
+  if (LoadIndexedInstr* load = instr->AsLoadIndexed()) {
+    return new (zone()) LoadIndexedInstr(
+        CopyValue(load->array()), CopyValue(load->index()),
+        load->index_unboxed(), load->index_scale(), load->class_id(),
+        load->aligned() ? kAlignedAccess : kUnalignedAccess, deopt_id,
+        load->source());
+  }
+  if (StoreIndexedInstr* store = instr->AsStoreIndexed()) {
+    return new (zone()) StoreIndexedInstr(
+        CopyValue(store->array()), CopyValue(store->index()),
+        CopyValue(store->value()), store->emit_store_barrier(),
+        store->index_unboxed(), store->index_scale(), store->class_id(),
+        store->aligned() ? kAlignedAccess : kUnalignedAccess, deopt_id,
+        store->source(), store->SpeculativeModeOfInputs());
+  }
+  if (CheckArrayBoundInstr* check = instr->AsCheckArrayBound()) {
+    return new (zone()) CheckArrayBoundInstr(
+        CopyValue(check->length()), CopyValue(check->index()), deopt_id);
+  }
+  if (GenericCheckBoundInstr* check = instr->AsGenericCheckBound()) {
+    return new (zone()) GenericCheckBoundInstr(
+        CopyValue(check->length()), CopyValue(check->index()), deopt_id);
+  }
+  if (CheckNullInstr* check = instr->AsCheckNull()) {
+    return new (zone())
+        CheckNullInstr(CopyValue(check->value()), check->function_name(),
+                       deopt_id, check->source(), check->exception_type());
+  }
+  if (CheckSmiInstr* check = instr->AsCheckSmi()) {
+    return new (zone())
+        CheckSmiInstr(CopyValue(check->value()), deopt_id, check->source());
+  }
+  CheckStackOverflowInstr* check = instr->AsCheckStackOverflow();
+  ASSERT(check != nullptr);
+  return new (zone()) CheckStackOverflowInstr(
+      check->source(), check->stack_depth(), check->loop_depth(), deopt_id,
+      check->kind());
+}
+
+// Gives the copy an environment which refers to the current iteration of
+// the copy instead of the original loop.
+void LoopVersioning::CopyEnvironment(Instruction* from, Instruction* to) {
+  if (from->env() == nullptr) {
+    return;
+  }
+  from->env()->DeepCopyTo(zone(), to);
+  for (Environment::DeepIterator it(to->env()); !it.Done(); it.Advance()) {
+    Value* use = it.CurrentValue();
+    Definition* copy = copies_.LookupValue(use->definition());
+    if (copy != nullptr) {
+      use->RemoveFromUseList();
+      use->set_definition(copy);
+      copy->AddEnvUse(use);
+    }
+  }
+}
+
+Definition* LoopVersioning::LookupCopy(Definition* def) const {
+  Definition* copy = copies_.LookupValue(def);
+  return copy != nullptr ? copy : def;
+}
+
+Value* LoopVersioning::CopyValue(Value* value) const {
+  return new (zone()) Value(LookupCopy(value->definition()));
+}
+
+}  // namespace dart
@@ -0,0 +1,131 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_LOOP_VERSIONING_H_
+#define RUNTIME_VM_COMPILER_BACKEND_LOOP_VERSIONING_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/compiler/backend/loop_transformer.h"
+#include "vm/hash_map.h"
+
+namespace dart {
+
+// Specializes simple counted loops by inserting a faster copy in front of
+// them.
+//
+// A loop qualifies if it consists of a header and a single body block, and
+// its header only computes side-effect free values and tests
+//
+//     for (i = init; i < n; i++)
+//
+// for a loop invariant n. The copy runs as many iterations as it can and
+// then enters the original loop, which runs the remaining ones:
+//
+//     if (guards) {
+//       for (; i < n'; i += k) { <k copies of the body> }
+//     }
+//     for (; i < n; i++) { <original body> }
+//
+// Values of all header phis flow from the copy into the original loop, so
+// values computed by the loop remain defined by the original header.
+//
+// Loop versioning (k = 1, n' = n) guards the copy with the conditions
+// which make bounds checks of indices i + c into loop invariant arrays, and
+// null checks of loop invariant values, redundant in every iteration:
+//
+//     init + c >= 0 && n + c <= length && value != null
+//
+// and drops these checks from the copy.
+//
+// Loop unrolling (k > 1, n' = n - (k - 1)) applies to small loops without
+// such checks, and reduces the number of back edges and tests of the index.
+class LoopVersioning : public LoopTransformer {
+ public:
+  enum Mode { kVersion, kUnroll };
+
+  LoopVersioning(FlowGraph* flow_graph, Mode mode);
+
+  // Removes bounds and null checks from loops by versioning them.
+  static void VersionLoops(FlowGraph* flow_graph);
+
+  // Unrolls small loops without bounds and null checks.
+  static void UnrollLoops(FlowGraph* flow_graph);
+
+ private:
+  struct Candidate : public LoopTransformer::Candidate {
+    Candidate()
+        : size(0),
+          has_checks(false),
+          min_offset(0),
+          removed_checks(),
+          lengths(),
+          max_offsets(),
+          non_null_values(),
+          non_null_redefinitions() {}
+
+    intptr_t size;
+    bool has_checks;
+
+    // Checks dropped from the versioned copy, and what their guards need:
+    // the smallest offset c of all checked indices i + c, and the largest
+    // offset per checked length.
+    int64_t min_offset;
+    GrowableArray<Instruction*> removed_checks;
+    GrowableArray<Definition*> lengths;
+    GrowableArray<int64_t> max_offsets;
+    GrowableArray<Definition*> non_null_values;
+    GrowableArray<Definition*> non_null_redefinitions;
+  };
+
+  typedef RawPointerKeyValueTrait<Definition, Definition*> DefinitionKV;
+
+  virtual LoopTransformer::Candidate* AnalyzeLoop(LoopInfo* loop);
+  virtual void TransformLoop(LoopTransformer::Candidate* candidate);
+
+  bool Analyze(LoopInfo* loop, Candidate* candidate);
+  bool AnalyzeBlock(Candidate* candidate, BlockEntryInstr* block);
+  bool AnalyzeChecks(Candidate* candidate);
+  bool CanRemoveBoundsCheck(Candidate* candidate,
+                            CheckBoundBase* check,
+                            int64_t* offset) const;
+  bool CanCopy(Instruction* instr) const;
+  bool IsRemovedCheck(Candidate* candidate, Instruction* instr) const;
+
+  void Transform(Candidate* candidate);
+  Instruction* AppendVersioningGuards(
+      Candidate* candidate,
+      Instruction* cursor,
+      GrowableArray<TargetEntryInstr*>* failures);
+  Instruction* AppendUnrollingGuards(
+      Candidate* candidate,
+      Instruction* cursor,
+      GrowableArray<TargetEntryInstr*>* failures,
+      Definition** limit);
+  Definition* AppendInt64(Instruction** cursor, Definition* def);
+
+  Instruction* EmitCopies(Candidate* candidate,
+                          BlockEntryInstr* block,
+                          Instruction* cursor,
+                          bool is_first_iteration);
+  Instruction* CopyInstruction(Instruction* instr);
+  void CopyEnvironment(Instruction* from, Instruction* to);
+  Definition* LookupCopy(Definition* def) const;
+  Value* CopyValue(Value* value) const;
+
+  const Mode mode_;
+  const intptr_t unroll_factor_;
+
+  // Maps definitions of the original loop to their counterparts in the
+  // iteration of the copy which is currently emitted.
+  DirectChainedHashMap<DefinitionKV> copies_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopVersioning);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_LOOP_VERSIONING_H_
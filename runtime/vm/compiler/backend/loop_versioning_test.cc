@@ -0,0 +1,120 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_versioning.h"
+
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, loop_unroll_factor);
+DECLARE_FLAG(bool, unroll_loops);
+
+#if defined(DART_PRECOMPILER)
+
+static int64_t InvokeWithInteger(const Function& function,
+                                 const Object& receiver,
+                                 intptr_t value) {
+  const auto& arguments = Array::Handle(Array::New(receiver.IsNull() ? 1 : 2));
+  intptr_t i = 0;
+  if (!receiver.IsNull()) {
+    arguments.SetAt(i++, receiver);
+  }
+  arguments.SetAt(i, Integer::Handle(Integer::New(value)));
+  const auto& result =
+      Object::Handle(DartEntry::InvokeFunction(function, arguments));
+  EXPECT(result.IsInteger());
+  return result.IsInteger() ? Integer::Cast(result).AsInt64Value() : -1;
+}
+
+ISOLATE_UNIT_TEST_CASE(IRTest_LoopVersioning_BoundsCheck) {
+  SetFlagScope<bool> sfs(&FLAG_unroll_loops, false);
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      int hash(Uint8List bytes, int n) {
+        int h = 0;
+        for (int i = 0; i < n; i++) {
+          h = (h * 31 + bytes[i]) & 0x3fffffff;
+        }
+        return h;
+      }
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "hash"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  // Only the original loop still checks the index.
+  EXPECT_EQ(1, CountInstructions(flow_graph, Instruction::kGenericCheckBound));
+  EXPECT_EQ(2, CountInstructions(flow_graph, Instruction::kLoadIndexed));
+
+  pipeline.CompileGraphAndAttachFunction();
+
+  const intptr_t kLength = 10;
+  const auto& bytes =
+      TypedData::Handle(TypedData::New(kTypedDataUint8ArrayCid, kLength));
+  for (intptr_t i = 0; i < kLength; i++) {
+    bytes.SetUint8(i, 3 * i + 1);
+  }
+  for (intptr_t n = 0; n <= kLength; n++) {
+    int64_t expected = 0;
+    for (intptr_t i = 0; i < n; i++) {
+      expected = (expected * 31 + bytes.GetUint8(i)) & 0x3fffffff;
+    }
+    EXPECT_EQ(expected, InvokeWithInteger(function, bytes, n));
+  }
+}
+
+ISOLATE_UNIT_TEST_CASE(IRTest_LoopUnrolling) {
+  const char* kScript =
+      R"(
+      int hash(int n) {
+        int h = 0;
+        for (int i = 0; i < n; i++) {
+          h = (h * 31 + i) & 0x3fffffff;
+        }
+        return h;
+      }
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "hash"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  intptr_t multiplications = 0;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      BinaryInt64OpInstr* op = it.Current()->AsBinaryInt64Op();
+      if (op != nullptr && op->op_kind() == Token::kMUL) {
+        multiplications++;
+      }
+    }
+  }
+  // The unrolled loop followed by the original loop.
+  EXPECT_EQ(FLAG_loop_unroll_factor + 1, multiplications);
+
+  pipeline.CompileGraphAndAttachFunction();
+
+  // Iteration counts which leave 0 to 3 iterations to the original loop.
+  for (intptr_t n = -1; n <= 9; n++) {
+    int64_t expected = 0;
+    for (intptr_t i = 0; i < n; i++) {
+      expected = (expected * 31 + i) & 0x3fffffff;
+    }
+    EXPECT_EQ(expected, InvokeWithInteger(function, Object::null_object(), n));
+  }
+}
+
+#endif  // defined(DART_PRECOMPILER)
+
+}  // namespace dart
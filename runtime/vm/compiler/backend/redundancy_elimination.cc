@@ -25,6 +25,10 @@ DEFINE_FLAG(bool,
             trace_load_optimization,
             false,
             "Print live sets for load optimization pass.");
+DEFINE_FLAG(bool,
+            partial_escape_analysis,
+            true,
+            "Materialize allocations lazily on the paths where they escape.");
 
 // Quick access to the current zone.
 #define Z (zone())
@@ -3776,6 +3780,274 @@ void AllocationSinking::InsertMaterializations(Definition* alloc) {
   }
 }
 
+// Partial escape analysis.
+//
+// AllocationSinking only removes allocations which do not escape on any path.
+// Often an allocation escapes only on a rarely taken path, e.g. when it is
+// passed to an error reporting call:
+//
+//   v_0 <- AllocateObject(A)
+//          StoreInstanceField(v_0 . f = v_1)
+//          Branch if (...) goto B1 else B2
+//   B1:    StaticCall(report, v_0)
+//          Throw(...)
+//   B2:    ... (no uses of v_0)
+//
+// Such an allocation is copied at the start of each escaping region, the
+// copy is initialized with the values the fields of the original hold at
+// that point, and it replaces the original in the region:
+//
+//   B1:    v_2 <- LoadField(v_0 . f)
+//          v_3 <- AllocateObject(A)
+//          StoreInstanceField(v_3 . f = v_2)
+//          StaticCall(report, v_3)
+//
+// The original no longer escapes: load forwarding replaces v_2 with v_1 and
+// AllocationSinking then removes v_0 and rematerializes it at deoptimization
+// exits with MaterializeObject instructions as usual.
+//
+// An escaping region is a branch target S such that every use of the
+// allocation reachable from S is dominated by S, and S can't be reached from
+// itself without executing the allocation again. Thus the original is never
+// observed once its copy was made.
+//
+// The copy is inserted without an environment, so the pass only runs in AOT
+// mode, where allocations don't deoptimize.
+bool PartialEscapeAnalysis::Optimize() {
+  if (!FLAG_partial_escape_analysis || !FLAG_load_cse ||
+      !CompilerState::Current().is_aot()) {
+    return false;
+  }
+
+  GrowableArray<Definition*> allocations;
+  for (BlockIterator block_it = flow_graph_->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      if (IsCandidate(it.Current())) {
+        allocations.Add(it.Current()->AsDefinition());
+      }
+    }
+  }
+
+  bool changed = false;
+  GrowableArray<BlockEntryInstr*> regions;
+  for (intptr_t i = 0; i < allocations.length(); i++) {
+    Definition* alloc = allocations[i];
+    if (!FindEscapingRegions(alloc, &regions)) {
+      continue;
+    }
+    if (FLAG_trace_optimization) {
+      THR_Print("Materializing v%" Pd " lazily in %" Pd " region(s)\n",
+                alloc->ssa_temp_index(), regions.length());
+    }
+    for (intptr_t j = 0; j < regions.length(); j++) {
+      MaterializeAt(alloc, regions[j]);
+    }
+    changed = true;
+  }
+
+  if (changed) {
+    // Forward loads inserted by MaterializeAt so that the original
+    // allocations have no uses left other than stores into their fields.
+    LoadOptimizer::OptimizeGraph(flow_graph_);
+  }
+  return changed;
+}
+
+bool PartialEscapeAnalysis::IsCandidate(Instruction* instr) const {
+  if (!instr->IsAllocateObject() && !instr->IsAllocateClosure()) {
+    return false;
+  }
+  Definition* alloc = instr->AsDefinition();
+  for (Value* use = alloc->input_use_list(); use != nullptr;
+       use = use->next_use()) {
+    // Indexed accesses into objects are not tracked by AllocationSinking.
+    if (use->instruction()->IsLoadIndexed() ||
+        use->instruction()->IsStoreIndexed()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects regions which cover all escaping uses of the given allocation.
+// Returns false if there are no escaping uses or some of them can't be
+// covered.
+bool PartialEscapeAnalysis::FindEscapingRegions(
+    Definition* alloc,
+    GrowableArray<BlockEntryInstr*>* regions) {
+  regions->Clear();
+  for (Value* use = alloc->input_use_list(); use != nullptr;
+       use = use->next_use()) {
+    // Only stores into the fields of the allocation don't expose it. Unlike
+    // AllocationSinking we can't treat stores into other allocations as
+    // safe: their copies would expose the original.
+    StoreInstanceFieldInstr* store = use->instruction()->AsStoreInstanceField();
+    if ((store != nullptr) && (store->instance() == use)) {
+      continue;
+    }
+    BlockEntryInstr* block = use->instruction()->GetBlock();
+    bool is_covered = false;
+    for (intptr_t i = 0; i < regions->length(); i++) {
+      if ((*regions)[i]->Dominates(block)) {
+        is_covered = true;
+        break;
+      }
+    }
+    if (is_covered) {
+      continue;
+    }
+    BlockEntryInstr* region = FindEscapingRegion(alloc, block);
+    if (region == nullptr) {
+      return false;
+    }
+    // Drop regions nested into the new one.
+    intptr_t j = 0;
+    for (intptr_t i = 0; i < regions->length(); i++) {
+      if (!region->Dominates((*regions)[i])) {
+        (*regions)[j++] = (*regions)[i];
+      }
+    }
+    regions->TruncateTo(j);
+    regions->Add(region);
+  }
+  return !regions->is_empty();
+}
+
+// Finds the outermost escaping region which contains the given block.
+BlockEntryInstr* PartialEscapeAnalysis::FindEscapingRegion(
+    Definition* alloc,
+    BlockEntryInstr* block) {
+  BlockEntryInstr* def_block = alloc->GetBlock();
+  GrowableArray<BlockEntryInstr*> dominators;
+  for (BlockEntryInstr* dom = block; dom != def_block;
+       dom = dom->dominator()) {
+    ASSERT(dom != nullptr);
+    dominators.Add(dom);
+  }
+  for (intptr_t i = dominators.length() - 1; i >= 0; i--) {
+    BlockEntryInstr* region = dominators[i];
+    if (region->IsTargetEntry() && IsClosedRegion(alloc, region)) {
+      return region;
+    }
+  }
+  return nullptr;
+}
+
+bool PartialEscapeAnalysis::IsClosedRegion(Definition* alloc,
+                                           BlockEntryInstr* region) {
+  BlockEntryInstr* def_block = alloc->GetBlock();
+  BitVector* reachable =
+      new (Z) BitVector(Z, flow_graph_->preorder().length());
+  GrowableArray<BlockEntryInstr*> worklist;
+  reachable->Add(region->preorder_number());
+  worklist.Add(region);
+  while (!worklist.is_empty()) {
+    BlockEntryInstr* block = worklist.RemoveLast();
+    for (intptr_t i = 0; i < block->SuccessorCount(); i++) {
+      BlockEntryInstr* succ = block->SuccessorAt(i);
+      if (succ == region) {
+        // The copy would be made again from the current state of the
+        // original, which might be out of date.
+        return false;
+      }
+      // Uses after the allocation is executed again refer to a new object.
+      if ((succ == def_block) || reachable->Contains(succ->preorder_number())) {
+        continue;
+      }
+      reachable->Add(succ->preorder_number());
+      worklist.Add(succ);
+    }
+  }
+
+  for (Value* use = alloc->input_use_list(); use != nullptr;
+       use = use->next_use()) {
+    BlockEntryInstr* block = use->instruction()->GetBlock();
+    if (reachable->Contains(block->preorder_number()) &&
+        !region->Dominates(block)) {
+      return false;
+    }
+  }
+  for (Value* use = alloc->env_use_list(); use != nullptr;
+       use = use->next_use()) {
+    BlockEntryInstr* block = use->instruction()->GetBlock();
+    if (reachable->Contains(block->preorder_number()) &&
+        !region->Dominates(block)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PartialEscapeAnalysis::MaterializeAt(Definition* alloc,
+                                          BlockEntryInstr* region) {
+  ZoneGrowableArray<const Slot*>* slots =
+      new (Z) ZoneGrowableArray<const Slot*>(5);
+  for (Value* use = alloc->input_use_list(); use != nullptr;
+       use = use->next_use()) {
+    StoreInstanceFieldInstr* store = use->instruction()->AsStoreInstanceField();
+    if ((store != nullptr) && (store->instance() == use)) {
+      AddSlot(slots, store->slot());
+    }
+  }
+
+  // Read the current state of the original.
+  Instruction* cursor = region;
+  GrowableArray<Instruction*> loads(slots->length());
+  for (intptr_t i = 0; i < slots->length(); i++) {
+    LoadFieldInstr* load =
+        new (Z) LoadFieldInstr(new (Z) Value(alloc), *(*slots)[i],
+                               alloc->source());
+    flow_graph_->InsertAfter(cursor, load, nullptr, FlowGraph::kValue);
+    loads.Add(load);
+    cursor = load;
+  }
+
+  // Allocate the copy and initialize it.
+  AllocationInstr* copy = CopyAllocation(alloc);
+  flow_graph_->InsertAfter(cursor, copy, nullptr, FlowGraph::kValue);
+  cursor = copy;
+  for (intptr_t i = 0; i < slots->length(); i++) {
+    StoreInstanceFieldInstr* store = new (Z) StoreInstanceFieldInstr(
+        *(*slots)[i], new (Z) Value(copy),
+        new (Z) Value(loads[i]->AsDefinition()), kEmitStoreBarrier,
+        alloc->source(), StoreInstanceFieldInstr::Kind::kInitializing);
+    flow_graph_->InsertAfter(cursor, store, nullptr, FlowGraph::kEffect);
+    cursor = store;
+  }
+
+  // Replace the original within the region.
+  for (Value::Iterator it(alloc->input_use_list()); !it.Done(); it.Advance()) {
+    Value* use = it.Current();
+    Instruction* instr = use->instruction();
+    if (region->Dominates(instr->GetBlock()) && !loads.Contains(instr)) {
+      use->BindTo(copy);
+    }
+  }
+  for (Value::Iterator it(alloc->env_use_list()); !it.Done(); it.Advance()) {
+    Value* use = it.Current();
+    if (region->Dominates(use->instruction()->GetBlock())) {
+      use->BindToEnvironment(copy);
+    }
+  }
+}
+
+AllocationInstr* PartialEscapeAnalysis::CopyAllocation(Definition* alloc) {
+  if (AllocateObjectInstr* alloc_object = alloc->AsAllocateObject()) {
+    Value* type_arguments = alloc_object->type_arguments();
+    return new (Z) AllocateObjectInstr(
+        alloc->source(), alloc_object->cls(), DeoptId::kNone,
+        (type_arguments != nullptr) ? type_arguments->CopyWithType(Z)
+                                    : nullptr);
+  }
+  AllocateClosureInstr* alloc_closure = alloc->AsAllocateClosure();
+  ASSERT(alloc_closure != nullptr);
+  return new (Z) AllocateClosureInstr(
+      alloc->source(), alloc_closure->closure_function()->CopyWithType(Z),
+      alloc_closure->context()->CopyWithType(Z), DeoptId::kNone);
+}
+
 // TryCatchAnalyzer tries to reduce the state that needs to be synchronized
 // on entry to the catch by discovering Parameter-s which are never used
 // or which are always constant.
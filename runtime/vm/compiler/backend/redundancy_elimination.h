@@ -82,6 +82,36 @@ class AllocationSinking : public ZoneAllocated {
   ExitsCollector exits_collector_;
 };
 
+// Partial escape analysis: an allocation which escapes only on some paths
+// is copied lazily at the start of each such path, so that the original
+// allocation no longer escapes and can be removed by AllocationSinking.
+class PartialEscapeAnalysis : public ValueObject {
+ public:
+  explicit PartialEscapeAnalysis(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph) {}
+
+  // Returns true if any allocation was materialized lazily.
+  bool Optimize();
+
+ private:
+  bool IsCandidate(Instruction* instr) const;
+
+  bool FindEscapingRegions(Definition* alloc,
+                           GrowableArray<BlockEntryInstr*>* regions);
+  BlockEntryInstr* FindEscapingRegion(Definition* alloc,
+                                      BlockEntryInstr* block);
+  bool IsClosedRegion(Definition* alloc, BlockEntryInstr* region);
+
+  void MaterializeAt(Definition* alloc, BlockEntryInstr* region);
+  AllocationInstr* CopyAllocation(Definition* alloc);
+
+  Zone* zone() const { return flow_graph_->zone(); }
+
+  FlowGraph* flow_graph_;
+
+  DISALLOW_COPY_AND_ASSIGN(PartialEscapeAnalysis);
+};
+
 // A simple common subexpression elimination based
 // on the dominator tree.
 class DominatorBasedCSE : public AllStatic {
@@ -1331,6 +1331,58 @@ ISOLATE_UNIT_TEST_CASE(DelayAllocations_DontDelayIntoLoop) {
   EXPECT(call->Receiver()->definition() == allocate);
 }
 
+ISOLATE_UNIT_TEST_CASE(PartialEscapeAnalysis_MaterializeOnSlowPath) {
+  const char* kScript = R"(
+    class A {
+      int x;
+      A(this.x);
+    }
+
+    @pragma('vm:never-inline')
+    void report(Object o) {
+      print(o);
+    }
+
+    int test(int x, bool fail) {
+      final a = A(x);
+      if (fail) {
+        report(a);
+        throw 'failed';
+      }
+      return a.x + 1;
+    }
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "test"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  auto entry = flow_graph->graph_entry()->normal_entry();
+
+  // Only the path which reports the object allocates it.
+  AllocateObjectInstr* allocate = nullptr;
+  StaticCallInstr* call = nullptr;
+  for (auto block : flow_graph->reverse_postorder()) {
+    for (auto instr : block->instructions()) {
+      if (auto alloc = instr->AsAllocateObject()) {
+        EXPECT(allocate == nullptr);
+        EXPECT(block != entry);
+        allocate = alloc;
+      } else if (auto static_call = instr->AsStaticCall()) {
+        if (strcmp(static_call->function().UserVisibleNameCString(),
+                   "report") == 0) {
+          call = static_call;
+        }
+      }
+    }
+  }
+  RELEASE_ASSERT(allocate != nullptr);
+  RELEASE_ASSERT(call != nullptr);
+  EXPECT(call->ArgumentAt(0) == allocate);
+  EXPECT(allocate->GetBlock()->Dominates(call->GetBlock()));
+}
+
 ISOLATE_UNIT_TEST_CASE(CheckStackOverflowElimination_NoInterruptsPragma) {
   const char* kScript = R"(
     @pragma('vm:unsafe:no-interrupts')
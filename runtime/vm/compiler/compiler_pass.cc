@@ -12,6 +12,8 @@
 #include "vm/compiler/backend/il_printer.h"
 #include "vm/compiler/backend/inliner.h"
 #include "vm/compiler/backend/linearscan.h"
+#include "vm/compiler/backend/loop_vectorizer.h"
+#include "vm/compiler/backend/loop_versioning.h"
 #include "vm/compiler/backend/range_analysis.h"
 #include "vm/compiler/backend/redundancy_elimination.h"
 #include "vm/compiler/backend/type_propagator.h"
@@ -348,6 +350,9 @@ FlowGraph* CompilerPass::RunPipeline(PipelineMode mode,
   INVOKE_PASS(TypePropagation);
   INVOKE_PASS(RangeAnalysis);
   INVOKE_PASS(OptimizeBranches);
+  INVOKE_PASS(VectorizeLoops);
+  INVOKE_PASS(VersionLoops);
+  INVOKE_PASS(UnrollLoops);
   INVOKE_PASS(TypePropagation);
   INVOKE_PASS(TryCatchOptimization);
   INVOKE_PASS(EliminateEnvironments);
@@ -485,6 +490,20 @@ COMPILER_PASS(OptimizeBranches, {
   ConstantPropagator::OptimizeBranches(flow_graph);
 });
 
+COMPILER_PASS(VectorizeLoops, {
+  // Relies on LICM having hoisted loop invariant values and on range
+  // analysis having removed redundant bounds checks.
+  LoopVectorizer::Optimize(flow_graph);
+});
+
+COMPILER_PASS(VersionLoops, {
+  // Relies on range analysis having removed the bounds checks which are
+  // redundant without versioning.
+  LoopVersioning::VersionLoops(flow_graph);
+});
+
+COMPILER_PASS(UnrollLoops, { LoopVersioning::UnrollLoops(flow_graph); });
+
 COMPILER_PASS(OptimizeTypedDataAccesses,
               { TypedDataSpecializer::Optimize(flow_graph); });
 
@@ -505,6 +524,7 @@ COMPILER_PASS(DelayAllocations, { DelayAllocations::Optimize(flow_graph); });
 COMPILER_PASS(AllocationSinking_Sink, {
   // TODO(vegorov): Support allocation sinking with try-catch.
   if (flow_graph->graph_entry()->catch_entries().is_empty()) {
+    PartialEscapeAnalysis(flow_graph).Optimize();
     state->sinking = new AllocationSinking(flow_graph);
     state->sinking->Optimize();
   }
@@ -50,7 +50,10 @@ namespace dart {
   V(TryCatchOptimization)                                                      \
   V(TryOptimizePatterns)                                                       \
   V(TypePropagation)                                                           \
+  V(UnrollLoops)                                                               \
   V(UseTableDispatch)                                                          \
+  V(VectorizeLoops)                                                            \
+  V(VersionLoops)                                                              \
   V(WidenSmiToInt32)                                                           \
   V(EliminateWriteBarriers)                                                    \
   V(GenerateCode)
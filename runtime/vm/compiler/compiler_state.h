@@ -17,6 +17,7 @@
 
 namespace dart {
 
+class AotProfile;
 class CompilerPass;
 struct CompilerPassState;
 class Function;
@@ -72,6 +73,10 @@ class CompilerState : public ThreadStackResource {
   SlotCache* slot_cache() const { return slot_cache_; }
   void set_slot_cache(SlotCache* cache) { slot_cache_ = cache; }
 
+  // The profile guiding AOT compilation (see aot_profile.h), or nullptr.
+  const AotProfile* aot_profile() const { return aot_profile_; }
+  void set_aot_profile(const AotProfile* profile) { aot_profile_ = profile; }
+
   // Create a dummy list of local variables representing a context object
   // with the given number of captured variables and given ID.
   const ZoneGrowableArray<const Slot*>& GetDummyContextSlots(
@@ -128,6 +133,8 @@ class CompilerState : public ThreadStackResource {
   // Cache for Slot objects created during compilation (see slot.h).
   SlotCache* slot_cache_ = nullptr;
 
+  const AotProfile* aot_profile_ = nullptr;
+
   // Caches for dummy LocalVariables and context Slots.
   ZoneGrowableArray<ZoneGrowableArray<const Slot*>*>* dummy_slots_ = nullptr;
   ZoneGrowableArray<LocalVariable*>* dummy_captured_vars_ = nullptr;
@@ -9,6 +9,7 @@
 #include "vm/compiler/backend/flow_graph_compiler.h"
 #include "vm/compiler/frontend/constant_reader.h"
 #include "vm/flags.h"
+#include "vm/kernel_loader.h"
 #include "vm/log.h"
 #include "vm/object_store.h"
 #include "vm/parser.h"  // for ParsedFunction
@@ -545,34 +546,34 @@ LibraryPtr TranslationHelper::LookupLibraryByKernelLibrary(
   // This ASSERT is just a sanity check.
   ASSERT(IsLibrary(kernel_library) ||
          IsAdministrative(CanonicalNameParent(kernel_library)));
-  {
+  name_index_handle_ = Smi::New(kernel_library);
+  Library& library =
+      Library::Handle(Z, info_.LookupLibrary(thread_, name_index_handle_));
+  if (library.IsNull()) {
+    const String& library_name =
+        DartSymbolPlain(CanonicalNameString(kernel_library));
+    ASSERT(!library_name.IsNull());
+    library = Library::LookupLibrary(thread_, library_name);
+    CheckStaticLookup(library);
     name_index_handle_ = Smi::New(kernel_library);
-    LibraryPtr raw_lib = info_.LookupLibrary(thread_, name_index_handle_);
-    NoSafepointScope no_safepoint_scope(thread_);
-    if (raw_lib != Library::null()) {
-      return raw_lib;
-    }
+    library = info_.InsertLibrary(thread_, name_index_handle_, library);
   }
-
-  const String& library_name =
-      DartSymbolPlain(CanonicalNameString(kernel_library));
-  ASSERT(!library_name.IsNull());
-  const Library& library =
-      Library::Handle(Z, Library::LookupLibrary(thread_, library_name));
-  CheckStaticLookup(library);
-  name_index_handle_ = Smi::New(kernel_library);
-  return info_.InsertLibrary(thread_, name_index_handle_, library);
+  EnsureLibraryLoaded(library);
+  return library.ptr();
 }
 
 ClassPtr TranslationHelper::LookupClassByKernelClass(NameIndex kernel_class) {
   ASSERT(IsClass(kernel_class));
-  {
-    name_index_handle_ = Smi::New(kernel_class);
-    ClassPtr raw_class = info_.LookupClass(thread_, name_index_handle_);
-    NoSafepointScope no_safepoint_scope(thread_);
-    if (raw_class != Class::null()) {
-      return raw_class;
+  name_index_handle_ = Smi::New(kernel_class);
+  Class& klass =
+      Class::Handle(Z, info_.LookupClass(thread_, name_index_handle_));
+  if (!klass.IsNull()) {
+    // Classes referenced by loaded libraries are cached before their own
+    // library is loaded.
+    if (!klass.is_declaration_loaded()) {
+      EnsureLibraryLoaded(Library::Handle(Z, klass.library()));
     }
+    return klass.ptr();
   }
 
   const String& class_name = DartClassName(kernel_class);
@@ -580,14 +581,26 @@ ClassPtr TranslationHelper::LookupClassByKernelClass(NameIndex kernel_class) {
   Library& library =
       Library::Handle(Z, LookupLibraryByKernelLibrary(kernel_library));
   ASSERT(!library.IsNull());
-  const Class& klass =
-      Class::Handle(Z, library.LookupClassAllowPrivate(class_name));
+  klass = library.LookupClassAllowPrivate(class_name);
   CheckStaticLookup(klass);
   ASSERT(!klass.IsNull());
   name_index_handle_ = Smi::New(kernel_class);
   return info_.InsertClass(thread_, name_index_handle_, klass);
 }
 
+void TranslationHelper::EnsureLibraryLoaded(const Library& library) {
+  if (!KernelLoader::IsLibraryLoadingDeferred(library)) {
+    return;
+  }
+  Error& error = Error::Handle(Z, KernelLoader::EnsureLibraryLoaded(library));
+  if (error.IsNull() && !ClassFinalizer::ProcessPendingClasses()) {
+    error = thread_->StealStickyError();
+  }
+  if (!error.IsNull()) {
+    Report::LongJump(error);
+  }
+}
+
 FieldPtr TranslationHelper::LookupFieldByKernelField(NameIndex kernel_field) {
   ASSERT(IsField(kernel_field));
   NameIndex enclosing = EnclosingName(kernel_field);
@@ -220,6 +220,10 @@ class TranslationHelper {
   }
 
  private:
+  // Loads [library] if its loading was deferred and finalizes the classes
+  // it declares.
+  void EnsureLibraryLoaded(const Library& library);
+
   // This will mangle [name_to_modify] if necessary and make the result a symbol
   // if asked.  The result will be available in [name_to_modify] and it is also
   // returned.  If the name is private, the canonical name [parent] will be used
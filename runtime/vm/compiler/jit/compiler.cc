@@ -39,6 +39,7 @@
 #include "vm/regexp_assembler.h"
 #include "vm/regexp_parser.h"
 #include "vm/runtime_entry.h"
+#include "vm/startup_trace.h"
 #include "vm/symbols.h"
 #include "vm/tags.h"
 #include "vm/thread_registry.h"
@@ -68,6 +69,11 @@ DEFINE_FLAG(bool,
             stress_test_background_compilation,
             false,
             "Keep background compiler running all the time");
+DEFINE_FLAG(int,
+            background_compiler_tasks,
+            1,
+            "The maximum number of threads of an isolate group which run "
+            "optimizing compilations in the background.");
 DEFINE_FLAG(bool,
             stop_on_excessive_deoptimization,
             false,
@@ -220,6 +226,8 @@ DEFINE_RUNTIME_ENTRY(CompileFunction, 1) {
     SafepointReadRwLocker ml(thread, thread->isolate_group()->program_lock());
   }
 
+  StartupTrace::RecordFunction(function);
+
   // Will throw if compilation failed (e.g. with compile-time error).
   function.EnsureHasCode();
 }
@@ -983,7 +991,9 @@ void Compiler::AbortBackgroundCompilation(intptr_t deopt_id, const char* msg) {
 class QueueElement {
  public:
   explicit QueueElement(const Function& function)
-      : next_(NULL), function_(function.ptr()) {}
+      : next_(NULL),
+        function_(function.ptr()),
+        enqueue_micros_(OS::GetCurrentMonotonicMicros()) {}
 
   virtual ~QueueElement() {
     next_ = NULL;
@@ -1000,18 +1010,22 @@ class QueueElement {
     return reinterpret_cast<ObjectPtr*>(&function_);
   }
 
+  int64_t enqueue_micros() const { return enqueue_micros_; }
+
  private:
   QueueElement* next_;
   FunctionPtr function_;
+  const int64_t enqueue_micros_;
 
   DISALLOW_COPY_AND_ASSIGN(QueueElement);
 };
 
 // Allocated in C-heap. Handles both input and output of background compilation.
-// It implements a FIFO queue, using Peek, Add, Remove operations.
+// It implements a FIFO queue, using Peek, Add, Remove operations, and a
+// priority queue ordered by hotness, using Add, RemoveHottest operations.
 class BackgroundCompilationQueue {
  public:
-  BackgroundCompilationQueue() : first_(NULL), last_(NULL) {}
+  BackgroundCompilationQueue() : first_(NULL), last_(NULL), length_(0) {}
   virtual ~BackgroundCompilationQueue() { Clear(); }
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor) {
@@ -1024,6 +1038,7 @@ class BackgroundCompilationQueue {
   }
 
   bool IsEmpty() const { return first_ == NULL; }
+  intptr_t length() const { return length_; }
 
   void Add(QueueElement* value) {
     ASSERT(value != NULL);
@@ -1036,6 +1051,7 @@ class BackgroundCompilationQueue {
       last_->set_next(value);
     }
     last_ = value;
+    length_++;
     ASSERT(first_ != NULL && last_ != NULL);
   }
 
@@ -1057,9 +1073,52 @@ class BackgroundCompilationQueue {
     if (first_ == NULL) {
       last_ = NULL;
     }
+    result->set_next(NULL);
+    length_--;
     return result;
   }
 
+  void Remove(QueueElement* element) {
+    ASSERT(element != NULL);
+    QueueElement* previous = NULL;
+    QueueElement* p = first_;
+    while (p != element) {
+      ASSERT(p != NULL);
+      previous = p;
+      p = p->next();
+    }
+    if (previous == NULL) {
+      first_ = element->next();
+    } else {
+      previous->set_next(element->next());
+    }
+    if (last_ == element) {
+      last_ = previous;
+    }
+    element->set_next(NULL);
+    length_--;
+  }
+
+  // Removes the function which was used the most since it was queued, so
+  // that the hottest functions are optimized first. Ties are broken in FIFO
+  // order.
+  QueueElement* RemoveHottest() {
+    ASSERT(first_ != NULL);
+    Function& function = Function::Handle();
+    QueueElement* hottest = NULL;
+    int64_t hottest_usage = kMinInt64;
+    for (QueueElement* p = first_; p != NULL; p = p->next()) {
+      function = p->Function();
+      const int64_t usage = UsageSinceQueued(function);
+      if (usage > hottest_usage) {
+        hottest = p;
+        hottest_usage = usage;
+      }
+    }
+    Remove(hottest);
+    return hottest;
+  }
+
   bool ContainsObj(const Object& obj) const {
     QueueElement* p = first_;
     while (p != NULL) {
@@ -1076,12 +1135,19 @@ class BackgroundCompilationQueue {
       QueueElement* e = Remove();
       delete e;
     }
-    ASSERT((first_ == NULL) && (last_ == NULL));
+    ASSERT((first_ == NULL) && (last_ == NULL) && (length_ == 0));
   }
 
  private:
+  // The usage counter of a function is reset to INT32_MIN when it is queued,
+  // see OptimizeInvokedFunction.
+  static int64_t UsageSinceQueued(const Function& function) {
+    return static_cast<int64_t>(function.usage_counter()) - kMinInt32;
+  }
+
   QueueElement* first_;
   QueueElement* last_;
+  intptr_t length_;
 
   DISALLOW_COPY_AND_ASSIGN(BackgroundCompilationQueue);
 };
@@ -1104,13 +1170,40 @@ BackgroundCompiler::BackgroundCompiler(IsolateGroup* isolate_group)
     : isolate_group_(isolate_group),
       monitor_(),
       function_queue_(new BackgroundCompilationQueue()),
+      compiling_queue_(new BackgroundCompilationQueue()),
       running_(false),
-      done_(true),
+      running_tasks_(0),
       disabled_depth_(0) {}
 
 // Fields all deleted in ::Stop; here clear them.
 BackgroundCompiler::~BackgroundCompiler() {
   delete function_queue_;
+  delete compiling_queue_;
+}
+
+static void ReportQueueWait(Thread* thread,
+                            const Function& function,
+                            int64_t enqueue_micros) {
+  const int64_t dequeue_micros = OS::GetCurrentMonotonicMicros();
+  if (FLAG_trace_compiler) {
+    THR_Print("Waited %" Pd64 " us in the background compilation queue: %s\n",
+              dequeue_micros - enqueue_micros,
+              function.ToFullyQualifiedCString());
+  }
+#if defined(SUPPORT_TIMELINE)
+  TimelineStream* compiler_stream = Timeline::GetCompilerStream();
+  if (compiler_stream->enabled()) {
+    const char* function_name = function.ToQualifiedCString();
+    TimelineEvent* event = compiler_stream->StartEvent();
+    if (event != NULL) {
+      event->Duration("BackgroundCompilationQueueWait", enqueue_micros,
+                      dequeue_micros);
+      event->SetNumArguments(1);
+      event->CopyArgument(0, "function", function_name);
+      event->Complete();
+    }
+  }
+#endif  // defined(SUPPORT_TIMELINE)
 }
 
 void BackgroundCompiler::Run() {
@@ -1127,26 +1220,29 @@ void BackgroundCompiler::Run() {
     {
       SafepointMonitorLocker ml(&monitor_);
       if (running_ && !function_queue()->IsEmpty()) {
-        element = function_queue()->Remove();
+        element = function_queue()->RemoveHottest();
+        // Other threads must not compile the function at the same time.
+        compiling_queue_->Add(element);
         function ^= element->function();
       }
     }
     if (element != nullptr) {
-      delete element;
+      ReportQueueWait(thread, function, element->enqueue_micros());
       Compiler::CompileOptimizedFunction(thread, function,
                                          Compiler::kNoOSRDeoptId);
 
       // If an optimizable method is not optimized, put it back on
       // the background queue (unless it was passed to foreground).
-      if ((!function.HasOptimizedCode() && function.IsOptimizable()) ||
-          FLAG_stress_test_background_compilation) {
-        if (Compiler::CanOptimizeFunction(thread, function)) {
-          SafepointMonitorLocker ml(&monitor_);
-          if (running_) {
-            QueueElement* repeat_qelem = new QueueElement(function);
-            function_queue()->Add(repeat_qelem);
-          }
-        }
+      const bool repeat =
+          ((!function.HasOptimizedCode() && function.IsOptimizable()) ||
+           FLAG_stress_test_background_compilation) &&
+          Compiler::CanOptimizeFunction(thread, function);
+      SafepointMonitorLocker ml(&monitor_);
+      compiling_queue_->Remove(element);
+      delete element;
+      if (repeat && running_) {
+        QueueElement* repeat_qelem = new QueueElement(function);
+        function_queue()->Add(repeat_qelem);
       }
     }
   }
@@ -1157,16 +1253,30 @@ void BackgroundCompiler::Run() {
         Dart::thread_pool()->Run<BackgroundCompilerTask>(this)) {
       // Successfully scheduled a new task.
     } else {
-      // Background compiler done. This notification must happen after the
-      // thread leaves to group to avoid a shutdown race with the thread
-      // registry.
-      running_ = false;
-      done_ = true;
-      ml.NotifyAll();
+      // This task is done. The notification must happen after the thread
+      // leaves to group to avoid a shutdown race with the thread registry.
+      running_tasks_--;
+      if (running_tasks_ == 0) {
+        // Background compiler done.
+        running_ = false;
+        ml.NotifyAll();
+      }
     }
   }
 }
 
+bool BackgroundCompiler::StartTaskLocked() {
+  // If we ever wanted to run the BG compiler on the
+  // `IsolateGroup::mutator_pool()` we would need to ensure the BG compiler
+  // stops when it's idle - otherwise the [MutatorThreadPool]-based idle
+  // notification would not work anymore.
+  if (!Dart::thread_pool()->Run<BackgroundCompilerTask>(this)) {
+    return false;
+  }
+  running_tasks_++;
+  return true;
+}
+
 bool BackgroundCompiler::EnqueueCompilation(const Function& function) {
   Thread* thread = Thread::Current();
   ASSERT(thread->IsMutatorThread());
@@ -1174,32 +1284,35 @@ bool BackgroundCompiler::EnqueueCompilation(const Function& function) {
 
   SafepointMonitorLocker ml(&monitor_);
   if (disabled_depth_ > 0) return false;
-  if (!running_ && done_) {
+  if (!running_ && running_tasks_ == 0) {
     running_ = true;
-    done_ = false;
-    // If we ever wanted to run the BG compiler on the
-    // `IsolateGroup::mutator_pool()` we would need to ensure the BG compiler
-    // stops when it's idle - otherwise the [MutatorThreadPool]-based idle
-    // notification would not work anymore.
-    if (!Dart::thread_pool()->Run<BackgroundCompilerTask>(this)) {
+    if (!StartTaskLocked()) {
       running_ = false;
-      done_ = true;
       return false;
     }
   }
 
   ASSERT(running_);
-  if (function_queue()->ContainsObj(function)) {
+  if (function_queue()->ContainsObj(function) ||
+      compiling_queue_->ContainsObj(function)) {
     return true;
   }
   QueueElement* elem = new QueueElement(function);
   function_queue()->Add(elem);
+  // Start another thread if there is more work than running threads. It is
+  // fine if this fails, as the running threads will get to the function.
+  const intptr_t work = function_queue()->length() + compiling_queue_->length();
+  if (running_tasks_ < Utils::Minimum<intptr_t>(
+                           FLAG_background_compiler_tasks, work)) {
+    StartTaskLocked();
+  }
   ml.NotifyAll();
   return true;
 }
 
 void BackgroundCompiler::VisitPointers(ObjectPointerVisitor* visitor) {
   function_queue_->VisitObjectPointers(visitor);
+  compiling_queue_->VisitObjectPointers(visitor);
 }
 
 void BackgroundCompiler::Stop() {
@@ -1215,7 +1328,7 @@ void BackgroundCompiler::StopLocked(Thread* thread,
                                     SafepointMonitorLocker* locker) {
   running_ = false;
   function_queue_->Clear();
-  while (!done_) {
+  while (running_tasks_ > 0) {
     locker->Wait();
   }
 }
@@ -1239,7 +1352,7 @@ void BackgroundCompiler::Disable() {
 
   SafepointMonitorLocker ml(&monitor_);
   disabled_depth_++;
-  if (done_) return;
+  if (running_tasks_ == 0) return;
   StopLocked(thread, &ml);
 }
 
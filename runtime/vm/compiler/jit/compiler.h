@@ -154,14 +154,16 @@ class BackgroundCompiler {
   void StopLocked(Thread* thread, SafepointMonitorLocker* done_locker);
   void Enable();
   void Disable();
-  bool IsRunning() { return !done_; }
+  bool IsRunning() { return running_tasks_ > 0; }
+  bool StartTaskLocked();
 
   IsolateGroup* isolate_group_;
 
   Monitor monitor_;  // Controls access to the queue and running state.
   BackgroundCompilationQueue* function_queue_;
+  BackgroundCompilationQueue* compiling_queue_;  // Functions being compiled.
   bool running_;            // While true, will try to read queue and compile.
-  bool done_;               // True if the thread is done.
+  intptr_t running_tasks_;  // Number of threads which have not finished yet.
   int16_t disabled_depth_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(BackgroundCompiler);
@@ -16,6 +16,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, background_compiler_tasks);
+
 ISOLATE_UNIT_TEST_CASE(CompileFunction) {
   const char* kScriptChars =
       "class A {\n"
@@ -100,6 +102,62 @@ ISOLATE_UNIT_TEST_CASE(OptimizeCompileFunctionOnHelperThread) {
   delete m;
 }
 
+ISOLATE_UNIT_TEST_CASE(OptimizeCompileFunctionsOnHelperThreads) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo() { return 42; }\n"
+      "  static bar() { return 43; }\n"
+      "  static baz() { return 44; }\n"
+      "}\n";
+  Dart_Handle library;
+  {
+    TransitionVMToNative transition(thread);
+    library = TestCase::LoadTestScript(kScriptChars, NULL);
+  }
+  const Library& lib =
+      Library::Handle(Library::RawCast(Api::UnwrapHandle(library)));
+  EXPECT(ClassFinalizer::ProcessPendingClasses());
+  Class& cls =
+      Class::Handle(lib.LookupClass(String::Handle(Symbols::New(thread, "A"))));
+  EXPECT(!cls.IsNull());
+  const auto& error = cls.EnsureIsFinalized(thread);
+  EXPECT(error == Error::null());
+  const char* kFunctionNames[] = {"foo", "bar", "baz"};
+  const intptr_t kFunctionCount = ARRAY_SIZE(kFunctionNames);
+  const Array& functions = Array::Handle(Array::New(kFunctionCount));
+  Function& func = Function::Handle();
+  for (intptr_t i = 0; i < kFunctionCount; i++) {
+    func = cls.LookupStaticFunction(
+        String::Handle(String::New(kFunctionNames[i])));
+    EXPECT(!func.IsNull());
+    CompilerTest::TestCompileFunction(func);
+    EXPECT(func.HasCode());
+    EXPECT(!func.HasOptimizedCode());
+    functions.SetAt(i, func);
+  }
+#if !defined(PRODUCT)
+  // Constant in product mode.
+  FLAG_background_compilation = true;
+#endif
+  SetFlagScope<int> sfs(&FLAG_background_compiler_tasks, 2);
+  auto isolate_group = thread->isolate_group();
+  for (intptr_t i = 0; i < kFunctionCount; i++) {
+    func ^= functions.At(i);
+    // Different hotness takes the functions off the queue out of order.
+    func.SetUsageCounter(kMinInt32 + i);
+    EXPECT(isolate_group->background_compiler()->EnqueueCompilation(func));
+  }
+  Monitor* m = new Monitor();
+  for (intptr_t i = 0; i < kFunctionCount; i++) {
+    func ^= functions.At(i);
+    SafepointMonitorLocker ml(m);
+    while (!func.HasOptimizedCode()) {
+      ml.Wait(1);
+    }
+  }
+  delete m;
+}
+
 ISOLATE_UNIT_TEST_CASE(CompileFunctionOnHelperThread) {
   // Create a simple function and compile it without optimization.
   const char* kScriptChars =
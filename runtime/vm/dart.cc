@@ -38,6 +38,7 @@
 #include "vm/simulator.h"
 #include "vm/snapshot.h"
 #include "vm/stack_frame.h"
+#include "vm/startup_trace.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
 #include "vm/thread_interrupter.h"
@@ -304,6 +305,7 @@ char* Dart::DartInit(const uint8_t* vm_isolate_snapshot,
   Timeline::Init();
   TimelineBeginEndScope tbes(Timeline::GetVMStream(), "Dart::Init");
 #endif
+  StartupTrace::Init();
   IsolateGroup::Init();
   Isolate::InitVM();
   PortMap::Init();
@@ -775,6 +777,7 @@ char* Dart::Cleanup() {
   Object::Cleanup();
   SemiSpace::Cleanup();
   StubCode::Cleanup();
+  StartupTrace::Cleanup();
 #if defined(SUPPORT_TIMELINE)
   if (FLAG_trace_shutdown) {
     OS::PrintErr("[+%" Pd64 "ms] SHUTDOWN: Shutting down timeline\n",
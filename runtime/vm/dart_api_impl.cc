@@ -4001,6 +4001,89 @@ Dart_NewExternalTypedDataWithFinalizer(Dart_TypedData_Type type,
   return Api::Null();
 }
 
+// Owns the memory of a typed data object created by Dart_NewSharedTypedData.
+struct SharedTypedDataPeer {
+  IsolateGroup* isolate_group;
+  void* data;
+  FinalizablePersistentHandle* handle;
+};
+
+static void FinalizeSharedTypedData(void* isolate_callback_data, void* peer) {
+  auto shared = reinterpret_cast<SharedTypedDataPeer*>(peer);
+  shared->isolate_group->RemoveSharedTypedData(shared->data);
+  free(shared->data);
+  delete shared;
+}
+
+static intptr_t ExternalTypedDataCidFor(Dart_TypedData_Type type) {
+  switch (type) {
+    case Dart_TypedData_kInt8:
+      return kExternalTypedDataInt8ArrayCid;
+    case Dart_TypedData_kUint8:
+      return kExternalTypedDataUint8ArrayCid;
+    case Dart_TypedData_kUint8Clamped:
+      return kExternalTypedDataUint8ClampedArrayCid;
+    case Dart_TypedData_kInt16:
+      return kExternalTypedDataInt16ArrayCid;
+    case Dart_TypedData_kUint16:
+      return kExternalTypedDataUint16ArrayCid;
+    case Dart_TypedData_kInt32:
+      return kExternalTypedDataInt32ArrayCid;
+    case Dart_TypedData_kUint32:
+      return kExternalTypedDataUint32ArrayCid;
+    case Dart_TypedData_kInt64:
+      return kExternalTypedDataInt64ArrayCid;
+    case Dart_TypedData_kUint64:
+      return kExternalTypedDataUint64ArrayCid;
+    case Dart_TypedData_kFloat32:
+      return kExternalTypedDataFloat32ArrayCid;
+    case Dart_TypedData_kFloat64:
+      return kExternalTypedDataFloat64ArrayCid;
+    case Dart_TypedData_kInt32x4:
+      return kExternalTypedDataInt32x4ArrayCid;
+    case Dart_TypedData_kFloat32x4:
+      return kExternalTypedDataFloat32x4ArrayCid;
+    case Dart_TypedData_kFloat64x2:
+      return kExternalTypedDataFloat64x2ArrayCid;
+    default:
+      return kIllegalCid;
+  }
+}
+
+DART_EXPORT Dart_Handle Dart_NewSharedTypedData(Dart_TypedData_Type type,
+                                                intptr_t length) {
+  DARTSCOPE(Thread::Current());
+  CHECK_CALLBACK_STATE(T);
+  const intptr_t cid = ExternalTypedDataCidFor(type);
+  if (cid == kIllegalCid) {
+    return Api::NewError(
+        "%s expects argument 'type' to be of 'external TypedData'",
+        CURRENT_FUNC);
+  }
+  CHECK_LENGTH(length, ExternalTypedData::MaxElements(cid));
+  const intptr_t size = length * ExternalTypedData::ElementSizeInBytes(cid);
+  // Zero-length buffers still get a distinct address.
+  void* data = calloc(size > 0 ? size : 1, 1);
+  if (data == nullptr) {
+    return Api::NewError("%s: Out of memory", CURRENT_FUNC);
+  }
+  Dart_Handle result = NewExternalTypedData(T, cid, data, length, nullptr, 0,
+                                            nullptr);
+  if (Api::IsError(result)) {
+    free(data);
+    return result;
+  }
+  // The object is only shared once the finalizer is attached, so its data
+  // cannot be freed while any isolate of the group can reach it.
+  auto peer = new SharedTypedDataPeer{T->isolate_group(), data, nullptr};
+  const auto& obj = Object::Handle(Z, Api::UnwrapHandle(result));
+  peer->handle = FinalizablePersistentHandle::New(
+      T->isolate_group(), obj, peer, &FinalizeSharedTypedData, size,
+      /*auto_delete=*/true);
+  T->isolate_group()->AddSharedTypedData(data, peer->handle);
+  return result;
+}
+
 static ObjectPtr GetByteBufferConstructor(Thread* thread,
                                           const String& class_name,
                                           const String& constructor_name,
@@ -5720,6 +5803,12 @@ DART_EXPORT Dart_Handle Dart_GetLoadedLibraries() {
   DARTSCOPE(Thread::Current());
   auto IG = T->isolate_group();
 
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  // Library handles given to the embedder are always loaded, so that
+  // lookups in them never have to report a loading error.
+  CHECK_ERROR_HANDLE(kernel::KernelLoader::LoadPendingLibraries());
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
   const GrowableObjectArray& libs =
       GrowableObjectArray::Handle(Z, IG->object_store()->libraries());
   int num_libs = libs.Length();
@@ -5746,9 +5835,15 @@ DART_EXPORT Dart_Handle Dart_LookupLibrary(Dart_Handle url) {
   if (library.IsNull()) {
     return Api::NewError("%s: library '%s' not found.", CURRENT_FUNC,
                          url_str.ToCString());
-  } else {
-    return Api::NewHandle(T, library.ptr());
   }
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  const Error& error =
+      Error::Handle(Z, kernel::KernelLoader::EnsureLibraryLoaded(library));
+  if (!error.IsNull()) {
+    return Api::NewHandle(T, error.ptr());
+  }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+  return Api::NewHandle(T, library.ptr());
 }
 
 DART_EXPORT Dart_Handle Dart_LibraryHandleError(Dart_Handle library_in,
@@ -6875,6 +6970,13 @@ Dart_CreateAppJITSnapshotAsBlobs(uint8_t** isolate_snapshot_data_buffer,
   CHECK_NULL(isolate_snapshot_instructions_buffer);
   CHECK_NULL(isolate_snapshot_instructions_size);
 
+  // The snapshot has to contain the libraries whose loading was deferred.
+  const Error& error =
+      Error::Handle(Z, kernel::KernelLoader::LoadPendingLibraries());
+  if (!error.IsNull()) {
+    return Api::NewHandle(T, error.ptr());
+  }
+
   // Finalize all classes if needed.
   Dart_Handle state = Api::CheckAndFinalizePendingClasses(T);
   if (Api::IsError(state)) {
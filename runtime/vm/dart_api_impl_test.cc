@@ -17,7 +17,9 @@
 #include "vm/dart_api_state.h"
 #include "vm/debugger_api_impl_test.h"
 #include "vm/heap/verifier.h"
+#include "vm/kernel_loader.h"
 #include "vm/lockers.h"
+#include "vm/object_graph_copy.h"
 #include "vm/timeline.h"
 #include "vm/unit_test.h"
 
@@ -25,6 +27,8 @@ namespace dart {
 
 DECLARE_FLAG(bool, verify_acquired_data);
 DECLARE_FLAG(bool, complete_timeline);
+DECLARE_FLAG(bool, lazy_load_kernel_libraries);
+DECLARE_FLAG(int, kernel_loader_tasks);
 
 #ifndef PRODUCT
 
@@ -2951,6 +2955,38 @@ TEST_CASE(DartAPI_ExternalTypedDataCallback) {
   }
 }
 
+TEST_CASE(DartAPI_SharedTypedData) {
+  Dart_Handle shared = Dart_NewSharedTypedData(Dart_TypedData_kInt32, 16);
+  EXPECT_VALID(shared);
+  EXPECT_EQ(Dart_TypedData_kInt32, Dart_GetTypeOfExternalTypedData(shared));
+  EXPECT_ERROR(Dart_NewSharedTypedData(Dart_TypedData_kByteData, 16),
+               "expects argument 'type' to be of 'external TypedData'");
+
+  void* data = nullptr;
+  Dart_TypedData_Type type;
+  intptr_t length = 0;
+  EXPECT_VALID(Dart_TypedDataAcquireData(shared, &type, &data, &length));
+  EXPECT_VALID(Dart_TypedDataReleaseData(shared));
+  // An alias of the shared data does not keep it alive, so it is not shared.
+  Dart_Handle alias =
+      Dart_NewExternalTypedData(Dart_TypedData_kInt32, data, length);
+  EXPECT_VALID(alias);
+  {
+    TransitionNativeToVM transition(thread);
+    // Shared typed data is passed by reference, other external typed data is
+    // copied.
+    const auto& obj = Object::Handle(Api::UnwrapHandle(shared));
+    auto& copy = Array::Handle(Array::RawCast(CopyMutableObjectGraph(obj)));
+    EXPECT(copy.At(0) == obj.ptr());
+    EXPECT(thread->isolate_group()->IsSharedTypedData(obj.ptr()));
+
+    const auto& other = Object::Handle(Api::UnwrapHandle(alias));
+    copy = Array::RawCast(CopyMutableObjectGraph(other));
+    EXPECT(copy.At(0) != other.ptr());
+    EXPECT(!thread->isolate_group()->IsSharedTypedData(other.ptr()));
+  }
+}
+
 static void SlowFinalizer(void* isolate_callback_data, void* peer) {
   OS::Sleep(10);
   intptr_t* count = reinterpret_cast<intptr_t*>(peer);
@@ -7686,6 +7722,123 @@ TEST_CASE(DartAPI_ImportLibrary2) {
   EXPECT_VALID(result);
 }
 
+static Dart_Handle LoadLazyLibraryTestScript() {
+  const char* kScriptChars =
+      "import 'library1_dart';\n"
+      "main() => compute();\n";
+  const char* kLibrary1Chars =
+      "library library1_dart;\n"
+      "class A { int get value => 42; }\n"
+      "int compute() => new A().value;\n";
+  Dart_SourceFile sourcefiles[] = {
+      {RESOLVED_USER_TEST_URI, kScriptChars},
+      {"file:///library1_dart", kLibrary1Chars},
+  };
+  int sourcefiles_count = sizeof(sourcefiles) / sizeof(Dart_SourceFile);
+  return TestCase::LoadTestScriptWithDFE(sourcefiles_count, sourcefiles, NULL,
+                                         true);
+}
+
+TEST_CASE(DartAPI_LazyLoadKernelLibraries) {
+  SetFlagScope<bool> sfs(&FLAG_lazy_load_kernel_libraries, true);
+  Dart_Handle lib = LoadLazyLibraryTestScript();
+  EXPECT_VALID(lib);
+
+  {
+    TransitionNativeToVM transition(thread);
+    const Library& library1 = Library::Handle(Library::LookupLibrary(
+        thread, String::Handle(String::New("file:///library1_dart"))));
+    EXPECT(!library1.IsNull());
+    EXPECT(kernel::KernelLoader::IsLibraryLoadingDeferred(library1));
+  }
+
+  // The imported library is loaded when main is compiled.
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(42, value);
+
+  {
+    TransitionNativeToVM transition(thread);
+    const Library& library1 = Library::Handle(Library::LookupLibrary(
+        thread, String::Handle(String::New("file:///library1_dart"))));
+    EXPECT(library1.Loaded());
+  }
+}
+
+TEST_CASE(DartAPI_LazyLoadKernelLibrariesOnLookup) {
+  SetFlagScope<bool> sfs(&FLAG_lazy_load_kernel_libraries, true);
+  EXPECT_VALID(LoadLazyLibraryTestScript());
+
+  TransitionNativeToVM transition(thread);
+  const Library& library1 = Library::Handle(Library::LookupLibrary(
+      thread, String::Handle(String::New("file:///library1_dart"))));
+  EXPECT(kernel::KernelLoader::IsLibraryLoadingDeferred(library1));
+
+  // Looking a name up in the library loads it.
+  String& name = String::Handle(Symbols::New(thread, "A"));
+  const Class& cls = Class::Handle(library1.LookupLocalClass(name));
+  EXPECT(!cls.IsNull());
+  EXPECT(library1.Loaded());
+  EXPECT(cls.is_declaration_loaded());
+  name = Symbols::New(thread, "compute");
+  EXPECT(!Function::Handle(library1.LookupLocalFunction(name)).IsNull());
+}
+
+TEST_CASE(DartAPI_LazyLoadKernelLibrariesRequestedByCompiler) {
+  SetFlagScope<bool> sfs(&FLAG_lazy_load_kernel_libraries, true);
+  EXPECT_VALID(LoadLazyLibraryTestScript());
+
+  TransitionNativeToVM transition(thread);
+  const Library& library1 = Library::Handle(Library::LookupLibrary(
+      thread, String::Handle(String::New("file:///library1_dart"))));
+  EXPECT(kernel::KernelLoader::IsLibraryLoadingDeferred(library1));
+
+  // Background compilations record the libraries they could not load.
+  ObjectStore* object_store = thread->isolate_group()->object_store();
+  const GrowableObjectArray& requests =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  requests.Add(library1);
+  object_store->set_lazy_library_load_requests(requests);
+
+  EXPECT(Error::Handle(kernel::KernelLoader::LoadLibrariesRequestedByCompiler())
+             .IsNull());
+  EXPECT(library1.Loaded());
+  EXPECT(object_store->lazy_library_load_requests() ==
+         GrowableObjectArray::null());
+}
+
+TEST_CASE(DartAPI_InternCanonicalNamesInParallel) {
+  // Enough declarations for the canonical name table to be split between
+  // several helper threads.
+  const intptr_t kClassCount = 500;
+  TextBuffer buffer(64 * KB);
+  for (intptr_t i = 0; i < kClassCount; i++) {
+    buffer.Printf("class C%" Pd " { int get value%" Pd " => %" Pd
+                  "; set value%" Pd "(int v) {} }\n",
+                  i, i, i, i);
+  }
+  buffer.Printf("main() => new C%" Pd "().value%" Pd ";\n", kClassCount - 1,
+                kClassCount - 1);
+  SetFlagScope<int> sfs(&FLAG_kernel_loader_tasks, 4);
+
+  Dart_Handle lib = TestCase::LoadTestScript(buffer.buffer(), NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(kClassCount - 1, value);
+
+  {
+    TransitionNativeToVM transition(thread);
+    const String& name = String::Handle(String::New("value0"));
+    EXPECT(!String::Handle(Symbols::LookupFromGet(thread, name)).IsNull());
+    EXPECT(!String::Handle(Symbols::LookupFromSet(thread, name)).IsNull());
+  }
+}
+
 // Test that if the same name is imported from two libraries, it is
 // an error if that name is referenced.
 TEST_CASE(DartAPI_ImportLibrary3) {
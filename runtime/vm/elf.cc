@@ -7,6 +7,7 @@
 #include "platform/elf.h"
 #include "vm/cpu.h"
 #include "vm/dwarf.h"
+#include "vm/flags.h"
 #include "vm/hash_map.h"
 #include "vm/image_snapshot.h"
 #include "vm/stack_frame.h"
@@ -17,6 +18,13 @@ namespace dart {
 
 #if defined(DART_PRECOMPILER)
 
+DEFINE_FLAG(bool,
+            elf_huge_page_aligned_text,
+            false,
+            "Align the executable segments of ELF snapshots in memory and in "
+            "the file to the huge page size, so that the loaded code can be "
+            "backed by (transparent) huge pages.");
+
 // A wrapper around BaseWriteStream that provides methods useful for
 // writing ELF files (e.g., using ELF definitions of data sizes).
 class ElfWriteStream : public ValueObject {
@@ -39,8 +47,17 @@ class ElfWriteStream : public ValueObject {
   intptr_t Position() const { return stream_->Position() - start_; }
   void Align(const intptr_t alignment) {
     ASSERT(Utils::IsPowerOfTwo(alignment));
-    ASSERT(alignment <= Elf::kPageSize);
-    stream_->Align(alignment);
+    if (alignment <= Elf::kPageSize) {
+      stream_->Align(alignment);
+      return;
+    }
+    // Larger alignments are relative to the start of the ELF content, which
+    // is only page-aligned in the underlying stream.
+    ASSERT(alignment == Elf::kHugePageSize);
+    const intptr_t padding = Utils::RoundUp(Position(), alignment) - Position();
+    for (intptr_t i = 0; i < padding; i++) {
+      stream_->WriteByte(0);
+    }
   }
   void WriteBytes(const uint8_t* b, intptr_t size) {
     stream_->WriteBytes(b, size);
@@ -276,6 +293,9 @@ class Segment : public ZoneAllocated {
   intptr_t Alignment() const {
     switch (type) {
       case elf::ProgramHeaderType::PT_LOAD:
+        if (IsExecutable() && FLAG_elf_huge_page_aligned_text) {
+          return Elf::kHugePageSize;
+        }
         return Elf::kPageSize;
       case elf::ProgramHeaderType::PT_PHDR:
       case elf::ProgramHeaderType::PT_DYNAMIC:
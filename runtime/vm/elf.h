@@ -38,6 +38,11 @@ class Elf : public ZoneAllocated {
   // and no ELF section or segment should have a larger alignment.
   static constexpr intptr_t kPageSize = 16 * KB;
 
+  // The huge page size on all supported architectures. Executable load
+  // segments are aligned to it with --elf_huge_page_aligned_text, which is
+  // the only exception to the limit above.
+  static constexpr intptr_t kHugePageSize = 2 * MB;
+
   bool IsStripped() const { return dwarf_ == nullptr; }
 
   Zone* zone() const { return zone_; }
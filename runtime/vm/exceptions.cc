@@ -1034,6 +1034,12 @@ void Exceptions::ThrowUnsupportedError(const char* msg) {
   Exceptions::ThrowByType(Exceptions::kUnsupported, args);
 }
 
+void Exceptions::ThrowStateError(const char* msg) {
+  const Array& args = Array::Handle(Array::New(1));
+  args.SetAt(0, String::Handle(String::New(msg)));
+  Exceptions::ThrowByType(Exceptions::kState, args);
+}
+
 void Exceptions::ThrowCompileTimeError(const LanguageError& error) {
   const Array& args = Array::Handle(Array::New(1));
   args.SetAt(0, String::Handle(error.FormatMessage()));
@@ -1151,6 +1157,10 @@ ObjectPtr Exceptions::Create(ExceptionType type, const Array& arguments) {
       class_name = &Symbols::LateError();
       constructor_name = &Symbols::DotFieldNI();
       break;
+    case kState:
+      library = Library::CoreLibrary();
+      class_name = &Symbols::StateError();
+      break;
   }
 
   return DartLibraryCalls::InstanceCreate(library, *class_name,
@@ -72,6 +72,7 @@ class Exceptions : AllStatic {
     kCompileTimeError,
     kLateFieldAssignedDuringInitialization,
     kLateFieldNotInitialized,
+    kState,
   };
 
   DART_NORETURN static void ThrowByType(ExceptionType type,
@@ -86,6 +87,7 @@ class Exceptions : AllStatic {
                                             intptr_t expected_from,
                                             intptr_t expected_to);
   DART_NORETURN static void ThrowUnsupportedError(const char* msg);
+  DART_NORETURN static void ThrowStateError(const char* msg);
   DART_NORETURN static void ThrowCompileTimeError(const LanguageError& error);
   DART_NORETURN static void ThrowLateFieldAssignedDuringInitialization(
       const String& name);
@@ -272,6 +272,8 @@ intptr_t ImageWriter::SizeInSnapshot(ObjectPtr raw_object) {
       return compiler::target::String::InstanceSize(
           String::LengthOf(raw_str) * TwoByteString::kBytesPerElement);
     }
+    case kDoubleCid:
+      return compiler::target::Double::InstanceSize();
     default: {
       const Class& clazz = Class::Handle(Object::Handle(raw_object).clazz());
       FATAL("Unsupported class %s in rodata section.\n", clazz.ToCString());
@@ -332,6 +334,14 @@ void ImageWriter::DumpInstructionStats() {
     CodeStatistics* stats = data.insns_->stats();
     if (stats != nullptr) {
       stats->AppendTo(instruction_stats.get());
+      if ((data.code_ != nullptr) &&
+          (stats->spill_count() + stats->reload_count() > 0)) {
+        instruction_stats->AddSpillingFunction(
+            data.code_->QualifiedName(
+                NameFormattingParams::DisambiguatedWithoutClassName(
+                    Object::kInternalName)),
+            stats->spill_count(), stats->reload_count());
+      }
     }
   }
   instruction_stats->DumpStatistics();
@@ -533,6 +543,12 @@ void ImageWriter::WriteROData(NonStreamingWriteStream* stream, bool vm) {
           str.Length() * (str.IsOneByteString()
                               ? OneByteString::kBytesPerElement
                               : TwoByteString::kBytesPerElement));
+    } else if (obj.IsDouble()) {
+      ASSERT(obj.IsCanonical());
+      stream->Align(sizeof(double));
+      ASSERT_EQUAL(stream->Position() - object_start,
+                   compiler::target::Double::value_offset());
+      stream->WriteFixed(Double::Cast(obj).value());
     } else {
       const Class& clazz = Class::Handle(obj.clazz());
       FATAL("Unsupported class %s in rodata section.\n", clazz.ToCString());
@@ -38,6 +38,7 @@
 #include "vm/os_thread.h"
 #include "vm/port.h"
 #include "vm/profiler.h"
+#include "vm/profiler_service.h"
 #include "vm/reusable_handles.h"
 #include "vm/reverse_pc_lookup_cache.h"
 #include "vm/service.h"
@@ -54,6 +55,7 @@
 #include "vm/visitor.h"
 
 #if !defined(DART_PRECOMPILED_RUNTIME)
+#include "vm/compiler/aot/aot_profile.h"
 #include "vm/compiler/assembler/assembler.h"
 #include "vm/compiler/stub_code_compiler.h"
 #endif
@@ -103,6 +105,26 @@ DEFINE_FLAG(bool,
             "Disables the limit of the thread pool (simulates custom embedder "
             "with custom message handler on unlimited number of threads).");
 
+DEFINE_FLAG(int,
+            message_queue_high_water_mark,
+            0,
+            "Maximum number of pending normal priority messages per isolate "
+            "before sending to it fails (0 means unbounded). System isolates "
+            "are not limited.");
+DEFINE_FLAG(int,
+            message_queue_high_water_mark_kb,
+            0,
+            "Maximum size in KB of pending normal priority messages per "
+            "isolate before sending to it fails (0 means unbounded). System "
+            "isolates are not limited.");
+
+DEFINE_FLAG(charp,
+            write_aot_profile_to,
+            nullptr,
+            "Write the type feedback collected by the JIT, or the functions "
+            "sampled by the profiler in the AOT runtime, to the given file "
+            "when an isolate exits, for use with --use_aot_profile.");
+
 // Quick access to the locally defined thread() and isolate() methods.
 #define T (thread())
 #define I (isolate())
@@ -802,6 +824,9 @@ void IsolateGroup::PrintToJSONObject(JSONObject* jsobj, bool ref) {
       isolate_array.AddValue(isolate, /*ref=*/true);
     }
   }
+  if (thread_pool_ != nullptr) {
+    thread_pool_->PrintJSON(jsobj);
+  }
 }
 
 void IsolateGroup::PrintMemoryUsageJSON(JSONStream* stream) {
@@ -819,6 +844,36 @@ void IsolateGroup::PrintMemoryUsageJSON(JSONStream* stream) {
 }
 #endif
 
+void IsolateGroup::AddSharedTypedData(void* data,
+                                      FinalizablePersistentHandle* handle) {
+  MutexLocker ml(&shared_typed_data_mutex_);
+  shared_typed_data_.Insert({data, handle});
+  num_shared_typed_data_++;
+}
+
+void IsolateGroup::RemoveSharedTypedData(void* data) {
+  MutexLocker ml(&shared_typed_data_mutex_);
+  if (!shared_typed_data_.Remove(data)) {
+    UNREACHABLE();
+  }
+  num_shared_typed_data_--;
+}
+
+bool IsolateGroup::IsSharedTypedData(ObjectPtr obj) {
+  if (num_shared_typed_data_ == 0) {
+    return false;
+  }
+  ASSERT(IsExternalTypedDataClassId(obj->GetClassId()));
+  void* data = static_cast<ExternalTypedDataPtr>(obj)->untag()->data_;
+  // The handles are updated by the GC, which cannot run concurrently with
+  // the caller, and finalized ones are removed before the GC completes.
+  // Other external typed data may wrap the same memory, so the object has
+  // to be the registered one.
+  MutexLocker ml(&shared_typed_data_mutex_);
+  FinalizablePersistentHandle* handle = shared_typed_data_.LookupValue(data);
+  return (handle != nullptr) && (handle->ptr() == obj);
+}
+
 void IsolateGroup::ForEach(std::function<void(IsolateGroup*)> action) {
   ReadRwLocker wl(Thread::Current(), isolate_groups_rwlock_);
   for (auto isolate_group : *isolate_groups_) {
@@ -1334,8 +1389,15 @@ MessageHandler::MessageStatus IsolateMessageHandler::HandleMessage(
   TimelineBeginEndScope tbes(
       thread, Timeline::GetIsolateStream(),
       message->IsOOB() ? "HandleOOBMessage" : "HandleMessage");
-  tbes.SetNumArguments(1);
-  tbes.CopyArgument(0, "isolateName", I->name());
+  if (message->posted_micros() != 0) {
+    tbes.SetNumArguments(2);
+    tbes.CopyArgument(0, "isolateName", I->name());
+    tbes.FormatArgument(1, "queueWaitMicros", "%" Pd64,
+                        message->dequeued_micros() - message->posted_micros());
+  } else {
+    tbes.SetNumArguments(1);
+    tbes.CopyArgument(0, "isolateName", I->name());
+  }
 #endif
 
   // Parse the message.
@@ -1835,6 +1897,13 @@ Isolate* Isolate::InitIsolate(const char* name_prefix,
   // Setup the isolate message handler.
   MessageHandler* handler = new IsolateMessageHandler(result);
   ASSERT(handler != nullptr);
+  // The service and kernel isolates must keep working however much traffic
+  // other isolates generate.
+  if (!Isolate::IsSystemIsolate(result)) {
+    handler->SetQueueHighWaterMarks(
+        FLAG_message_queue_high_water_mark,
+        FLAG_message_queue_high_water_mark_kb * static_cast<intptr_t>(KB));
+  }
   result->set_message_handler(handler);
 
   result->set_main_port(PortMap::CreatePort(result->message_handler()));
@@ -2543,6 +2612,15 @@ void Isolate::Shutdown() {
     StackZone zone(thread);
     HandleScope handle_scope(thread);
     ServiceIsolate::SendIsolateShutdownMessage();
+    if (!Isolate::IsSystemIsolate(this)) {
+#if !defined(DART_PRECOMPILED_RUNTIME)
+      AotProfile::WriteIfRequested(thread);
+#elif !defined(PRODUCT)
+      if (FLAG_write_aot_profile_to != nullptr) {
+        ProfilerService::WriteAotProfile(thread, FLAG_write_aot_profile_to);
+      }
+#endif
+    }
 #if !defined(PRODUCT)
     debugger()->Shutdown();
     // Cleanup profiler state.
@@ -3120,6 +3198,7 @@ void Isolate::PrintJSON(JSONStream* stream, bool ref) {
     JSONObject tagCounters(&jsobj, "_tagCounters");
     vm_tag_counters()->PrintToJSONObject(&tagCounters);
   }
+  message_handler()->PrintLatencyJSON(&jsobj);
   if (Thread::Current()->sticky_error() != Object::null()) {
     Error& error = Error::Handle(Thread::Current()->sticky_error());
     ASSERT(!error.IsNull());
@@ -24,6 +24,7 @@
 #include "vm/fixed_cache.h"
 #include "vm/growable_array.h"
 #include "vm/handles.h"
+#include "vm/hash_map.h"
 #include "vm/heap/verifier.h"
 #include "vm/intrusive_dlist.h"
 #include "vm/megamorphic_cache_table.h"
@@ -52,6 +53,7 @@ class CodeIndexTable;
 class Debugger;
 class DeoptContext;
 class ExternalTypedData;
+class FinalizablePersistentHandle;
 class GroupDebugger;
 class HandleScope;
 class HandleVisitor;
@@ -176,6 +178,31 @@ typedef FixedCache<intptr_t, CatchEntryMovesRefPtr, 16> CatchEntryMovesCache;
 #define BOOL_ISOLATE_GROUP_FLAG_LIST_CUSTOM_GETTER(V)                          \
   V(PRODUCT, null_safety, NullSafety, null_safety, false)
 
+// Maps the data of typed data created by Dart_NewSharedTypedData to the
+// handle which finalizes it.
+class SharedTypedDataKeyValueTrait {
+ public:
+  typedef void* Key;
+  typedef FinalizablePersistentHandle* Value;
+
+  struct Pair {
+    Key key;
+    Value value;
+    Pair() : key(nullptr), value(nullptr) {}
+    Pair(const Key key, const Value& value) : key(key), value(value) {}
+    Pair(const Pair& other) = default;
+    Pair& operator=(const Pair&) = default;
+  };
+
+  static Key KeyOf(Pair kv) { return kv.key; }
+  static Value ValueOf(Pair kv) { return kv.value; }
+  // The data is allocated by malloc, so its low bits are always zero.
+  static uword Hash(Key key) {
+    return Utils::WordHash(reinterpret_cast<intptr_t>(key));
+  }
+  static bool IsKeyEqual(Pair kv, Key key) { return kv.key == key; }
+};
+
 // Represents the information used for spawning the first isolate within an
 // isolate group. All isolates within a group will refer to this
 // [IsolateGroupSource].
@@ -390,6 +417,11 @@ class IsolateGroup : public IntrusiveDListEntry<IsolateGroup> {
   void set_dispatch_table_snapshot_size(intptr_t size) {
     dispatch_table_snapshot_size_ = size;
   }
+  // Owns the dispatch table snapshot when it was copied out of a decompressed
+  // program snapshot.
+  void set_dispatch_table_snapshot_copy(std::unique_ptr<uint8_t[]> copy) {
+    dispatch_table_snapshot_copy_ = std::move(copy);
+  }
 
   SharedClassTable* shared_class_table() const {
     return shared_class_table_.get();
@@ -720,6 +752,15 @@ class IsolateGroup : public IntrusiveDListEntry<IsolateGroup> {
 
   ApiState* api_state() const { return api_state_.get(); }
 
+  // Typed data created by Dart_NewSharedTypedData, identified by the handle
+  // that finalizes it. Such an object is sent between isolates of the group
+  // by reference instead of being copied. The finalizer unregisters the
+  // object before freeing its data, so a registered object is always backed
+  // by live memory.
+  void AddSharedTypedData(void* data, FinalizablePersistentHandle* handle);
+  void RemoveSharedTypedData(void* data);
+  bool IsSharedTypedData(ObjectPtr obj);
+
   // Visit all object pointers. Caller must ensure concurrent sweeper is not
   // running, and the visitor must not allocate.
   void VisitObjectPointers(ObjectPointerVisitor* visitor,
@@ -876,6 +917,7 @@ class IsolateGroup : public IntrusiveDListEntry<IsolateGroup> {
   std::unique_ptr<DispatchTable> dispatch_table_;
   const uint8_t* dispatch_table_snapshot_ = nullptr;
   intptr_t dispatch_table_snapshot_size_ = 0;
+  std::unique_ptr<uint8_t[]> dispatch_table_snapshot_copy_;
   ArrayPtr saved_unlinked_calls_;
   std::shared_ptr<FieldTable> initial_field_table_;
   uint32_t isolate_group_flags_ = 0;
@@ -912,6 +954,13 @@ class IsolateGroup : public IntrusiveDListEntry<IsolateGroup> {
   // by multiple isolates and background compiler.
   std::unique_ptr<SafepointRwLock> program_lock_;
 
+  // Protects [shared_typed_data_].
+  Mutex shared_typed_data_mutex_;
+  // Maps the data of each shared typed data to its handle.
+  MallocDirectChainedHashMap<SharedTypedDataKeyValueTrait> shared_typed_data_;
+  // Allows the common case of no shared typed data to skip taking the mutex.
+  RelaxedAtomic<intptr_t> num_shared_typed_data_ = 0;
+
   // Allow us to ensure the number of active mutators is limited by a maximum.
   std::unique_ptr<Monitor> active_mutators_monitor_;
   intptr_t active_mutators_ = 0;
@@ -538,6 +538,20 @@ bool IsolateGroupReloadContext::Reload(bool force_reload,
   // Grab root library before calling CheckpointBeforeReload.
   GetRootLibUrl(root_script_url);
 
+  // Libraries whose loading was deferred are compared with the new program
+  // like any other library.
+  {
+    const auto& error =
+        Error::Handle(Z, kernel::KernelLoader::LoadPendingLibraries());
+    if (!error.IsNull()) {
+      TIR_Print("---- LOAD FAILED, ABORTING RELOAD\n");
+      AddReasonForCancelling(new Aborted(Z, error));
+      ReportReasonsForCancelling();
+      CommonFinalizeTail(num_old_libs_);
+      return false;
+    }
+  }
+
   std::unique_ptr<kernel::Program> kernel_program;
 
   // Reset stats.
@@ -7,6 +7,7 @@
 #include "platform/assert.h"
 #include "vm/globals.h"
 #include "vm/lockers.h"
+#include "vm/message_handler.h"
 #include "vm/thread_barrier.h"
 #include "vm/thread_pool.h"
 #include "vm/unit_test.h"
@@ -20,6 +21,40 @@ VM_UNIT_TEST_CASE(IsolateCurrent) {
   EXPECT_EQ(reinterpret_cast<Dart_Isolate>(NULL), Dart_CurrentIsolate());
 }
 
+// Sending to an isolate whose message queue is above its high-water mark
+// throws instead of dropping the message.
+TEST_CASE(Isolate_SendToFullQueueThrows) {
+  const char* kScriptChars = R"(
+    import 'dart:isolate';
+
+    int test() {
+      final port = RawReceivePort();
+      int sent = 0;
+      try {
+        for (int i = 0; i < 3; i++) {
+          port.sendPort.send(i);
+          sent++;
+        }
+      } on StateError {
+        // Expected.
+      }
+      port.close();
+      return sent;
+    }
+  )";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  MessageHandler* handler = Isolate::Current()->message_handler();
+  handler->SetQueueHighWaterMarks(2, 0);
+  Dart_Handle result = Dart_Invoke(lib, NewString("test"), 0, NULL);
+  handler->SetQueueHighWaterMarks(0, 0);
+  EXPECT_VALID(result);
+  int64_t sent = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &sent));
+  EXPECT_EQ(2, sent);
+  EXPECT_EQ(1, handler->rejected_messages());
+}
+
 // Test to ensure that an exception is thrown if no isolate creation
 // callback has been set by the embedder when an isolate is spawned.
 TEST_CASE(IsolateSpawn) {
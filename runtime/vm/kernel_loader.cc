@@ -12,6 +12,8 @@
 #include "vm/compiler/backend/flow_graph_compiler.h"
 #include "vm/compiler/frontend/constant_reader.h"
 #include "vm/compiler/frontend/kernel_translation_helper.h"
+#include "vm/compiler/jit/compiler.h"
+#include "vm/dart.h"
 #include "vm/dart_api_impl.h"
 #include "vm/flags.h"
 #include "vm/heap/heap.h"
@@ -23,8 +25,22 @@
 #include "vm/service_isolate.h"
 #include "vm/symbols.h"
 #include "vm/thread.h"
+#include "vm/thread_pool.h"
 
 namespace dart {
+
+DEFINE_FLAG(bool,
+            lazy_load_kernel_libraries,
+            false,
+            "Load only the main and dart: libraries of a JIT kernel program "
+            "eagerly and every other library when it is first referenced.");
+
+DEFINE_FLAG(int,
+            kernel_loader_tasks,
+            2,
+            "The number of helper threads which intern the names declared by "
+            "a kernel program while its libraries are loaded.");
+
 namespace kernel {
 
 #define Z (zone_)
@@ -497,6 +513,44 @@ KernelLoader::KernelLoader(const Script& script,
   H.InitFromKernelProgramInfo(kernel_program_info_);
 }
 
+KernelLoader::KernelLoader(const KernelProgramInfo& info, Program* program)
+    : program_(program),
+      thread_(Thread::Current()),
+      zone_(thread_->zone()),
+      no_active_isolate_scope_(),
+      patch_classes_(Array::ZoneHandle(zone_)),
+      active_class_(),
+      library_kernel_offset_(-1),  // Set to the correct value in LoadLibrary
+      kernel_binary_version_(program->binary_version()),
+      correction_offset_(-1),  // Set to the correct value in LoadLibrary
+      loading_native_wrappers_library_(false),
+      library_kernel_data_(ExternalTypedData::ZoneHandle(zone_)),
+      kernel_program_info_(KernelProgramInfo::ZoneHandle(zone_, info.ptr())),
+      translation_helper_(this, thread_, Heap::kOld),
+      helper_(zone_,
+              &translation_helper_,
+              program_->binary(),
+              /*data_program_offset=*/0),
+      constant_reader_(&helper_, &active_class_),
+      type_translator_(&helper_,
+                       &constant_reader_,
+                       &active_class_,
+                       /* finalize= */ false),
+      inferred_type_metadata_helper_(&helper_, &constant_reader_),
+      external_name_class_(Class::Handle(Z)),
+      external_name_field_(Field::Handle(Z)),
+      potential_natives_(GrowableObjectArray::Handle(Z)),
+      potential_pragma_functions_(GrowableObjectArray::Handle(Z)),
+      static_field_value_(Object::Handle(Z)),
+      pragma_class_(Class::Handle(Z)),
+      pragma_name_field_(Field::Handle(Z)),
+      pragma_options_field_(Field::Handle(Z)),
+      name_index_handle_(Smi::Handle(Z)),
+      expression_evaluation_library_(Library::Handle(Z)) {
+  ASSERT(program->is_single_program());
+  H.InitFromKernelProgramInfo(kernel_program_info_);
+}
+
 void KernelLoader::EvaluateDelayedPragmas() {
   potential_pragma_functions_ =
       kernel_program_info_.potential_pragma_functions();
@@ -615,6 +669,143 @@ bool KernelLoader::IsClassName(NameIndex name,
   return H.StringEquals(library_name_index, library.ToCString());
 }
 
+// Interns the names of the libraries, classes and public members declared by
+// a kernel program, so that loading the libraries finds them in the symbol
+// table instead of creating them. Private names are skipped since mangling
+// them requires their library. The canonical name table is split into
+// chunks which the loading thread and helper threads claim until none are
+// left; the symbol table supports concurrent insertion.
+class CanonicalNameInterner : public ValueObject {
+ public:
+  static constexpr intptr_t kChunkSize = 512;
+
+  CanonicalNameInterner(const KernelProgramInfo& info, intptr_t name_count)
+      : info_(info),
+        name_count_(name_count),
+        next_chunk_(0),
+        monitor_(),
+        pending_tasks_(0) {}
+
+  const KernelProgramInfo& info() const { return info_; }
+
+  void InternChunks(TranslationHelper* helper) {
+    while (true) {
+      const intptr_t start = next_chunk_.fetch_add(1) * kChunkSize;
+      if (start >= name_count_) {
+        return;
+      }
+      const intptr_t end = Utils::Minimum(start + kChunkSize, name_count_);
+      for (intptr_t i = start; i < end; i++) {
+        InternName(helper, NameIndex(i));
+      }
+    }
+  }
+
+  void AddTask() {
+    MonitorLocker ml(&monitor_);
+    pending_tasks_++;
+  }
+
+  void TaskDone() {
+    MonitorLocker ml(&monitor_);
+    pending_tasks_--;
+    ml.Notify();
+  }
+
+  void WaitForTasks(Thread* thread) {
+    MonitorLocker ml(&monitor_);
+    while (pending_tasks_ > 0) {
+      ml.WaitWithSafepointCheck(thread);
+    }
+  }
+
+ private:
+  static void InternName(TranslationHelper* helper, NameIndex name) {
+    if (helper->IsLibrary(name)) {
+      helper->DartSymbolPlain(helper->CanonicalNameString(name));
+    } else if (helper->IsPrivate(name) || helper->IsAdministrative(name)) {
+      return;
+    } else if (helper->IsClass(name)) {
+      helper->DartClassName(name);
+    } else if (helper->IsField(name)) {
+      helper->DartFieldName(name);
+    } else if (helper->IsGetter(name)) {
+      helper->DartGetterName(name);
+    } else if (helper->IsSetter(name)) {
+      helper->DartSetterName(name);
+    } else if (helper->IsMethod(name)) {
+      helper->DartMethodName(name);
+    }
+  }
+
+  const KernelProgramInfo& info_;
+  const intptr_t name_count_;
+  RelaxedAtomic<intptr_t> next_chunk_;
+  Monitor monitor_;
+  intptr_t pending_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(CanonicalNameInterner);
+};
+
+class InternCanonicalNamesTask : public ThreadPool::Task {
+ public:
+  InternCanonicalNamesTask(IsolateGroup* isolate_group,
+                           CanonicalNameInterner* interner)
+      : isolate_group_(isolate_group), interner_(interner) {}
+
+  virtual void Run() {
+    // Allocating symbols requires participating in safepoint operations.
+    if (Thread::EnterIsolateGroupAsHelper(isolate_group_, Thread::kUnknownTask,
+                                          /*bypass_safepoint=*/false)) {
+      Thread* thread = Thread::Current();
+      {
+        StackZone stack_zone(thread);
+        HANDLESCOPE(thread);
+        TranslationHelper helper(thread);
+        helper.InitFromKernelProgramInfo(interner_->info());
+        interner_->InternChunks(&helper);
+      }
+      Thread::ExitIsolateGroupAsHelper(/*bypass_safepoint=*/false);
+    }
+    interner_->TaskDone();
+  }
+
+ private:
+  IsolateGroup* isolate_group_;
+  CanonicalNameInterner* interner_;
+
+  DISALLOW_COPY_AND_ASSIGN(InternCanonicalNamesTask);
+};
+
+void KernelLoader::InternCanonicalNames() {
+  // Obfuscation renames symbols as they are created, which has to happen in
+  // the order of loading to be deterministic.
+  if (IG->obfuscate()) {
+    return;
+  }
+  const intptr_t name_count = H.canonical_names().LengthInBytes() / 8;
+  const intptr_t num_chunks =
+      Utils::RoundUp(name_count, CanonicalNameInterner::kChunkSize) /
+      CanonicalNameInterner::kChunkSize;
+  // Small programs are not worth starting helper threads for.
+  const intptr_t num_tasks =
+      Utils::Minimum<intptr_t>(FLAG_kernel_loader_tasks, num_chunks - 1);
+  if (num_tasks <= 0) {
+    return;
+  }
+
+  TIMELINE_DURATION(thread_, Isolate, "InternCanonicalNames");
+  CanonicalNameInterner interner(kernel_program_info_, name_count);
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    interner.AddTask();
+    if (!Dart::thread_pool()->Run<InternCanonicalNamesTask>(IG, &interner)) {
+      interner.TaskDone();
+    }
+  }
+  interner.InternChunks(&H);
+  interner.WaitForTasks(thread_);
+}
+
 ObjectPtr KernelLoader::LoadProgram(bool process_pending_classes) {
   SafepointWriteRwLocker ml(thread_, thread_->isolate_group()->program_lock());
   ASSERT(kernel_program_info_.constants() == Array::null());
@@ -629,8 +820,25 @@ ObjectPtr KernelLoader::LoadProgram(bool process_pending_classes) {
   if (setjmp(*jump.Set()) == 0) {
     // Note that `problemsAsJson` on Component is implicitly skipped.
     const intptr_t length = program_->library_count();
-    for (intptr_t i = 0; i < length; i++) {
-      LoadLibrary(i);
+    if (CanLoadLibrariesLazily()) {
+      // Only the main library and the platform libraries are loaded now.
+      // Every other library is loaded when it is first referenced, see
+      // [EnsureLibraryLoaded].
+      const NameIndex main_library = H.EnclosingName(program_->main_method());
+      for (intptr_t i = 0; i < length; i++) {
+        if (library_canonical_name(i) == main_library ||
+            LibraryUri(i).StartsWith(Symbols::DartScheme())) {
+          LoadLibrary(i);
+        } else {
+          DeferLibraryLoading(i);
+        }
+      }
+      IG->object_store()->set_lazy_kernel_program_info(kernel_program_info_);
+    } else {
+      InternCanonicalNames();
+      for (intptr_t i = 0; i < length; i++) {
+        LoadLibrary(i);
+      }
     }
 
     // Finalize still pending classes if requested.
@@ -670,6 +878,169 @@ ObjectPtr KernelLoader::LoadProgram(bool process_pending_classes) {
   return Thread::Current()->StealStickyError();
 }
 
+bool KernelLoader::CanLoadLibrariesLazily() {
+  if (!FLAG_lazy_load_kernel_libraries || FLAG_precompiled_mode) {
+    return false;
+  }
+  // Reloads compare the libraries of the old and the new program, so the
+  // new program is always loaded completely.
+  if (IG->IsReloading() || program_->main_method() == -1) {
+    return false;
+  }
+  // Deferred libraries are loaded from the kernel blob later, so it has to
+  // be retained by the program. Only one program can have deferred
+  // libraries at a time.
+  return (program_->typed_data() != nullptr) &&
+         (IG->object_store()->lazy_kernel_program_info() ==
+          KernelProgramInfo::null());
+}
+
+void KernelLoader::DeferLibraryLoading(intptr_t index) {
+  const intptr_t kernel_offset = library_offset(index);
+  ASSERT(kernel_offset > 0);
+  const Library& library =
+      Library::Handle(Z, LookupLibrary(library_canonical_name(index)));
+  if (library.LoadNotStarted()) {
+    // The offset of the library in the program identifies it when it is
+    // loaded, see [LibraryIndexAt].
+    library.set_kernel_offset(kernel_offset);
+    library.SetLoadRequested();
+  }
+}
+
+intptr_t KernelLoader::LibraryIndexAt(intptr_t kernel_offset) {
+  // Libraries are laid out in order in the program.
+  intptr_t low = 0;
+  intptr_t high = program_->library_count() - 1;
+  while (low <= high) {
+    const intptr_t mid = low + (high - low) / 2;
+    const intptr_t offset = library_offset(mid);
+    if (offset == kernel_offset) {
+      return mid;
+    } else if (offset < kernel_offset) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  UNREACHABLE();
+  return -1;
+}
+
+ErrorPtr KernelLoader::EnsureLibraryLoaded(const Library& library) {
+  if (!IsLibraryLoadingDeferred(library)) {
+    return Error::null();
+  }
+  Thread* thread = Thread::Current();
+  if (Compiler::IsBackgroundCompilation()) {
+    // Only mutators can register the classes of the library. The library is
+    // loaded by the next optimization request of a mutator, see
+    // [LoadLibrariesRequestedByCompiler], so that the compilation succeeds
+    // when it is retried.
+    {
+      SafepointWriteRwLocker ml(thread,
+                                thread->isolate_group()->program_lock());
+      ObjectStore* object_store = thread->isolate_group()->object_store();
+      auto& requests = GrowableObjectArray::Handle(
+          thread->zone(), object_store->lazy_library_load_requests());
+      if (requests.IsNull()) {
+        requests = GrowableObjectArray::New(Heap::kOld);
+        object_store->set_lazy_library_load_requests(requests);
+      }
+      requests.Add(library, Heap::kOld);
+    }
+    Compiler::AbortBackgroundCompilation(
+        DeoptId::kNone, "Library loading requires the mutator thread");
+  }
+  SafepointWriteRwLocker ml(thread, thread->isolate_group()->program_lock());
+  if (!IsLibraryLoadingDeferred(library)) {
+    return Error::null();
+  }
+
+  TIMELINE_DURATION(thread, Isolate, "LoadDeferredKernelLibrary");
+  Zone* zone = thread->zone();
+  ObjectStore* object_store = thread->isolate_group()->object_store();
+  const auto& info =
+      KernelProgramInfo::Handle(zone, object_store->lazy_kernel_program_info());
+  ASSERT(!info.IsNull());
+  const auto& blob = ExternalTypedData::CheckedHandle(
+      zone, info.retained_kernel_blob());
+  std::unique_ptr<Program> program = Program::ReadFromTypedData(blob);
+  ASSERT(program != nullptr);
+
+  LongJumpScope jump;
+  if (setjmp(*jump.Set()) == 0) {
+    // Classes of the library stay pending until the next class
+    // finalization; their types are finalized on first use at the latest,
+    // see ClassFinalizer::LoadClassMembers.
+    KernelLoader loader(info, program.get());
+    loader.LoadLibrary(loader.LibraryIndexAt(library.kernel_offset()));
+    loader.AnnotateNativeProcedures();
+    loader.EvaluateDelayedPragmas();
+    return Error::null();
+  }
+  return thread->StealStickyError();
+}
+
+ErrorPtr KernelLoader::LoadLibrariesRequestedByCompiler() {
+  Thread* thread = Thread::Current();
+  ObjectStore* object_store = thread->isolate_group()->object_store();
+  if (object_store->lazy_library_load_requests() ==
+      GrowableObjectArray::null()) {
+    return Error::null();
+  }
+  Zone* zone = thread->zone();
+  auto& requests = GrowableObjectArray::Handle(zone);
+  {
+    SafepointWriteRwLocker ml(thread, thread->isolate_group()->program_lock());
+    requests = object_store->lazy_library_load_requests();
+    object_store->set_lazy_library_load_requests(
+        GrowableObjectArray::Handle(zone));
+  }
+  if (requests.IsNull()) {
+    return Error::null();
+  }
+  auto& library = Library::Handle(zone);
+  auto& error = Error::Handle(zone);
+  for (intptr_t i = 0; i < requests.Length(); i++) {
+    library ^= requests.At(i);
+    error = EnsureLibraryLoaded(library);
+    if (!error.IsNull()) {
+      return error.ptr();
+    }
+  }
+  if (!ClassFinalizer::ProcessPendingClasses()) {
+    return thread->StealStickyError();
+  }
+  return Error::null();
+}
+
+ErrorPtr KernelLoader::LoadPendingLibraries() {
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  ObjectStore* object_store = thread->isolate_group()->object_store();
+  if (object_store->lazy_kernel_program_info() == KernelProgramInfo::null()) {
+    return Error::null();
+  }
+  const auto& libraries =
+      GrowableObjectArray::Handle(zone, object_store->libraries());
+  auto& library = Library::Handle(zone);
+  auto& error = Error::Handle(zone);
+  // Loading may register more libraries, which are appended to the end.
+  for (intptr_t i = 0; i < libraries.Length(); i++) {
+    library ^= libraries.At(i);
+    error = EnsureLibraryLoaded(library);
+    if (!error.IsNull()) {
+      return error.ptr();
+    }
+  }
+  object_store->set_lazy_kernel_program_info(KernelProgramInfo::Handle(zone));
+  if (!ClassFinalizer::ProcessPendingClasses()) {
+    return thread->StealStickyError();
+  }
+  return Error::null();
+}
+
 void KernelLoader::LoadLibrary(const Library& library) {
   // This will be invoked by VM bootstrapping code.
   SafepointWriteRwLocker ml(thread_, thread_->isolate_group()->program_lock());
@@ -2286,7 +2657,12 @@ ClassPtr KernelLoader::LookupClass(const Library& library, NameIndex klass) {
 
   ASSERT(!library.IsNull());
   const String& name = H.DartClassName(klass);
-  Class& handle = Class::Handle(Z, library.LookupLocalClass(name));
+  // The classes of a library whose loading was deferred are all in the
+  // cache above. Looking into its dictionary would load it.
+  Class& handle = Class::Handle(Z);
+  if (!IsLibraryLoadingDeferred(library)) {
+    handle = library.LookupLocalClass(name);
+  }
   bool register_class = true;
   if (handle.IsNull()) {
     // We do not register expression evaluation classes with the VM:
@@ -216,6 +216,24 @@ class KernelLoader : public ValueObject {
 
   static void FinishLoading(const Class& klass);
 
+  // Returns whether loading of [library] was deferred by
+  // --lazy-load-kernel-libraries and has not happened yet.
+  static bool IsLibraryLoadingDeferred(const Library& library) {
+    return library.LoadRequested() && (library.kernel_offset() > 0);
+  }
+
+  // Loads [library] from the retained kernel program if its loading was
+  // deferred. Returns an error if loading failed.
+  static ErrorPtr EnsureLibraryLoaded(const Library& library);
+
+  // Loads the libraries that background compilations needed but could not
+  // load, see [EnsureLibraryLoaded]. Must be called by a mutator.
+  static ErrorPtr LoadLibrariesRequestedByCompiler();
+
+  // Loads all libraries whose loading was deferred. Used before the whole
+  // program is inspected, e.g. for a reload or an app-jit snapshot.
+  static ErrorPtr LoadPendingLibraries();
+
   void ReadObfuscationProhibitions();
   void ReadLoadingUnits();
 
@@ -240,6 +258,19 @@ class KernelLoader : public ValueObject {
                intptr_t data_program_offset,
                uint32_t kernel_binary_version);
 
+  // Creates a loader for [program] which was already loaded into [info], to
+  // load the libraries whose loading was deferred.
+  KernelLoader(const KernelProgramInfo& info, Program* program);
+
+  bool CanLoadLibrariesLazily();
+
+  // Interns the names declared by the program on helper threads before its
+  // libraries are loaded, see [CanonicalNameInterner].
+  void InternCanonicalNames();
+
+  void DeferLibraryLoading(intptr_t index);
+  intptr_t LibraryIndexAt(intptr_t kernel_offset);
+
   void InitializeFields(
       DirectChainedHashMap<UriToSourceTableTrait>* uri_to_source_table);
 
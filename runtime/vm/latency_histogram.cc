@@ -0,0 +1,51 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/latency_histogram.h"
+
+#include "vm/json_stream.h"
+
+namespace dart {
+
+int64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  const int64_t count = count_.load();
+  if (count == 0) {
+    return 0;
+  }
+  int64_t target = static_cast<int64_t>(count * percentile / 100.0 + 0.5);
+  if (target < 1) target = 1;
+  if (target > count) target = count;
+  int64_t seen = 0;
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    seen += buckets_[i].load();
+    if (seen >= target) {
+      return Utils::Minimum(BucketUpperBound(i), max_.load());
+    }
+  }
+  // Buckets were updated concurrently with [count_].
+  return max_.load();
+}
+
+#ifndef PRODUCT
+void LatencyHistogram::PrintJSON(JSONObject* jsobj, const char* name) const {
+  JSONObject histogram(jsobj, name);
+  histogram.AddProperty64("count", count());
+  histogram.AddProperty64("total", total());
+  histogram.AddProperty64("max", max());
+  histogram.AddProperty64("p50", ValueAtPercentile(50.0));
+  histogram.AddProperty64("p90", ValueAtPercentile(90.0));
+  histogram.AddProperty64("p99", ValueAtPercentile(99.0));
+  histogram.AddProperty64("p999", ValueAtPercentile(99.9));
+  JSONArray buckets(&histogram, "buckets");
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    const int64_t bucket_count = buckets_[i].load();
+    if (bucket_count == 0) continue;
+    JSONArray bucket(&buckets);
+    bucket.AddValue64(BucketLowerBound(i));
+    bucket.AddValue64(bucket_count);
+  }
+}
+#endif  // !PRODUCT
+
+}  // namespace dart
@@ -0,0 +1,101 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_LATENCY_HISTOGRAM_H_
+#define RUNTIME_VM_LATENCY_HISTOGRAM_H_
+
+#include "platform/atomic.h"
+#include "platform/utils.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class JSONObject;
+
+// A histogram of durations in microseconds with log-linear buckets in the
+// style of HdrHistogram.
+//
+// Values below [kSubBucketCount] get a bucket each. Larger values are
+// bucketed by their highest set bit and the [kSubBucketBits] bits below it,
+// which bounds the relative error of any reported value by
+// 1 / [kSubBucketCount]. Values are clamped to [kMaxValue].
+//
+// Recording is a handful of relaxed atomic operations, so histograms can stay
+// enabled in production. It is intended for a single recording thread; reads
+// from other threads may observe a slightly inconsistent snapshot.
+class LatencyHistogram {
+ public:
+  static constexpr intptr_t kSubBucketBits = 3;
+  static constexpr intptr_t kSubBucketCount = 1 << kSubBucketBits;
+  static constexpr intptr_t kMaxValueBits = 32;
+  static constexpr int64_t kMaxValue =
+      (static_cast<int64_t>(1) << kMaxValueBits) - 1;
+  static constexpr intptr_t kNumBuckets =
+      kSubBucketCount * (kMaxValueBits - kSubBucketBits + 1);
+
+  LatencyHistogram() {}
+
+  void Add(int64_t micros) {
+    if (micros < 0) micros = 0;
+    if (micros > kMaxValue) micros = kMaxValue;
+    buckets_[BucketIndex(micros)].fetch_add(1);
+    count_.fetch_add(1);
+    total_.fetch_add(micros);
+    if (micros > max_.load()) {
+      max_.store(micros);
+    }
+  }
+
+  int64_t count() const { return count_.load(); }
+  int64_t total() const { return total_.load(); }
+  int64_t max() const { return max_.load(); }
+
+  // Returns an upper bound of the smallest recorded value such that at least
+  // [percentile] percent of all recorded values are less than or equal to it,
+  // or 0 if nothing was recorded.
+  int64_t ValueAtPercentile(double percentile) const;
+
+  static intptr_t BucketIndex(int64_t micros) {
+    ASSERT(0 <= micros && micros <= kMaxValue);
+    if (micros < kSubBucketCount) {
+      return micros;
+    }
+    const intptr_t shift = Utils::HighestBit(micros) - kSubBucketBits;
+    return shift * kSubBucketCount + (micros >> shift);
+  }
+
+  // The smallest value that falls into the bucket at [index].
+  static int64_t BucketLowerBound(intptr_t index) {
+    ASSERT(0 <= index && index < kNumBuckets);
+    if (index < kSubBucketCount) {
+      return index;
+    }
+    const intptr_t shift = index / kSubBucketCount - 1;
+    return static_cast<int64_t>(index - shift * kSubBucketCount) << shift;
+  }
+
+  // The largest value that falls into the bucket at [index].
+  static int64_t BucketUpperBound(intptr_t index) {
+    return (index + 1 < kNumBuckets) ? BucketLowerBound(index + 1) - 1
+                                     : kMaxValue;
+  }
+
+#ifndef PRODUCT
+  // Adds an object [name] with the count, total, max, common percentiles and
+  // the non-empty buckets as [lower bound, count] pairs.
+  void PrintJSON(JSONObject* jsobj, const char* name) const;
+#endif  // !PRODUCT
+
+ private:
+  RelaxedAtomic<int64_t> buckets_[kNumBuckets];
+  RelaxedAtomic<int64_t> count_ = 0;
+  RelaxedAtomic<int64_t> total_ = 0;
+  RelaxedAtomic<int64_t> max_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,64 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/latency_histogram.h"
+#include "platform/assert.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+VM_UNIT_TEST_CASE(LatencyHistogram_Buckets) {
+  // Small values are exact.
+  for (intptr_t i = 0; i < LatencyHistogram::kSubBucketCount; i++) {
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(i));
+    EXPECT_EQ(i, LatencyHistogram::BucketLowerBound(i));
+    EXPECT_EQ(i, LatencyHistogram::BucketUpperBound(i));
+  }
+  // Every value lies within the bounds of its bucket, and buckets are
+  // contiguous.
+  int64_t expected_lower = 0;
+  for (intptr_t i = 0; i < LatencyHistogram::kNumBuckets; i++) {
+    const int64_t lower = LatencyHistogram::BucketLowerBound(i);
+    const int64_t upper = LatencyHistogram::BucketUpperBound(i);
+    EXPECT_EQ(expected_lower, lower);
+    EXPECT_LE(lower, upper);
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(lower));
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(upper));
+    // Relative error is bounded by the number of sub-buckets.
+    if (i >= LatencyHistogram::kSubBucketCount) {
+      EXPECT_LE((upper - lower + 1) * LatencyHistogram::kSubBucketCount,
+                upper + 1);
+    }
+    expected_lower = upper + 1;
+  }
+  EXPECT_EQ(LatencyHistogram::kMaxValue + 1, expected_lower);
+}
+
+VM_UNIT_TEST_CASE(LatencyHistogram_Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.ValueAtPercentile(50.0));
+
+  for (intptr_t i = 1; i <= 1000; i++) {
+    histogram.Add(i);
+  }
+  EXPECT_EQ(1000, histogram.count());
+  EXPECT_EQ(500500, histogram.total());
+  EXPECT_EQ(1000, histogram.max());
+
+  const int64_t p50 = histogram.ValueAtPercentile(50.0);
+  EXPECT_LE(500, p50);
+  EXPECT_LE(p50, 500 + 500 / LatencyHistogram::kSubBucketCount);
+  const int64_t p99 = histogram.ValueAtPercentile(99.0);
+  EXPECT_LE(990, p99);
+  EXPECT_LE(p99, 1000);
+  EXPECT_EQ(1000, histogram.ValueAtPercentile(100.0));
+
+  // Out of range values are clamped.
+  histogram.Add(-1);
+  histogram.Add(LatencyHistogram::kMaxValue * 2);
+  EXPECT_EQ(LatencyHistogram::kMaxValue, histogram.max());
+  EXPECT_EQ(LatencyHistogram::kMaxValue, histogram.ValueAtPercentile(100.0));
+}
+
+}  // namespace dart
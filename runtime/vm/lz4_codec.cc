@@ -0,0 +1,176 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/lz4_codec.h"
+
+#include "platform/unaligned.h"
+#include "platform/utils.h"
+
+namespace dart {
+
+// Constraints of the block format.
+static constexpr intptr_t kMinMatch = 4;
+static constexpr intptr_t kLastLiterals = 5;
+static constexpr intptr_t kMatchFindLimit = 12;
+static constexpr intptr_t kMaxOffset = 65535;
+static constexpr intptr_t kRunMask = 15;
+
+static constexpr intptr_t kHashBits = 12;
+static constexpr intptr_t kHashSize = 1 << kHashBits;
+// The search skips ahead faster after this many consecutive misses, which
+// keeps incompressible input fast.
+static constexpr intptr_t kSkipTrigger = 6;
+
+static intptr_t HashSequence(uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - kHashBits);
+}
+
+static uint8_t* WriteLength(uint8_t* out, intptr_t length) {
+  ASSERT(length >= kRunMask);
+  length -= kRunMask;
+  while (length >= 255) {
+    *out++ = 255;
+    length -= 255;
+  }
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+static uint8_t* WriteLiterals(uint8_t* out,
+                              uint8_t* token,
+                              const uint8_t* literals,
+                              intptr_t length) {
+  *token = static_cast<uint8_t>(Utils::Minimum(length, kRunMask) << 4);
+  if (length >= kRunMask) {
+    out = WriteLength(out, length);
+  }
+  memmove(out, literals, length);
+  return out + length;
+}
+
+intptr_t LZ4Codec::Compress(const uint8_t* src, intptr_t size, uint8_t* dst) {
+  const uint8_t* const end = src + size;
+  const uint8_t* anchor = src;
+  uint8_t* out = dst;
+
+  if (size > kMatchFindLimit) {
+    int32_t table[kHashSize];
+    for (intptr_t i = 0; i < kHashSize; i++) {
+      table[i] = -1;
+    }
+    const uint8_t* const match_start_limit = end - kMatchFindLimit;
+    const uint8_t* const match_end_limit = end - kLastLiterals;
+    const uint8_t* ip = src;
+    intptr_t misses = 0;
+    while (ip < match_start_limit) {
+      const uint32_t sequence =
+          LoadUnaligned(reinterpret_cast<const uint32_t*>(ip));
+      const intptr_t hash = HashSequence(sequence);
+      const intptr_t candidate = table[hash];
+      table[hash] = static_cast<int32_t>(ip - src);
+      if ((candidate < 0) || ((ip - src) - candidate > kMaxOffset) ||
+          (LoadUnaligned(reinterpret_cast<const uint32_t*>(src + candidate)) !=
+           sequence)) {
+        ip += 1 + (misses++ >> kSkipTrigger);
+        continue;
+      }
+      misses = 0;
+
+      const uint8_t* match = src + candidate;
+      intptr_t length = kMinMatch;
+      while ((ip + length < match_end_limit) && (ip[length] == match[length])) {
+        length++;
+      }
+
+      uint8_t* token = out++;
+      out = WriteLiterals(out, token, anchor, ip - anchor);
+      const intptr_t offset = ip - match;
+      *out++ = static_cast<uint8_t>(offset);
+      *out++ = static_cast<uint8_t>(offset >> 8);
+      const intptr_t match_run = length - kMinMatch;
+      *token |= static_cast<uint8_t>(Utils::Minimum(match_run, kRunMask));
+      if (match_run >= kRunMask) {
+        out = WriteLength(out, match_run);
+      }
+
+      ip += length;
+      anchor = ip;
+    }
+  }
+
+  // The last sequence only has literals.
+  uint8_t* token = out++;
+  out = WriteLiterals(out, token, anchor, end - anchor);
+  ASSERT(out - dst <= MaxCompressedSize(size));
+  return out - dst;
+}
+
+// Reads the extra bytes of a run length of [kRunMask] or more.
+static bool ReadLength(const uint8_t** in,
+                       const uint8_t* end,
+                       intptr_t limit,
+                       intptr_t* length) {
+  uint8_t byte;
+  do {
+    if (*in >= end) return false;
+    byte = *(*in)++;
+    *length += byte;
+    if (*length > limit) return false;
+  } while (byte == 255);
+  return true;
+}
+
+bool LZ4Codec::Decompress(const uint8_t* src,
+                          intptr_t src_size,
+                          uint8_t* dst,
+                          intptr_t dst_size) {
+  const uint8_t* in = src;
+  const uint8_t* const in_end = src + src_size;
+  uint8_t* out = dst;
+  uint8_t* const out_end = dst + dst_size;
+
+  while (true) {
+    if (in >= in_end) return false;
+    const uint8_t token = *in++;
+
+    intptr_t literals = token >> 4;
+    if ((literals == kRunMask) &&
+        !ReadLength(&in, in_end, dst_size, &literals)) {
+      return false;
+    }
+    if ((literals > in_end - in) || (literals > out_end - out)) {
+      return false;
+    }
+    memmove(out, in, literals);
+    in += literals;
+    out += literals;
+    if (in == in_end) break;
+
+    if (in_end - in < 2) return false;
+    const intptr_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    if ((offset == 0) || (offset > out - dst)) return false;
+
+    intptr_t length = token & kRunMask;
+    if ((length == kRunMask) && !ReadLength(&in, in_end, dst_size, &length)) {
+      return false;
+    }
+    length += kMinMatch;
+    if (length > out_end - out) return false;
+
+    const uint8_t* match = out - offset;
+    if (offset >= length) {
+      memmove(out, match, length);
+    } else {
+      // Overlapping matches repeat the last [offset] bytes.
+      for (intptr_t i = 0; i < length; i++) {
+        out[i] = match[i];
+      }
+    }
+    out += length;
+  }
+  return out == out_end;
+}
+
+}  // namespace dart
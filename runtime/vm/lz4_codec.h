@@ -0,0 +1,40 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_LZ4_CODEC_H_
+#define RUNTIME_VM_LZ4_CODEC_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Compression in the LZ4 block format.
+//
+// The compressor is a simple greedy matcher. It trades some ratio for speed
+// and a small, allocation-free implementation. The decompressor validates
+// its input, so a corrupt block is reported instead of read out of bounds.
+class LZ4Codec : public AllStatic {
+ public:
+  // An upper bound of the compressed size of [size] input bytes.
+  static constexpr intptr_t MaxCompressedSize(intptr_t size) {
+    return size + size / 255 + 16;
+  }
+
+  // Compresses [size] bytes from [src] into [dst], which must have room for
+  // MaxCompressedSize(size) bytes. Returns the compressed size.
+  static intptr_t Compress(const uint8_t* src, intptr_t size, uint8_t* dst);
+
+  // Decompresses the block of [src_size] bytes at [src] into [dst]. Returns
+  // false if the block is malformed or does not decompress to exactly
+  // [dst_size] bytes.
+  static bool Decompress(const uint8_t* src,
+                         intptr_t src_size,
+                         uint8_t* dst,
+                         intptr_t dst_size);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_LZ4_CODEC_H_
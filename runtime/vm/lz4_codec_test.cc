@@ -0,0 +1,86 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/lz4_codec.h"
+#include "platform/assert.h"
+#include "vm/random.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static void RoundTrip(const uint8_t* data,
+                      intptr_t size,
+                      intptr_t* compressed_size) {
+  uint8_t* compressed =
+      reinterpret_cast<uint8_t*>(malloc(LZ4Codec::MaxCompressedSize(size)));
+  *compressed_size = LZ4Codec::Compress(data, size, compressed);
+  EXPECT_LE(*compressed_size, LZ4Codec::MaxCompressedSize(size));
+
+  uint8_t* decompressed = reinterpret_cast<uint8_t*>(malloc(size + 1));
+  EXPECT(LZ4Codec::Decompress(compressed, *compressed_size, decompressed,
+                              size));
+  EXPECT_EQ(0, memcmp(data, decompressed, size));
+  // The expected size must match exactly.
+  if (size > 0) {
+    EXPECT(!LZ4Codec::Decompress(compressed, *compressed_size, decompressed,
+                                 size - 1));
+  }
+  EXPECT(!LZ4Codec::Decompress(compressed, *compressed_size, decompressed,
+                               size + 1));
+  free(decompressed);
+  free(compressed);
+}
+
+VM_UNIT_TEST_CASE(LZ4Codec_RoundTrip) {
+  const intptr_t kSize = 100 * KB;
+  uint8_t* data = reinterpret_cast<uint8_t*>(malloc(kSize));
+  intptr_t compressed_size = 0;
+
+  // Short inputs are stored as literals.
+  for (intptr_t size = 0; size < 32; size++) {
+    memset(data, 'a', size);
+    RoundTrip(data, size, &compressed_size);
+  }
+
+  // Repetitive input compresses well, including overlapping matches.
+  for (intptr_t i = 0; i < kSize; i++) {
+    data[i] = static_cast<uint8_t>((i % 7) * 3);
+  }
+  RoundTrip(data, kSize, &compressed_size);
+  EXPECT_LT(compressed_size, kSize / 50);
+
+  // Incompressible input grows by at most the format overhead.
+  Random random(42);
+  for (intptr_t i = 0; i < kSize; i++) {
+    data[i] = static_cast<uint8_t>(random.NextUInt32());
+  }
+  RoundTrip(data, kSize, &compressed_size);
+  EXPECT_LE(compressed_size, LZ4Codec::MaxCompressedSize(kSize));
+
+  free(data);
+}
+
+VM_UNIT_TEST_CASE(LZ4Codec_CorruptInput) {
+  const intptr_t kSize = 4 * KB;
+  uint8_t data[kSize];
+  for (intptr_t i = 0; i < kSize; i++) {
+    data[i] = static_cast<uint8_t>(i / 10);
+  }
+  uint8_t compressed[LZ4Codec::MaxCompressedSize(kSize)];
+  const intptr_t compressed_size = LZ4Codec::Compress(data, kSize, compressed);
+  uint8_t decompressed[kSize];
+
+  // Truncated blocks are rejected.
+  for (intptr_t size = 0; size < compressed_size; size++) {
+    EXPECT(!LZ4Codec::Decompress(compressed, size, decompressed, kSize));
+  }
+
+  // A match before the start of the output is rejected.
+  const uint8_t bad_offset[] = {0x10, 'a', 0x02, 0x00, 0x50, 'b', 'b',
+                                'b',  'b', 'b'};
+  EXPECT(!LZ4Codec::Decompress(bad_offset, sizeof(bad_offset), decompressed,
+                               kSize));
+}
+
+}  // namespace dart
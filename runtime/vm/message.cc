@@ -105,6 +105,8 @@ const char* Message::PriorityAsString(Priority priority) {
 MessageQueue::MessageQueue() {
   head_ = NULL;
   tail_ = NULL;
+  length_ = 0;
+  size_ = 0;
 }
 
 MessageQueue::~MessageQueue() {
@@ -119,6 +121,8 @@ void MessageQueue::Enqueue(std::unique_ptr<Message> msg0, bool before_events) {
 
   // Make sure messages are not reused.
   ASSERT(msg->next_ == NULL);
+  length_++;
+  size_ += msg->Size();
   if (head_ == NULL) {
     // Only element in the queue.
     ASSERT(tail_ == NULL);
@@ -165,6 +169,9 @@ std::unique_ptr<Message> MessageQueue::Dequeue() {
     if (head_ == nullptr) {
       tail_ = nullptr;
     }
+    length_--;
+    size_ -= result->Size();
+    ASSERT(length_ >= 0 && size_ >= 0);
 #if defined(DEBUG)
     result->next_ = result;  // Make sure to trigger ASSERT in Enqueue.
 #endif                       // DEBUG
@@ -177,6 +184,8 @@ void MessageQueue::Clear() {
   std::unique_ptr<Message> cur(head_);
   head_ = nullptr;
   tail_ = nullptr;
+  length_ = 0;
+  size_ = 0;
   while (cur != nullptr) {
     std::unique_ptr<Message> next(cur->next_);
     if (cur->RedirectToDeliveryFailurePort()) {
@@ -209,16 +218,6 @@ Message* MessageQueue::Iterator::Next() {
   return current;
 }
 
-intptr_t MessageQueue::Length() const {
-  MessageQueue::Iterator it(this);
-  intptr_t length = 0;
-  while (it.HasNext()) {
-    it.Next();
-    length++;
-  }
-  return length;
-}
-
 Message* MessageQueue::FindMessageById(intptr_t id) {
   MessageQueue::Iterator it(this);
   while (it.HasNext()) {
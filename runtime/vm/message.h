@@ -129,6 +129,13 @@ class Message {
 
   intptr_t Id() const;
 
+  // Monotonic timestamps used for message latency histograms, or 0 if the
+  // message was not stamped.
+  int64_t posted_micros() const { return posted_micros_; }
+  void set_posted_micros(int64_t micros) { posted_micros_ = micros; }
+  int64_t dequeued_micros() const { return dequeued_micros_; }
+  void set_dequeued_micros(int64_t micros) { dequeued_micros_ = micros; }
+
   static const char* PriorityAsString(Priority priority);
 
  private:
@@ -152,6 +159,8 @@ class Message {
   intptr_t snapshot_length_ = 0;
   MessageFinalizableData* finalizable_data_ = nullptr;
   Priority priority_;
+  int64_t posted_micros_ = 0;
+  int64_t dequeued_micros_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(Message);
 };
@@ -191,7 +200,11 @@ class MessageQueue {
     Message* next_;
   };
 
-  intptr_t Length() const;
+  // The number of messages in the queue.
+  intptr_t Length() const { return length_; }
+
+  // The sum of Message::Size() over all messages in the queue.
+  intptr_t Size() const { return size_; }
 
   // Returns the message with id or NULL.
   Message* FindMessageById(intptr_t id);
@@ -201,6 +214,8 @@ class MessageQueue {
  private:
   Message* head_;
   Message* tail_;
+  intptr_t length_;
+  intptr_t size_;
 
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
@@ -9,6 +9,7 @@
 #include "vm/dart.h"
 #include "vm/heap/safepoint.h"
 #include "vm/isolate.h"
+#include "vm/json_stream.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -20,6 +21,12 @@ namespace dart {
 
 DECLARE_FLAG(bool, trace_service_pause_events);
 
+DEFINE_FLAG(bool,
+            message_latency_histograms,
+            true,
+            "Record per-isolate histograms of message queue wait and "
+            "handling time.");
+
 class MessageHandlerTask : public ThreadPool::Task {
  public:
   explicit MessageHandlerTask(MessageHandler* handler) : handler_(handler) {
@@ -61,6 +68,9 @@ MessageHandler::MessageHandler()
       paused_for_messages_(false),
       live_ports_(0),
       paused_(0),
+      queue_high_water_mark_(0),
+      queue_high_water_mark_bytes_(0),
+      rejected_messages_(0),
 #if !defined(PRODUCT)
       should_pause_on_start_(false),
       should_pause_on_exit_(false),
@@ -129,12 +139,44 @@ bool MessageHandler::Run(ThreadPool* pool,
   return result;
 }
 
-void MessageHandler::PostMessage(std::unique_ptr<Message> message,
+void MessageHandler::SetQueueHighWaterMarks(intptr_t max_messages,
+                                            intptr_t max_bytes) {
+  ASSERT(max_messages >= 0 && max_bytes >= 0);
+  MonitorLocker ml(&monitor_);
+  queue_high_water_mark_ = max_messages;
+  queue_high_water_mark_bytes_ = max_bytes;
+}
+
+bool MessageHandler::IsQueueFullLocked() const {
+  ASSERT(monitor_.IsOwnedByCurrentThread());
+  return ((queue_high_water_mark_ > 0) &&
+          (queue_->Length() >= queue_high_water_mark_)) ||
+         ((queue_high_water_mark_bytes_ > 0) &&
+          (queue_->Size() >= queue_high_water_mark_bytes_));
+}
+
+bool MessageHandler::PostMessage(std::unique_ptr<Message>&& message,
                                  bool before_events) {
   Message::Priority saved_priority;
 
   {
     MonitorLocker ml(&monitor_);
+    // Isolate library control messages (before_events) and OOB messages are
+    // never subject to back-pressure.
+    if (!message->IsOOB() && !before_events && IsQueueFullLocked()) {
+      rejected_messages_++;
+      if (FLAG_trace_isolates) {
+        OS::PrintErr(
+            "[!] Rejecting message, queue full:\n"
+            "\tlen:        %" Pd
+            "\n"
+            "\tdest:       %s\n"
+            "\tqueued:     %" Pd " messages, %" Pd " bytes\n",
+            message->Size(), name(), queue_->Length(), queue_->Size());
+      }
+      return false;
+    }
+
     if (FLAG_trace_isolates) {
       Isolate* source_isolate = Isolate::Current();
       if (source_isolate != nullptr) {
@@ -162,20 +204,63 @@ void MessageHandler::PostMessage(std::unique_ptr<Message> message,
     } else {
       queue_->Enqueue(std::move(message), before_events);
     }
-    if (paused_for_messages_) {
-      ml.Notify();
-    }
+    ScheduleTaskLocked(&ml);
+  }
 
-    if (pool_ != nullptr && !task_running_) {
-      ASSERT(!delete_me_);
-      task_running_ = true;
-      const bool launched_successfully = pool_->Run<MessageHandlerTask>(this);
-      ASSERT(launched_successfully);
+  // Invoke any custom message notification.
+  MessageNotify(saved_priority);
+  return true;
+}
+
+intptr_t MessageHandler::PostMessages(std::unique_ptr<Message>* messages,
+                                      intptr_t count) {
+  intptr_t posted = 0;
+  {
+    MonitorLocker ml(&monitor_);
+    for (; posted < count; posted++) {
+      std::unique_ptr<Message>& message = messages[posted];
+      ASSERT(message != nullptr);
+      ASSERT(message->priority() == Message::kNormalPriority);
+      if (IsQueueFullLocked()) {
+        rejected_messages_ += count - posted;
+        break;
+      }
+      queue_->Enqueue(std::move(message), false);
     }
+    if (FLAG_trace_isolates) {
+      OS::PrintErr(
+          "[>] Posting message batch:\n"
+          "\tposted:     %" Pd " of %" Pd
+          "\n"
+          "\tdest:       %s\n",
+          posted, count, name());
+    }
+    if (posted == 0) {
+      return 0;
+    }
+    ScheduleTaskLocked(&ml);
   }
 
   // Invoke any custom message notification.
-  MessageNotify(saved_priority);
+  MessageNotify(Message::kNormalPriority);
+  return posted;
+}
+
+void MessageHandler::ScheduleTaskLocked(MonitorLocker* ml) {
+  ASSERT(monitor_.IsOwnedByCurrentThread());
+  if (paused_for_messages_) {
+    ml->Notify();
+  }
+
+  if (pool_ != nullptr && !task_running_) {
+    ASSERT(!delete_me_);
+    task_running_ = true;
+    // When posted from a busy worker, prefer running this handler on the
+    // sending worker once it is done, rather than contending on the pool.
+    const bool launched_successfully =
+        pool_->RunLocal<MessageHandlerTask>(this);
+    ASSERT(launched_successfully);
+  }
 }
 
 std::unique_ptr<Message> MessageHandler::DequeueMessage(
@@ -219,6 +304,14 @@ MessageHandler::MessageStatus MessageHandler::HandleMessages(
   std::unique_ptr<Message> message = DequeueMessage(min_priority);
   while (message != nullptr) {
     intptr_t message_len = message->Size();
+    int64_t start_micros = 0;
+    if (FLAG_message_latency_histograms) {
+      start_micros = OS::GetCurrentMonotonicMicros();
+      message->set_dequeued_micros(start_micros);
+      if (message->posted_micros() != 0) {
+        queue_wait_histogram_.Add(start_micros - message->posted_micros());
+      }
+    }
     if (FLAG_trace_isolates) {
       OS::PrintErr(
           "[<] Handling message:\n"
@@ -239,6 +332,9 @@ MessageHandler::MessageStatus MessageHandler::HandleMessages(
       DisableIdleTimerScope disable_idle_timer(idle_time_handler);
       status = HandleMessage(std::move(message));
     }
+    if (start_micros != 0) {
+      run_time_histogram_.Add(OS::GetCurrentMonotonicMicros() - start_micros);
+    }
     if (status > max_status) {
       max_status = status;
     }
@@ -383,6 +479,27 @@ bool MessageHandler::HasMessages() {
   return !queue_->IsEmpty();
 }
 
+#if !defined(PRODUCT)
+void MessageHandler::PrintQueueStatsJSON(JSONObject* jsobj) {
+  MonitorLocker ml(&monitor_);
+  JSONObject stats(jsobj, "_messageQueue");
+  stats.AddProperty("length", queue_->Length());
+  stats.AddProperty("bytes", queue_->Size());
+  stats.AddProperty("oobLength", oob_queue_->Length());
+  stats.AddProperty("oobBytes", oob_queue_->Size());
+  stats.AddProperty("highWaterMark", queue_high_water_mark_);
+  stats.AddProperty("highWaterMarkBytes", queue_high_water_mark_bytes_);
+  stats.AddProperty("rejected", rejected_messages_);
+}
+
+void MessageHandler::PrintLatencyJSON(JSONObject* jsobj) {
+  JSONObject latency(jsobj, "_messageLatency");
+  latency.AddProperty("enabled", FLAG_message_latency_histograms);
+  queue_wait_histogram_.PrintJSON(&latency, "queueWaitMicros");
+  run_time_histogram_.PrintJSON(&latency, "runMicros");
+}
+#endif  // !defined(PRODUCT)
+
 void MessageHandler::TaskCallback() {
   ASSERT(Isolate::Current() == NULL);
   MessageStatus status = kOK;
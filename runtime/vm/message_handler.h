@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "vm/isolate.h"
+#include "vm/latency_histogram.h"
 #include "vm/lockers.h"
 #include "vm/message.h"
 #include "vm/os_thread.h"
@@ -16,6 +17,8 @@
 
 namespace dart {
 
+class JSONObject;
+
 // A MessageHandler is an entity capable of accepting messages.
 class MessageHandler {
  protected:
@@ -88,6 +91,33 @@ class MessageHandler {
 
   bool paused() const { return paused_ > 0; }
 
+  // Bounds the normal priority queue of this handler. Once the queue holds
+  // [max_messages] messages or [max_bytes] bytes, further normal priority
+  // messages are rejected and PortMap::PostMessage returns false to the
+  // sender. OOB messages are never rejected. A limit of 0 means unbounded,
+  // which is the default. Isolates other than system isolates start out
+  // with the limits given by --message_queue_high_water_mark and
+  // --message_queue_high_water_mark_kb.
+  void SetQueueHighWaterMarks(intptr_t max_messages, intptr_t max_bytes);
+
+  // The number of messages rejected because the queue was full.
+  intptr_t rejected_messages() const { return rejected_messages_; }
+
+  // Time messages spent between PortMap::PostMessage and being dequeued,
+  // including thread pool scheduling delay.
+  const LatencyHistogram& queue_wait_histogram() const {
+    return queue_wait_histogram_;
+  }
+  // Time spent in HandleMessage.
+  const LatencyHistogram& run_time_histogram() const {
+    return run_time_histogram_;
+  }
+
+#if !defined(PRODUCT)
+  void PrintQueueStatsJSON(JSONObject* jsobj);
+  void PrintLatencyJSON(JSONObject* jsobj);
+#endif
+
   void increment_paused() { paused_++; }
   void decrement_paused() {
     ASSERT(paused_ > 0);
@@ -174,9 +204,21 @@ class MessageHandler {
   // Posts a message on this handler's message queue.
   // If before_events is true, then the message is enqueued before any pending
   // events, but after any pending isolate library events.
-  void PostMessage(std::unique_ptr<Message> message,
+  //
+  // Returns false if the message was rejected because the queue is above its
+  // high-water mark. In that case ownership of [message] stays with the
+  // caller.
+  bool PostMessage(std::unique_ptr<Message>&& message,
                    bool before_events = false);
 
+  // Posts normal priority [messages] in order under a single acquisition of
+  // the monitor, notifying the handler once. Stops early if the queue reaches
+  // its high-water mark.
+  //
+  // Returns the number of messages posted. Entries that were not posted are
+  // left in [messages] and remain owned by the caller.
+  intptr_t PostMessages(std::unique_ptr<Message>* messages, intptr_t count);
+
   // Notifies this handler that a port is being closed.
   void ClosePort(Dart_Port port);
 
@@ -242,6 +284,15 @@ class MessageHandler {
 
   void ClearOOBQueue();
 
+  // Whether a normal priority message must be rejected. Must be called with
+  // monitor_ held.
+  bool IsQueueFullLocked() const;
+
+  // Wakes up a paused handler and schedules a task on the thread pool if none
+  // is running, after messages were enqueued. Must be called with monitor_
+  // held.
+  void ScheduleTaskLocked(MonitorLocker* ml);
+
   // Handles any pending messages.
   MessageStatus HandleMessages(MonitorLocker* ml,
                                bool allow_normal_messages,
@@ -258,6 +309,11 @@ class MessageHandler {
       ports_;  // Only accessed by [PortMap], protected by [PortMap]s lock.
   intptr_t live_ports_;  // The number of open ports, including control ports.
   intptr_t paused_;      // The number of pause messages received.
+  intptr_t queue_high_water_mark_;        // 0 means unbounded.
+  intptr_t queue_high_water_mark_bytes_;  // 0 means unbounded.
+  intptr_t rejected_messages_;
+  LatencyHistogram queue_wait_histogram_;
+  LatencyHistogram run_time_histogram_;
 #if !defined(PRODUCT)
   bool should_pause_on_start_;
   bool should_pause_on_exit_;
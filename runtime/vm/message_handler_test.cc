@@ -15,8 +15,8 @@ class MessageHandlerTestPeer {
   explicit MessageHandlerTestPeer(MessageHandler* handler)
       : handler_(handler) {}
 
-  void PostMessage(std::unique_ptr<Message> message) {
-    handler_->PostMessage(std::move(message));
+  bool PostMessage(std::unique_ptr<Message> message) {
+    return handler_->PostMessage(std::move(message));
   }
   void ClosePort(Dart_Port port) { handler_->ClosePort(port); }
   void CloseAllPorts() { handler_->CloseAllPorts(); }
@@ -199,6 +199,32 @@ VM_UNIT_TEST_CASE(MessageHandler_HasOOBMessages) {
   handler_peer.CloseAllPorts();
 }
 
+VM_UNIT_TEST_CASE(MessageHandler_HighWaterMark) {
+  TestMessageHandler handler;
+  MessageHandlerTestPeer handler_peer(&handler);
+  handler.SetQueueHighWaterMarks(2, 0);
+
+  EXPECT(handler_peer.PostMessage(BlankMessage(1, Message::kNormalPriority)));
+  EXPECT(handler_peer.PostMessage(BlankMessage(1, Message::kNormalPriority)));
+  // The queue is full, normal messages are rejected.
+  EXPECT(!handler_peer.PostMessage(BlankMessage(1, Message::kNormalPriority)));
+  EXPECT_EQ(1, handler.rejected_messages());
+  // OOB messages are never rejected.
+  EXPECT(handler_peer.PostMessage(BlankMessage(1, Message::kOOBPriority)));
+  EXPECT_EQ(3, handler.notify_count());
+
+  // Draining the queue makes room again.
+  EXPECT(handler_peer.queue()->Dequeue() != nullptr);
+  EXPECT(handler_peer.PostMessage(BlankMessage(1, Message::kNormalPriority)));
+
+  // The byte limit applies independently of the message limit.
+  handler.SetQueueHighWaterMarks(0, 2);
+  EXPECT(!handler_peer.PostMessage(BlankMessage(1, Message::kNormalPriority)));
+  EXPECT_EQ(2, handler.rejected_messages());
+
+  handler_peer.CloseAllPorts();
+}
+
 VM_UNIT_TEST_CASE(MessageHandler_ClosePort) {
   TestMessageHandler handler;
   MessageHandlerTestPeer handler_peer(&handler);
@@ -249,6 +275,21 @@ VM_UNIT_TEST_CASE(MessageHandler_HandleNextMessage) {
   EXPECT_EQ(port1, ports[2]);
 }
 
+VM_UNIT_TEST_CASE(MessageHandler_LatencyHistograms) {
+  TestMessageHandler handler;
+  Dart_Port port1 = PortMap::CreatePort(&handler);
+  Dart_Port port2 = PortMap::CreatePort(&handler);
+  // Messages posted through the PortMap are timestamped.
+  EXPECT(PortMap::PostMessage(BlankMessage(port1, Message::kNormalPriority)));
+  EXPECT(PortMap::PostMessage(BlankMessage(port2, Message::kOOBPriority)));
+
+  EXPECT_EQ(MessageHandler::kOK, handler.HandleNextMessage());
+  EXPECT_EQ(2, handler.message_count());
+  EXPECT_EQ(2, handler.queue_wait_histogram().count());
+  EXPECT_EQ(2, handler.run_time_histogram().count());
+  EXPECT_LE(0, handler.queue_wait_histogram().max());
+}
+
 VM_UNIT_TEST_CASE(MessageHandler_HandleNextMessage_ProcessOOBAfterError) {
   TestMessageHandler handler;
   MessageHandler::MessageStatus results[] = {
@@ -46,6 +46,8 @@ TEST_CASE(MessageQueue_BasicOperations) {
   Message* msg2 = msg.get();
   queue.Enqueue(std::move(msg), false);
   EXPECT(queue.Length() == 2);
+  EXPECT_EQ(static_cast<intptr_t>(strlen(str1) + strlen(str2) + 2),
+            queue.Size());
   EXPECT(!queue.IsEmpty());
   it.Reset(&queue);
   EXPECT(it.HasNext());
@@ -96,6 +98,7 @@ TEST_CASE(MessageQueue_BasicOperations) {
                      nullptr, Message::kNormalPriority);
   queue.Enqueue(std::move(msg), true);
   EXPECT(!queue.IsEmpty());
+  EXPECT_EQ(4, queue.Length());
 
   msg = queue.Dequeue();
   EXPECT(msg != nullptr);
@@ -116,6 +119,8 @@ TEST_CASE(MessageQueue_BasicOperations) {
   EXPECT(msg != nullptr);
   EXPECT_STREQ(str5, reinterpret_cast<char*>(msg->snapshot()));
   EXPECT(queue.IsEmpty());
+  EXPECT_EQ(0, queue.Length());
+  EXPECT_EQ(0, queue.Size());
 }
 
 TEST_CASE(MessageQueue_Clear) {
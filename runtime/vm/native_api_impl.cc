@@ -60,6 +60,38 @@ DART_EXPORT bool Dart_PostCObject(Dart_Port port_id, Dart_CObject* message) {
   return PostCObjectHelper(port_id, message);
 }
 
+DART_EXPORT intptr_t Dart_PostCObjectBatch(Dart_Port port_id,
+                                           intptr_t count,
+                                           Dart_CObject** messages) {
+  if (count <= 0 || messages == nullptr) {
+    return 0;
+  }
+  std::unique_ptr<std::unique_ptr<Message>[]> batch(
+      new std::unique_ptr<Message>[count]);
+  intptr_t serialized = 0;
+  {
+    AllocOnlyStackZone zone;
+    for (; serialized < count; serialized++) {
+      batch[serialized] = WriteApiMessage(zone.GetZone(), messages[serialized],
+                                          port_id, Message::kNormalPriority);
+      if (batch[serialized] == nullptr) {
+        break;
+      }
+    }
+  }
+
+  // Post the serialized prefix of the batch at the given port.
+  intptr_t posted = 0;
+  if (serialized > 0) {
+    posted = PortMap::PostMessages(port_id, batch.get(), serialized);
+  }
+  for (intptr_t i = posted; i < serialized; i++) {
+    // Ownership of external data remains with the poster.
+    batch[i]->DropFinalizers();
+  }
+  return posted;
+}
+
 DART_EXPORT bool Dart_PostInteger(Dart_Port port_id, int64_t message) {
   if (Smi::IsValid(message)) {
     return PortMap::PostMessage(
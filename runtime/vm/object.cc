@@ -12,6 +12,7 @@
 #include "platform/text_buffer.h"
 #include "platform/unaligned.h"
 #include "platform/unicode.h"
+#include "vm/app_snapshot.h"
 #include "vm/bit_vector.h"
 #include "vm/bootstrap.h"
 #include "vm/canonical_tables.h"
@@ -4438,6 +4439,12 @@ void Class::EnsureDeclarationLoaded() const {
 #if defined(DART_PRECOMPILED_RUNTIME)
     UNREACHABLE();
 #else
+    // The declaring library may not have been loaded yet, see
+    // --lazy-load-kernel-libraries.
+    Library::Handle(library()).EnsureLoaded();
+    if (is_declaration_loaded()) {
+      return;
+    }
     FATAL1("Unable to use class %s which is not loaded yet.", ToCString());
 #endif
   }
@@ -12641,7 +12648,12 @@ void Library::AddObject(const Object& obj, const String& name) const {
   ASSERT(obj.IsClass() || obj.IsFunction() || obj.IsField() ||
          obj.IsLibraryPrefix());
   ASSERT(name.Equals(String::Handle(obj.DictionaryName())));
-  ASSERT(LookupLocalObject(name) == Object::null());
+#if defined(DEBUG)
+  // Classes are added to libraries whose loading was deferred, so this
+  // must not load them.
+  intptr_t existing_index;
+  ASSERT(LookupEntry(name, &existing_index) == Object::null());
+#endif
   const Array& dict = Array::Handle(dictionary());
   intptr_t dict_size = dict.Length() - 1;
   intptr_t index = name.Hash() % dict_size;
@@ -12888,13 +12900,33 @@ void Library::EnsureTopLevelClassIsFinalized() const {
   }
 }
 
+void Library::EnsureLoaded() const {
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  if (!kernel::KernelLoader::IsLibraryLoadingDeferred(*this)) {
+    return;
+  }
+  Thread* thread = Thread::Current();
+  const Error& error = Error::Handle(
+      thread->zone(), kernel::KernelLoader::EnsureLibraryLoaded(*this));
+  if (!error.IsNull()) {
+    if (thread->long_jump_base() != nullptr) {
+      Report::LongJump(error);
+      UNREACHABLE();
+    }
+    Exceptions::PropagateError(error);
+  }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+}
+
 ObjectPtr Library::LookupLocalObject(const String& name) const {
+  EnsureLoaded();
   intptr_t index;
   return LookupEntry(name, &index);
 }
 
 ObjectPtr Library::LookupLocalOrReExportObject(const String& name) const {
   intptr_t index;
+  EnsureLoaded();
   EnsureTopLevelClassIsFinalized();
   const Object& result = Object::Handle(LookupEntry(name, &index));
   if (!result.IsNull() && !result.IsLibraryPrefix()) {
@@ -14043,6 +14075,7 @@ ObjectPtr Namespace::Lookup(const String& name,
     }
   }
 
+  lib.EnsureLoaded();
   lib.EnsureTopLevelClassIsFinalized();
 
   intptr_t ignore = 0;
@@ -16879,6 +16912,40 @@ void Code::set_deopt_info_array(const Array& array) const {
 #endif
 }
 
+CodeSourceMapPtr Code::EnsureCodeSourceMap() const {
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+  if (!untag()->code_source_map()->IsSmi()) {
+    return untag()->code_source_map();
+  }
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  IsolateGroup* isolate_group = thread->isolate_group();
+  SafepointWriteRwLocker ml(thread, isolate_group->program_lock());
+  // Another thread may have read the map while this one waited for the lock.
+  const CodeSourceMapPtr slot = untag()->code_source_map();
+  if (!slot->IsSmi()) {
+    return slot;
+  }
+  // Code objects sharing a map share its entry, so each map is read once.
+  ObjectStore* object_store = isolate_group->object_store();
+  const auto& maps = Array::Handle(zone, object_store->lazy_code_source_maps());
+  const intptr_t index = Smi::Value(Smi::RawCast(slot));
+  auto& map = CodeSourceMap::Handle(zone);
+  const ObjectPtr entry = maps.At(index);
+  if (entry->IsSmi()) {
+    map = Deserializer::ReadLazyCodeSourceMap(thread,
+                                              Smi::Value(Smi::RawCast(entry)));
+    maps.SetAt(index, map);
+  } else {
+    map ^= entry;
+  }
+  set_code_source_map(map);
+  return map.ptr();
+#else
+  return code_source_map();
+#endif
+}
+
 void Code::set_static_calls_target_table(const Array& value) const {
 #if defined(DART_PRECOMPILED_RUNTIME)
   UNREACHABLE();
@@ -17616,7 +17683,7 @@ void Code::GetInlinedFunctionsAtInstruction(
     intptr_t pc_offset,
     GrowableArray<const Function*>* functions,
     GrowableArray<TokenPosition>* token_positions) const {
-  const CodeSourceMap& map = CodeSourceMap::Handle(code_source_map());
+  const CodeSourceMap& map = CodeSourceMap::Handle(EnsureCodeSourceMap());
   if (map.IsNull()) {
     ASSERT(!IsFunctionCode());
     return;  // VM stub, allocation stub, or type testing stub.
@@ -17632,7 +17699,7 @@ void Code::PrintJSONInlineIntervals(JSONObject* jsobj) const {
   if (!is_optimized()) {
     return;  // No inlining.
   }
-  const CodeSourceMap& map = CodeSourceMap::Handle(code_source_map());
+  const CodeSourceMap& map = CodeSourceMap::Handle(EnsureCodeSourceMap());
   const Array& id_map = Array::Handle(inlined_id_to_function());
   const Function& root = Function::Handle(function());
   CodeSourceMapReader reader(map, id_map, root);
@@ -17641,7 +17708,7 @@ void Code::PrintJSONInlineIntervals(JSONObject* jsobj) const {
 #endif
 
 void Code::DumpInlineIntervals() const {
-  const CodeSourceMap& map = CodeSourceMap::Handle(code_source_map());
+  const CodeSourceMap& map = CodeSourceMap::Handle(EnsureCodeSourceMap());
   if (map.IsNull()) {
     // Stub code.
     return;
@@ -17653,7 +17720,7 @@ void Code::DumpInlineIntervals() const {
 }
 
 void Code::DumpSourcePositions(bool relative_addresses) const {
-  const CodeSourceMap& map = CodeSourceMap::Handle(code_source_map());
+  const CodeSourceMap& map = CodeSourceMap::Handle(EnsureCodeSourceMap());
   if (map.IsNull()) {
     // Stub code.
     return;
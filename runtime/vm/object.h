@@ -5034,6 +5034,11 @@ class Library : public Object {
   // Ensures that all top-level functions and variables (fields) are loaded.
   void EnsureTopLevelClassIsFinalized() const;
 
+  // Loads this library if its loading was deferred by
+  // --lazy-load-kernel-libraries. Loading errors are reported like those of
+  // [EnsureTopLevelClassIsFinalized].
+  void EnsureLoaded() const;
+
  private:
   static const int kInitialImportsCapacity = 4;
   static const int kImportsCapacityIncrement = 8;
@@ -5174,6 +5179,10 @@ class KernelProgramInfo : public Object {
   }
   void set_kernel_binary_version(uint32_t version) const;
 
+  ObjectPtr retained_kernel_blob() const {
+    return untag()->retained_kernel_blob();
+  }
+
   // If we load a kernel blob with evaluated constants, then we delay setting
   // the native names of [Function] objects until we've read the constant table
   // (since native names are encoded as constants).
@@ -6332,10 +6341,23 @@ class Code : public Object {
     untag()->set_pc_descriptors(descriptors.ptr());
   }
 
+  // Does not allocate, so it is safe on out-of-memory paths. Returns null for
+  // a map that has not been read from the snapshot yet; use
+  // EnsureCodeSourceMap to read it.
   CodeSourceMapPtr code_source_map() const {
+#if defined(DART_PRECOMPILED_RUNTIME) && defined(DART_COMPRESSED_POINTERS)
+    CodeSourceMapPtr map = untag()->code_source_map();
+    // A Smi is the index of a map that is read lazily.
+    return map->IsSmi() ? CodeSourceMap::null() : map;
+#else
     return untag()->code_source_map();
+#endif
   }
 
+  // Like code_source_map, but first reads a lazily deserialized map and
+  // installs it. May allocate and takes the program lock.
+  CodeSourceMapPtr EnsureCodeSourceMap() const;
+
   void set_code_source_map(const CodeSourceMap& code_source_map) const {
     ASSERT(code_source_map.IsOld());
     untag()->set_code_source_map(code_source_map.ptr());
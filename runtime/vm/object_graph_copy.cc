@@ -7,6 +7,7 @@
 #include "vm/dart_api_state.h"
 #include "vm/flags.h"
 #include "vm/heap/weak_table.h"
+#include "vm/isolate.h"
 #include "vm/longjump.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -170,6 +171,13 @@ static bool CanShareObject(ObjectPtr obj, uword tags) {
     return Closure::RawCast(obj)->untag()->context() == Object::null();
   }
 
+  // Typed data the isolate group explicitly shares is passed by reference
+  // (see Dart_NewSharedTypedData). Views on it are copied but keep referring
+  // to it, which keeps its data alive.
+  if (IsExternalTypedDataClassId(cid)) {
+    return IsolateGroup::Current()->IsSharedTypedData(obj);
+  }
+
   return false;
 }
 
@@ -229,6 +229,11 @@ class ObjectPointerVisitor;
   RW(Array, dispatch_table_code_entries)                                       \
   RW(GrowableObjectArray, instructions_tables)                                 \
   RW(Array, obfuscation_map)                                                   \
+  RW(Array, cold_functions)                                                    \
+  RW(Array, startup_functions)                                                 \
+  RW(KernelProgramInfo, lazy_kernel_program_info)                              \
+  RW(Array, lazy_code_source_maps)                                             \
+  RW(GrowableObjectArray, lazy_library_load_requests)                          \
   RW(GrowableObjectArray, ffi_callback_functions)                              \
   RW(Class, ffi_pointer_class)                                                 \
   RW(Class, ffi_native_type_class)                                             \
@@ -2689,6 +2689,30 @@ ISOLATE_UNIT_TEST_CASE(Code) {
   EXPECT_EQ(1, Smi::Cast(result).Value());
 }
 
+ISOLATE_UNIT_TEST_CASE(Code_EnsureCodeSourceMap) {
+  extern void GenerateIncrement(compiler::Assembler * assembler);
+  compiler::ObjectPoolBuilder object_pool_builder;
+  compiler::Assembler _assembler_(&object_pool_builder);
+  GenerateIncrement(&_assembler_);
+  const Function& function =
+      Function::Handle(CreateFunction("Test_EnsureCodeSourceMap"));
+  SafepointWriteRwLocker locker(thread,
+                                thread->isolate_group()->program_lock());
+  Code& code = Code::Handle(Code::FinalizeCodeAndNotify(
+      function, nullptr, &_assembler_, Code::PoolAttachment::kAttachPool));
+  EXPECT(code.code_source_map() == CodeSourceMap::null());
+  EXPECT(code.EnsureCodeSourceMap() == CodeSourceMap::null());
+
+  const auto& map = CodeSourceMap::Handle(CodeSourceMap::New(0));
+  code.set_code_source_map(map);
+  {
+    // The getter is used on out-of-memory paths and must not allocate.
+    NoSafepointScope no_safepoint;
+    EXPECT(code.code_source_map() == map.ptr());
+  }
+  EXPECT(code.EnsureCodeSourceMap() == map.ptr());
+}
+
 // Test for immutability of generated instructions. The test crashes with a
 // segmentation fault when writing into it.
 ISOLATE_UNIT_TEST_CASE_WITH_EXPECTATION(CodeImmutability, "Crash") {
@@ -13,10 +13,13 @@
 #include "vm/isolate.h"
 #include "vm/lockers.h"
 #include "vm/message_handler.h"
+#include "vm/os.h"
 #include "vm/os_thread.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, message_latency_histograms);
+
 Mutex* PortMap::mutex_ = NULL;
 PortSet<PortMap::Entry>* PortMap::ports_ = NULL;
 MessageHandler* PortMap::deleted_entry_ = reinterpret_cast<MessageHandler*>(1);
@@ -202,22 +205,57 @@ void PortMap::ClosePorts(MessageHandler* handler) {
   handler->CloseAllPorts();
 }
 
-bool PortMap::PostMessage(std::unique_ptr<Message> message,
-                          bool before_events) {
+PortMap::PostResult PortMap::TryPostMessage(std::unique_ptr<Message> message,
+                                            bool before_events) {
+  if (FLAG_message_latency_histograms) {
+    message->set_posted_micros(OS::GetCurrentMonotonicMicros());
+  }
+  {
+    MutexLocker ml(mutex_);
+    if (ports_ == nullptr) {
+      return PostResult::kPortClosed;
+    }
+    auto it = ports_->TryLookup(message->dest_port());
+    if (it == ports_->end()) {
+      // Ownership of external data remains with the poster.
+      message->DropFinalizers();
+      return PostResult::kPortClosed;
+    }
+    MessageHandler* handler = (*it).handler;
+    ASSERT(handler != nullptr);
+    if (handler->PostMessage(std::move(message), before_events)) {
+      return PostResult::kPosted;
+    }
+  }
+  // The receiver is above its queue high-water mark. Ownership of external
+  // data remains with the poster.
+  message->DropFinalizers();
+  if (message->RedirectToDeliveryFailurePort()) {
+    PostMessage(std::move(message));
+  }
+  return PostResult::kQueueFull;
+}
+
+intptr_t PortMap::PostMessages(Dart_Port id,
+                               std::unique_ptr<Message>* messages,
+                               intptr_t count) {
+  if (FLAG_message_latency_histograms) {
+    const int64_t now = OS::GetCurrentMonotonicMicros();
+    for (intptr_t i = 0; i < count; i++) {
+      messages[i]->set_posted_micros(now);
+    }
+  }
   MutexLocker ml(mutex_);
   if (ports_ == nullptr) {
-    return false;
+    return 0;
   }
-  auto it = ports_->TryLookup(message->dest_port());
+  auto it = ports_->TryLookup(id);
   if (it == ports_->end()) {
-    // Ownership of external data remains with the poster.
-    message->DropFinalizers();
-    return false;
+    return 0;
   }
   MessageHandler* handler = (*it).handler;
   ASSERT(handler != nullptr);
-  handler->PostMessage(std::move(message), before_events);
-  return true;
+  return handler->PostMessages(messages, count);
 }
 
 bool PortMap::IsLocalPort(Dart_Port id) {
@@ -338,6 +376,7 @@ void PortMap::PrintPortsForMessageHandler(MessageHandler* handler,
       }
     }
   }
+  handler->PrintQueueStatsJSON(&jsobj);
 #endif
 }
 
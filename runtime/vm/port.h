@@ -47,12 +47,35 @@ class PortMap : public AllStatic {
   // Close all the ports for the provided handler.
   static void ClosePorts(MessageHandler* handler);
 
-  // Enqueues the message in the port with id. Returns false if the port is not
-  // active any longer.
+  enum class PostResult {
+    kPosted,
+    kPortClosed,
+    // The receiving handler's queue is above its high-water mark (see
+    // MessageHandler::SetQueueHighWaterMarks).
+    kQueueFull,
+  };
+
+  // Enqueues the message in the port with id and returns whether it was
+  // posted, or why not.
   //
   // Claims ownership of 'message'.
+  static PostResult TryPostMessage(std::unique_ptr<Message> message,
+                                   bool before_events = false);
+
+  // Like TryPostMessage, but only returns whether the message was posted.
   static bool PostMessage(std::unique_ptr<Message> message,
-                          bool before_events = false);
+                          bool before_events = false) {
+    return TryPostMessage(std::move(message), before_events) ==
+           PostResult::kPosted;
+  }
+
+  // Enqueues [count] normal priority messages, all addressed to port [id],
+  // with a single port lookup. Returns the number of messages posted; they
+  // are posted in order. Entries that were not posted are left in [messages]
+  // and remain owned by the caller.
+  static intptr_t PostMessages(Dart_Port id,
+                               std::unique_ptr<Message>* messages,
+                               intptr_t count);
 
   // Returns whether a port is local to the current isolate.
   static bool IsLocalPort(Dart_Port id);
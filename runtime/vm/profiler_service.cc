@@ -5,6 +5,7 @@
 #include "vm/profiler_service.h"
 
 #include "platform/text_buffer.h"
+#include "vm/dart.h"
 #include "vm/growable_array.h"
 #include "vm/hash_map.h"
 #include "vm/heap/safepoint.h"
@@ -1808,6 +1809,50 @@ void ProfilerService::PrintJSON(JSONStream* stream,
                 include_code_samples);
 }
 
+void ProfilerService::WriteAotProfile(Thread* thread, const char* filename) {
+  SampleBlockBuffer* sample_block_buffer = Profiler::sample_block_buffer();
+  if (sample_block_buffer == nullptr) {
+    OS::PrintErr("warning: Writing an AOT profile requires --profiler.\n");
+    return;
+  }
+  if ((Dart::file_write_callback() == nullptr) ||
+      (Dart::file_open_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("warning: Could not access file callbacks.\n");
+    return;
+  }
+
+  StackZone zone(thread);
+  Isolate* isolate = thread->isolate();
+  NoAllocationSampleFilter filter(isolate->main_port(), Thread::kMutatorTask,
+                                  -1, -1);
+  Profile profile;
+  profile.Build(thread, &filter, sample_block_buffer);
+
+  TextBuffer buffer(64 * KB);
+  // Tells gen_snapshot that functions missing from the profile may have run.
+  buffer.AddString("sampled\n");
+  for (intptr_t i = 0; i < profile.NumFunctions(); i++) {
+    ProfileFunction* function = profile.GetFunction(i);
+    if ((function->kind() != ProfileFunction::kDartFunction) ||
+        (function->inclusive_ticks() == 0)) {
+      continue;
+    }
+    // Without token positions, closures of the same name cannot be told
+    // apart, and are listed by their name (see AotProfile::LookupFunction).
+    buffer.Printf("function %" Pd " %s\n", function->inclusive_ticks(),
+                  function->function()->ToFullyQualifiedCString());
+  }
+
+  void* file = Dart::file_open_callback()(filename, /*write=*/true);
+  if (file == nullptr) {
+    OS::PrintErr("warning: Failed to write AOT profile: %s\n", filename);
+    return;
+  }
+  Dart::file_write_callback()(buffer.buffer(), buffer.length(), file);
+  Dart::file_close_callback()(file);
+}
+
 class AllocationSampleFilter : public SampleFilter {
  public:
   AllocationSampleFilter(Dart_Port port,
@@ -443,6 +443,12 @@ class ProfilerService : public AllStatic {
 
   static void ClearSamples();
 
+  // Writes the Dart functions sampled in the current isolate to [filename]
+  // in the format of an AOT profile marked as sampled, with the inclusive
+  // ticks of a function as its count. Only the samples still held in
+  // the sample buffer are taken into account.
+  static void WriteAotProfile(Thread* thread, const char* filename);
+
  private:
   static void PrintJSONImpl(Thread* thread,
                             JSONStream* stream,
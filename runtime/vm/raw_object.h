@@ -2780,6 +2780,8 @@ class UntaggedPointerBase : public UntaggedInstance {
 
  private:
   RAW_HEAP_OBJECT_IMPLEMENTATION(PointerBase);
+
+  friend class IsolateGroup;  // IsSharedTypedData
 };
 
 // Abstract base class for RawTypedData/RawExternalTypedData/RawTypedDataView.
@@ -20,6 +20,7 @@
 #include "vm/heap/verifier.h"
 #include "vm/instructions.h"
 #include "vm/kernel_isolate.h"
+#include "vm/kernel_loader.h"
 #include "vm/message.h"
 #include "vm/message_handler.h"
 #include "vm/object_store.h"
@@ -206,7 +207,7 @@ static void DoThrowNullError(Isolate* isolate,
   }
 
   const CodeSourceMap& map =
-      CodeSourceMap::Handle(zone, code.code_source_map());
+      CodeSourceMap::Handle(zone, code.EnsureCodeSourceMap());
   String& member_name = String::Handle(zone);
   if (!map.IsNull()) {
     CodeSourceMapReader reader(map, Array::null_array(),
@@ -2945,6 +2946,10 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
   if (Compiler::CanOptimizeFunction(thread, function)) {
     auto isolate_group = thread->isolate_group();
     if (FLAG_background_compilation) {
+      // A previous background compilation may have stopped at a library
+      // that was not loaded yet.
+      ThrowIfError(Object::Handle(
+          zone, kernel::KernelLoader::LoadLibrariesRequestedByCompiler()));
       if (isolate_group->background_compiler()->EnqueueCompilation(function)) {
         // Reduce the chance of triggering a compilation while the function is
         // being compiled in the background. INT32_MIN should ensure that it
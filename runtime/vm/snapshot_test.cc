@@ -23,6 +23,10 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, compress_snapshot_data);
+DECLARE_FLAG(bool, print_snapshot_load_stats);
+DECLARE_FLAG(int, snapshot_fill_tasks);
+
 // Check if serialized and deserialized objects are equal.
 static bool Equals(const Object& expected, const Object& actual) {
   if (expected.IsNull()) {
@@ -673,7 +677,7 @@ ISOLATE_UNIT_TEST_CASE(SerializeEmptyByteArray) {
   CheckEncodeDecodeMessage(scope.zone(), root);
 }
 
-VM_UNIT_TEST_CASE(FullSnapshot) {
+static void TestFullSnapshot() {
   // clang-format off
   auto kScriptChars = Utils::CStringUniquePtr(
       OS::SCreate(
@@ -760,6 +764,33 @@ VM_UNIT_TEST_CASE(FullSnapshot) {
   free(isolate_snapshot_data_buffer);
 }
 
+VM_UNIT_TEST_CASE(FullSnapshot) {
+  TestFullSnapshot();
+}
+
+// Independent clusters are filled on the loading thread only.
+VM_UNIT_TEST_CASE(FullSnapshot_SequentialFill) {
+  SetFlagScope<int> sfs(&FLAG_snapshot_fill_tasks, 0);
+  TestFullSnapshot();
+}
+
+VM_UNIT_TEST_CASE(FullSnapshot_LoadStats) {
+  SetFlagScope<bool> sfs(&FLAG_print_snapshot_load_stats, true);
+  TestFullSnapshot();
+  const Deserializer::LoadStats stats = Deserializer::last_load_stats();
+  // Hashes of all strings come from the snapshot, and the canonical tables of
+  // a primary snapshot are built from its layout, so nothing is rehashed.
+  EXPECT(stats.strings > 0);
+  EXPECT_EQ(0, stats.canonicalized_objects);
+  EXPECT(stats.post_load >= stats.canonicalize);
+  EXPECT(stats.alloc >= stats.canonical_sets);
+}
+
+VM_UNIT_TEST_CASE(FullSnapshot_Compressed) {
+  SetFlagScope<bool> sfs(&FLAG_compress_snapshot_data, true);
+  TestFullSnapshot();
+}
+
 // Helper function to call a top level Dart function and serialize the result.
 static std::unique_ptr<Message> GetSerialized(Dart_Handle lib,
                                               const char* dart_function) {
@@ -1972,6 +2003,58 @@ VM_UNIT_TEST_CASE(PostCObject) {
   Dart_ExitScope();
 }
 
+VM_UNIT_TEST_CASE(PostCObjectBatch) {
+  // Create a native port for posting from C to Dart
+  TestIsolateScope __test_isolate__;
+  const char* kScriptChars =
+      "import 'dart:isolate';\n"
+      "main() {\n"
+      "  var messageCount = 0;\n"
+      "  var exception = '';\n"
+      "  var port = new RawReceivePort();\n"
+      "  var sendPort = port.sendPort;\n"
+      "  port.handler = (message) {\n"
+      "    exception = '$exception${message}';\n"
+      "    messageCount++;\n"
+      "    if (messageCount == 4) throw new Exception(exception);\n"
+      "  };\n"
+      "  return sendPort;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_EnterScope();
+
+  Dart_Handle send_port = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(send_port);
+  Dart_Port port_id;
+  Dart_Handle result = Dart_SendPortGetId(send_port, &port_id);
+  ASSERT(!Dart_IsError(result));
+
+  Dart_CObject objects[4];
+  Dart_CObject* batch[4];
+  objects[0].type = Dart_CObject_kInt32;
+  objects[0].value.as_int32 = 1;
+  objects[1].type = Dart_CObject_kString;
+  objects[1].value.as_string = const_cast<char*>("two");
+  objects[2].type = Dart_CObject_kDouble;
+  objects[2].value.as_double = 3.5;
+  objects[3].type = Dart_CObject_kBool;
+  objects[3].value.as_bool = true;
+  for (intptr_t i = 0; i < 4; i++) {
+    batch[i] = &objects[i];
+  }
+
+  EXPECT_EQ(0, Dart_PostCObjectBatch(port_id, 0, batch));
+  EXPECT_EQ(0, Dart_PostCObjectBatch(ILLEGAL_PORT, 4, batch));
+  EXPECT_EQ(4, Dart_PostCObjectBatch(port_id, 4, batch));
+
+  result = Dart_RunLoop();
+  EXPECT(Dart_IsError(result));
+  EXPECT(Dart_ErrorHasException(result));
+  EXPECT_SUBSTRING("Exception: 1two3.5true\n", Dart_GetError(result));
+
+  Dart_ExitScope();
+}
+
 TEST_CASE(IsKernelNegative) {
   EXPECT(!Dart_IsKernel(NULL, 0));
 
@@ -0,0 +1,260 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/startup_trace.h"
+
+#include "vm/dart.h"
+#include "vm/flags.h"
+#include "vm/hash_map.h"
+#include "vm/lockers.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/program_visitor.h"
+
+namespace dart {
+
+DEFINE_FLAG(charp,
+            trace_startup_accesses_to,
+            nullptr,
+            "Write the functions called during startup to the given file.");
+DEFINE_FLAG(int,
+            trace_startup_accesses_millis,
+            5000,
+            "Functions first called within this many milliseconds of VM "
+            "startup are recorded by --trace_startup_accesses_to.");
+DEFINE_FLAG(charp,
+            order_by_startup_trace,
+            nullptr,
+            "Place the code of the functions listed in the given startup "
+            "trace first in the AOT snapshot.");
+
+Mutex* StartupTrace::mutex_ = nullptr;
+void* StartupTrace::file_ = nullptr;
+
+void StartupTrace::Init() {
+  ASSERT(mutex_ == nullptr);
+  mutex_ = new Mutex();
+
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  const char* filename = FLAG_trace_startup_accesses_to;
+  if (filename == nullptr) {
+    return;
+  }
+  if ((Dart::file_write_callback() == nullptr) ||
+      (Dart::file_open_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("warning: Could not access file callbacks.\n");
+    return;
+  }
+  file_ = Dart::file_open_callback()(filename, /*write=*/true);
+  if (file_ == nullptr) {
+    OS::PrintErr("warning: Failed to write startup trace: %s\n", filename);
+  }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+}
+
+void StartupTrace::Cleanup() {
+  if (file_ != nullptr) {
+    Dart::file_close_callback()(file_);
+    file_ = nullptr;
+  }
+  delete mutex_;
+  mutex_ = nullptr;
+}
+
+#if !defined(DART_PRECOMPILED_RUNTIME)
+void StartupTrace::RecordFunction(const Function& function) {
+  if (file_ == nullptr) {
+    return;
+  }
+  if (Dart::UptimeMillis() > FLAG_trace_startup_accesses_millis) {
+    return;
+  }
+  const char* name = FunctionKey(Thread::Current()->zone(), function);
+  MutexLocker ml(mutex_);
+  if (file_ != nullptr) {
+    Dart::file_write_callback()(name, strlen(name), file_);
+    Dart::file_write_callback()("\n", 1, file_);
+  }
+}
+
+const char* StartupTrace::FunctionKey(Zone* zone, const Function& function) {
+  const char* name = function.ToFullyQualifiedCString();
+  if (!function.IsClosureFunction()) {
+    return name;
+  }
+  return OS::SCreate(zone, "%s@%s", name, function.token_pos().ToCString());
+}
+
+// Maps each function key in the trace to its position in the trace.
+static void ParseStartupTrace(Zone* zone,
+                              const char* contents,
+                              intptr_t length,
+                              CStringIntMap* ranks) {
+  intptr_t rank = 0;
+  intptr_t line_start = 0;
+  for (intptr_t i = 0; i <= length; i++) {
+    if (i < length && contents[i] != '\n') continue;
+    intptr_t line_end = i;
+    if (line_end > line_start && contents[line_end - 1] == '\r') {
+      line_end--;
+    }
+    if (line_end > line_start) {
+      const char* name = zone->MakeCopyOfStringN(contents + line_start,
+                                                 line_end - line_start);
+      if (!ranks->HasKey(name)) {
+        ranks->Insert({name, rank++});
+      }
+    }
+    line_start = i + 1;
+  }
+}
+
+struct StartupFunction {
+  const Function* function;
+  intptr_t rank;
+};
+
+static int CompareStartupFunctions(StartupFunction const* a,
+                                   StartupFunction const* b) {
+  if (a->rank < b->rank) return -1;
+  if (a->rank > b->rank) return 1;
+  return 0;
+}
+
+// Collects the functions with code which are listed in a startup trace.
+class StartupFunctionCollector : public FunctionVisitor {
+ public:
+  StartupFunctionCollector(Zone* zone, const CStringIntMap& ranks)
+      : zone_(zone), ranks_(ranks), functions_(zone, 0) {}
+
+  void VisitFunction(const Function& function) {
+    if (!function.HasCode()) {
+      return;
+    }
+    const intptr_t rank =
+        ranks_.LookupValue(StartupTrace::FunctionKey(zone_, function));
+    if (rank != CStringIntMapKeyValueTrait::kNoValue) {
+      functions_.Add({&Function::ZoneHandle(zone_, function.ptr()), rank});
+    }
+  }
+
+  GrowableArray<StartupFunction>* functions() { return &functions_; }
+
+ private:
+  Zone* zone_;
+  const CStringIntMap& ranks_;
+  GrowableArray<StartupFunction> functions_;
+};
+
+ArrayPtr StartupTrace::ReadStartupFunctions(Thread* thread) {
+  const char* filename = FLAG_order_by_startup_trace;
+  if (filename == nullptr) {
+    return Array::null();
+  }
+  if ((Dart::file_read_callback() == nullptr) ||
+      (Dart::file_open_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("warning: Could not access file callbacks.\n");
+    return Array::null();
+  }
+  void* file = Dart::file_open_callback()(filename, /*write=*/false);
+  if (file == nullptr) {
+    OS::PrintErr("warning: Failed to read startup trace: %s\n", filename);
+    return Array::null();
+  }
+  uint8_t* data = nullptr;
+  intptr_t length = 0;
+  Dart::file_read_callback()(&data, &length, file);
+  Dart::file_close_callback()(file);
+  if (data == nullptr || length < 0) {
+    OS::PrintErr("warning: Failed to read startup trace: %s\n", filename);
+    return Array::null();
+  }
+  const auto& functions = Array::Handle(
+      thread->zone(),
+      StartupFunctions(thread, reinterpret_cast<const char*>(data), length));
+  // The embedder's read callback allocates the buffer with malloc.
+  free(data);
+  if (functions.Length() == 0) {
+    if (length > 0) {
+      OS::PrintErr("warning: No function of the startup trace was found: %s\n",
+                   filename);
+    }
+    return Array::null();
+  }
+  return functions.ptr();
+}
+
+ArrayPtr StartupTrace::StartupFunctions(Thread* thread,
+                                        const char* trace,
+                                        intptr_t length) {
+  Zone* zone = thread->zone();
+  CStringIntMap ranks(zone);
+  ParseStartupTrace(zone, trace, length, &ranks);
+
+  StartupFunctionCollector collector(zone, ranks);
+  ProgramVisitor::WalkProgram(zone, thread->isolate_group(), &collector);
+  GrowableArray<StartupFunction>* found = collector.functions();
+  found->Sort(CompareStartupFunctions);
+  const auto& functions = Array::Handle(zone, Array::New(found->length()));
+  for (intptr_t i = 0; i < found->length(); i++) {
+    functions.SetAt(i, *found->At(i).function);
+  }
+  return functions.ptr();
+}
+
+struct StartupOrderInfo {
+  CodePtr code;
+  intptr_t rank;
+  intptr_t original_index;
+};
+
+static int CompareStartupOrderInfo(StartupOrderInfo const* a,
+                                   StartupOrderInfo const* b) {
+  if (a->rank < b->rank) return -1;
+  if (a->rank > b->rank) return 1;
+  if (a->original_index < b->original_index) return -1;
+  if (a->original_index > b->original_index) return 1;
+  return 0;
+}
+
+void StartupTrace::OrderCodeObjects(Thread* thread,
+                                    GrowableArray<CodePtr>* codes) {
+  Zone* zone = thread->zone();
+  const auto& functions = Array::Handle(
+      zone, thread->isolate_group()->object_store()->startup_functions());
+  if (functions.IsNull()) {
+    return;
+  }
+  // Maps each startup function to its position in the trace.
+  IntMap<intptr_t> ranks(zone);
+  for (intptr_t i = 0; i < functions.Length(); i++) {
+    ranks.Insert(static_cast<intptr_t>(static_cast<uword>(functions.At(i))),
+                 i);
+  }
+
+  GrowableArray<StartupOrderInfo> order_list(zone, codes->length());
+  Code& code = Code::Handle(zone);
+  for (intptr_t i = 0; i < codes->length(); i++) {
+    code = codes->At(i);
+    intptr_t rank = kIntptrMax;
+    if (code.IsFunctionCode()) {
+      IntMap<intptr_t>::Pair* pair = ranks.LookupPair(
+          static_cast<intptr_t>(static_cast<uword>(code.function())));
+      if (pair != nullptr) {
+        rank = pair->value;
+      }
+    }
+    order_list.Add({code.ptr(), rank, i});
+  }
+  order_list.Sort(CompareStartupOrderInfo);
+  for (intptr_t i = 0; i < order_list.length(); i++) {
+    (*codes)[i] = order_list[i].code;
+  }
+}
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
+}  // namespace dart
@@ -0,0 +1,65 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_STARTUP_TRACE_H_
+#define RUNTIME_VM_STARTUP_TRACE_H_
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+#include "vm/tagged_pointer.h"
+
+namespace dart {
+
+class Function;
+class Mutex;
+class Thread;
+class Zone;
+
+// A startup trace lists the functions that run during startup, one per line
+// (see FunctionKey), in the order they were first called.
+//
+// The JIT records a trace with --trace_startup_accesses_to. gen_snapshot reads
+// it back with --order_by_startup_trace and places the code of the listed
+// functions first, so that starting an AOT binary touches a small contiguous
+// range of the instructions image instead of faulting pages in all over it.
+class StartupTrace : public AllStatic {
+ public:
+  static void Init();
+  static void Cleanup();
+
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  // Appends [function] to the trace if tracing is enabled and startup has not
+  // finished yet. Called when a function is compiled for its first call.
+  static void RecordFunction(const Function& function);
+
+  // Returns the functions with code listed in the --order_by_startup_trace
+  // file, in trace order, or null if no trace was requested or none of its
+  // functions was found. The precompiler reads the trace once and keeps the
+  // result in the object store for OrderCodeObjects.
+  static ArrayPtr ReadStartupFunctions(Thread* thread);
+
+  // Like above, but with the [length] bytes of a startup trace in [trace].
+  // Returns an empty array if none of its functions was found.
+  static ArrayPtr StartupFunctions(Thread* thread,
+                                   const char* trace,
+                                   intptr_t length);
+
+  // Moves the code of the startup functions of the object store to the front
+  // of [codes], in trace order. Other code keeps its relative order.
+  static void OrderCodeObjects(Thread* thread, GrowableArray<CodePtr>* codes);
+
+  // The line identifying [function] in a startup trace: its fully qualified
+  // name, followed by its token position for closures, since several
+  // closures of one function share a name.
+  static const char* FunctionKey(Zone* zone, const Function& function);
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
+ private:
+  static Mutex* mutex_;
+  static void* file_;
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_STARTUP_TRACE_H_
@@ -0,0 +1,90 @@
+// Copyright (c) 2021, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/startup_trace.h"
+
+#include "platform/assert.h"
+#include "vm/compiler/jit/compiler.h"
+#include "vm/dart_api_impl.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if !defined(DART_PRECOMPILED_RUNTIME)
+
+TEST_CASE(StartupTrace_OrderCodeObjects) {
+  const char* kScript = R"(
+    foo() => 1;
+    main() => [() => foo(), () => foo()];
+  )";
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, nullptr);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, nullptr);
+  EXPECT_VALID(result);
+
+  TransitionNativeToVM transition(thread);
+  Zone* zone = thread->zone();
+  const auto& closures =
+      GrowableObjectArray::CheckedHandle(zone, Api::UnwrapHandle(result));
+  auto& function = Function::Handle(zone);
+  auto& error = Object::Handle(zone);
+  const Code* closure_codes[2];
+  const char* names[2];
+  const char* keys[2];
+  for (intptr_t i = 0; i < 2; i++) {
+    function = Closure::Cast(Object::Handle(zone, closures.At(i))).function();
+    error = Compiler::CompileFunction(thread, function);
+    EXPECT(!error.IsError());
+    closure_codes[i] = &Code::Handle(zone, function.CurrentCode());
+    names[i] = function.ToFullyQualifiedCString();
+    keys[i] = StartupTrace::FunctionKey(zone, function);
+  }
+  // Both closures have the same name, but they must not share a key.
+  EXPECT_STREQ(names[0], names[1]);
+  EXPECT(strcmp(keys[0], keys[1]) != 0);
+
+  const auto& library =
+      Library::Handle(zone, Library::RawCast(Api::UnwrapHandle(lib)));
+  function =
+      library.LookupLocalFunction(String::Handle(zone, String::New("foo")));
+  error = Compiler::CompileFunction(thread, function);
+  EXPECT(!error.IsError());
+  const auto& foo = Code::Handle(zone, function.CurrentCode());
+
+  // Listed functions are found in trace order, unknown lines are ignored.
+  const char* trace = OS::SCreate(zone, "%s\nunknown\n%s\n",
+                                  StartupTrace::FunctionKey(zone, function),
+                                  keys[1]);
+  const auto& startup_functions = Array::Handle(
+      zone, StartupTrace::StartupFunctions(thread, trace, strlen(trace)));
+  EXPECT_EQ(2, startup_functions.Length());
+  EXPECT(startup_functions.At(0) == function.ptr());
+
+  // Their code moves to the front in trace order.
+  ObjectStore* object_store = thread->isolate_group()->object_store();
+  object_store->set_startup_functions(startup_functions);
+  GrowableArray<CodePtr> codes;
+  codes.Add(closure_codes[0]->ptr());
+  codes.Add(closure_codes[1]->ptr());
+  codes.Add(foo.ptr());
+  StartupTrace::OrderCodeObjects(thread, &codes);
+  object_store->set_startup_functions(Array::null_array());
+  EXPECT_EQ(3, codes.length());
+  EXPECT(codes[0] == foo.ptr());
+  EXPECT(codes[1] == closure_codes[1]->ptr());
+  EXPECT(codes[2] == closure_codes[0]->ptr());
+
+  // A trace of another program lists no startup function.
+  const char* other_trace = "unknown\n";
+  EXPECT_EQ(0, Array::Handle(zone, StartupTrace::StartupFunctions(
+                                       thread, other_trace,
+                                       strlen(other_trace)))
+                   .Length());
+}
+
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
+}  // namespace dart
@@ -6,6 +6,7 @@
 
 #include "vm/dart.h"
 #include "vm/flags.h"
+#include "vm/json_stream.h"
 #include "vm/lockers.h"
 
 namespace dart {
@@ -14,6 +15,11 @@ DEFINE_FLAG(int,
             worker_timeout_millis,
             5000,
             "Free workers when they have been idle for this amount of time.");
+DEFINE_FLAG(bool,
+            thread_pool_local_queues,
+            true,
+            "Queue tasks scheduled via ThreadPool::RunLocal on the scheduling "
+            "worker when all workers of a bounded pool are busy.");
 
 static int64_t ComputeTimeout(int64_t idle_start) {
   int64_t worker_timeout_micros =
@@ -83,6 +89,7 @@ void ThreadPool::Shutdown() {
 
 bool ThreadPool::RunImpl(std::unique_ptr<Task> task) {
   Worker* new_worker = nullptr;
+  task->scheduled_micros_ = OS::GetCurrentMonotonicMicros();
   {
     MonitorLocker ml(&pool_monitor_);
     if (shutting_down_) {
@@ -96,10 +103,44 @@ bool ThreadPool::RunImpl(std::unique_ptr<Task> task) {
   return true;
 }
 
+bool ThreadPool::RunLocalImpl(std::unique_ptr<Task> task) {
+  Worker* worker = CurrentWorker();
+  // Only queue locally if scheduling on the shared task list would neither
+  // wake an idle worker nor start a new one. The local task is then run by
+  // this worker after its current task, or stolen by whichever worker runs
+  // out of work first.
+  if (!FLAG_thread_pool_local_queues || worker == nullptr ||
+      worker->is_blocked_ || max_pool_size_ == 0 || count_idle_ > 0 ||
+      (count_running_ < max_pool_size_)) {
+    return RunImpl(std::move(task));
+  }
+  if (shutting_down_) {
+    return false;
+  }
+  task->scheduled_micros_ = OS::GetCurrentMonotonicMicros();
+  worker->PushLocalTask(std::move(task));
+
+  // A worker may have turned idle after the check above. It scans the local
+  // queues after incrementing [count_idle_], so either it sees our task or we
+  // see it as idle here and wake it up.
+  if (count_idle_ > 0) {
+    MonitorLocker ml(&pool_monitor_);
+    ml.Notify();
+  }
+  return true;
+}
+
 bool ThreadPool::CurrentThreadIsWorker() {
+  return CurrentWorker() != nullptr;
+}
+
+ThreadPool::Worker* ThreadPool::CurrentWorker() {
   auto worker =
       static_cast<Worker*>(OSThread::Current()->owning_thread_pool_worker_);
-  return worker != nullptr && worker->pool_ == this;
+  if (worker == nullptr || worker->pool_ != this) {
+    return nullptr;
+  }
+  return worker;
 }
 
 void ThreadPool::MarkCurrentWorkerAsBlocked() {
@@ -110,8 +151,17 @@ void ThreadPool::MarkCurrentWorkerAsBlocked() {
     MonitorLocker ml(&pool_monitor_);
     ASSERT(!worker->is_blocked_);
     worker->is_blocked_ = true;
+    // Tasks queued behind a blocked worker must not wait for it to unblock,
+    // hand them over to the other workers.
+    const intptr_t moved = worker->MoveLocalTasksTo(&tasks_);
+    if (moved > 0) {
+      pending_tasks_ += moved;
+      if (!idle_workers_.IsEmpty()) {
+        ml.NotifyAll();
+      }
+    }
     if (max_pool_size_ > 0) {
-      ++max_pool_size_;
+      max_pool_size_++;
       // This thread is blocked and therefore no longer usable as a worker.
       // If we have pending tasks and there are no idle workers, we will spawn a
       // new thread (temporarily allow exceeding the maximum pool size) to
@@ -136,7 +186,7 @@ void ThreadPool::MarkCurrentWorkerAsUnBlocked() {
     if (worker->is_blocked_) {
       worker->is_blocked_ = false;
       if (max_pool_size_ > 0) {
-        --max_pool_size_;
+        max_pool_size_--;
         ASSERT(max_pool_size_ > 0);
       }
     }
@@ -149,23 +199,32 @@ void ThreadPool::WorkerLoop(Worker* worker) {
   while (true) {
     MonitorLocker ml(&pool_monitor_);
 
-    if (!tasks_.IsEmpty()) {
+    std::unique_ptr<Task> task = NextTaskLocked(worker);
+    if (task != nullptr) {
       IdleToRunningLocked(worker);
-      while (!tasks_.IsEmpty()) {
-        std::unique_ptr<Task> task(tasks_.RemoveFirst());
-        pending_tasks_--;
-        MonitorLeaveScope mls(&ml);
-        task->Run();
-        ASSERT(Isolate::Current() == nullptr);
-        task.reset();
+      while (task != nullptr) {
+        {
+          MonitorLeaveScope mls(&ml);
+          // Drain our own local run queue without taking the pool monitor.
+          while (task != nullptr) {
+            RecordTaskStart(task.get());
+            task->Run();
+            ASSERT(Isolate::Current() == nullptr);
+            task = worker->PopLocalTask();
+          }
+        }
+        task = NextTaskLocked(worker);
       }
       RunningToIdleLocked(worker);
+      // Look for work again now that we are counted as idle, see
+      // [RunLocalImpl].
+      continue;
     }
 
     if (running_workers_.IsEmpty()) {
       ASSERT(tasks_.IsEmpty());
       OnEnterIdleLocked(&ml);
-      if (!tasks_.IsEmpty()) {
+      if (TasksWaitingToRunLocked()) {
         continue;
       }
     }
@@ -183,7 +242,7 @@ void ThreadPool::WorkerLoop(Worker* worker) {
       const auto result = ml.WaitMicros(ComputeTimeout(idle_start));
 
       // We have to drain all pending tasks.
-      if (!tasks_.IsEmpty()) break;
+      if (!tasks_.IsEmpty() || HasStealableTasksLocked()) break;
 
       if (shutting_down_ || result == Monitor::kTimedOut) {
         done = true;
@@ -204,6 +263,58 @@ void ThreadPool::WorkerLoop(Worker* worker) {
   JoinDeadWorkersLocked(&dead_workers_to_join);
 }
 
+std::unique_ptr<ThreadPool::Task> ThreadPool::NextTaskLocked(
+    Worker* worker) {
+  if (!tasks_.IsEmpty()) {
+    pending_tasks_--;
+    return std::unique_ptr<Task>(tasks_.RemoveFirst());
+  }
+  // Local queues are checked under their mutex rather than via
+  // [local_task_count_], see [RunLocalImpl].
+  for (Worker* victim : running_workers_) {
+    if (victim == worker) continue;
+    std::unique_ptr<Task> task = victim->StealLocalTask();
+    if (task != nullptr) {
+      tasks_stolen_++;
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+bool ThreadPool::HasStealableTasksLocked() {
+  for (Worker* worker : running_workers_) {
+    MutexLocker ml(&worker->local_tasks_mutex_);
+    if (!worker->local_tasks_.IsEmpty()) return true;
+  }
+  return false;
+}
+
+void ThreadPool::RecordTaskStart(Task* task) {
+  int64_t waited = OS::GetCurrentMonotonicMicros() - task->scheduled_micros_;
+  if (waited < 0) waited = 0;
+  tasks_started_++;
+  total_wait_micros_ += static_cast<uint64_t>(waited);
+  uint64_t max = max_wait_micros_;
+  while ((static_cast<uint64_t>(waited) > max) &&
+         !max_wait_micros_.compare_exchange_weak(max, waited)) {
+  }
+}
+
+#ifndef PRODUCT
+void ThreadPool::PrintJSON(JSONObject* jsobj) {
+  JSONObject pool(jsobj, "_threadPool");
+  pool.AddProperty64("maxWorkers", max_pool_size_);
+  pool.AddProperty64("runningWorkers", count_running_);
+  pool.AddProperty64("idleWorkers", count_idle_);
+  pool.AddProperty64("tasksStarted", tasks_started_);
+  pool.AddProperty64("tasksRunLocally", tasks_run_locally_);
+  pool.AddProperty64("tasksStolen", tasks_stolen_);
+  pool.AddProperty64("totalWaitMicros", total_wait_micros_);
+  pool.AddProperty64("maxWaitMicros", max_wait_micros_);
+}
+#endif  // !PRODUCT
+
 void ThreadPool::IdleToRunningLocked(Worker* worker) {
   ASSERT(idle_workers_.ContainsForDebugging(worker));
   idle_workers_.Remove(worker);
@@ -292,6 +403,34 @@ ThreadPool::Worker* ThreadPool::ScheduleTaskLocked(MonitorLocker* ml,
 ThreadPool::Worker::Worker(ThreadPool* pool)
     : pool_(pool), join_id_(OSThread::kInvalidThreadJoinId) {}
 
+void ThreadPool::Worker::PushLocalTask(std::unique_ptr<Task> task) {
+  MutexLocker ml(&local_tasks_mutex_);
+  local_tasks_.Append(task.release());
+  local_task_count_++;
+  pool_->tasks_run_locally_++;
+}
+
+std::unique_ptr<ThreadPool::Task> ThreadPool::Worker::PopLocalTask() {
+  // Only this worker adds local tasks, so a zero count cannot be stale.
+  if (local_task_count_ == 0) return nullptr;
+  return StealLocalTask();
+}
+
+std::unique_ptr<ThreadPool::Task> ThreadPool::Worker::StealLocalTask() {
+  MutexLocker ml(&local_tasks_mutex_);
+  if (local_tasks_.IsEmpty()) return nullptr;
+  local_task_count_--;
+  return std::unique_ptr<Task>(local_tasks_.RemoveFirst());
+}
+
+intptr_t ThreadPool::Worker::MoveLocalTasksTo(TaskList* tasks) {
+  MutexLocker ml(&local_tasks_mutex_);
+  const intptr_t count = local_task_count_;
+  tasks->AppendList(&local_tasks_);
+  local_task_count_ = 0;
+  return count;
+}
+
 void ThreadPool::Worker::StartThread() {
   int result = OSThread::Start("DartWorker", &Worker::Main,
                                reinterpret_cast<uword>(this));
@@ -8,6 +8,7 @@
 #include <memory>
 #include <utility>
 
+#include "platform/atomic.h"
 #include "vm/allocation.h"
 #include "vm/globals.h"
 #include "vm/intrusive_dlist.h"
@@ -15,6 +16,7 @@
 
 namespace dart {
 
+class JSONObject;
 class MonitorLocker;
 
 class ThreadPool {
@@ -31,9 +33,16 @@ class ThreadPool {
     virtual void Run() = 0;
 
    private:
+    friend class ThreadPool;
+
+    // When the task was handed to the pool, used for latency statistics.
+    int64_t scheduled_micros_ = 0;
+
     DISALLOW_COPY_AND_ASSIGN(Task);
   };
 
+  using TaskList = IntrusiveDList<Task>;
+
   explicit ThreadPool(uintptr_t max_pool_size = 0);
 
   // Prevent scheduling of new tasks, wait until all pending tasks are done
@@ -46,6 +55,20 @@ class ThreadPool {
     return RunImpl(std::unique_ptr<Task>(new T(std::forward<Args>(args)...)));
   }
 
+  // Runs a task on the thread pool, preferring the local run queue of the
+  // current worker if called from a worker of this pool while all workers are
+  // busy. The current worker runs its local tasks once its current task
+  // finishes, without going through the shared task list, and other workers
+  // steal them when they run out of work.
+  //
+  // Only use this for tasks the current task never waits for; otherwise the
+  // current worker could wait for a task queued behind itself.
+  template <typename T, typename... Args>
+  bool RunLocal(Args&&... args) {
+    return RunLocalImpl(
+        std::unique_ptr<Task>(new T(std::forward<Args>(args)...)));
+  }
+
   // Returns `true` if the current thread is runing on the [this] thread pool.
   bool CurrentThreadIsWorker();
 
@@ -66,6 +89,17 @@ class ThreadPool {
   // Exposed for unit test in thread_pool_test.cc
   uint64_t workers_stopped() const { return count_dead_; }
 
+  // Statistics about the time tasks spend waiting for a worker.
+  uint64_t tasks_started() const { return tasks_started_; }
+  uint64_t tasks_run_locally() const { return tasks_run_locally_; }
+  uint64_t tasks_stolen() const { return tasks_stolen_; }
+  uint64_t total_wait_micros() const { return total_wait_micros_; }
+  uint64_t max_wait_micros() const { return max_wait_micros_; }
+
+#ifndef PRODUCT
+  void PrintJSON(JSONObject* jsobj);
+#endif  // !PRODUCT
+
  private:
   class Worker : public IntrusiveDListEntry<Worker> {
    public:
@@ -78,6 +112,13 @@ class ThreadPool {
    private:
     friend class ThreadPool;
 
+    // Local run queue, filled by ThreadPool::RunLocal from tasks running on
+    // this worker and drained by this worker or by stealing workers.
+    void PushLocalTask(std::unique_ptr<Task> task);
+    std::unique_ptr<Task> PopLocalTask();
+    std::unique_ptr<Task> StealLocalTask();
+    intptr_t MoveLocalTasksTo(TaskList* tasks);
+
     // The main entry point for new worker threads.
     static void Main(uword args);
 
@@ -88,6 +129,10 @@ class ThreadPool {
     OSThread* os_thread_ = nullptr;
     bool is_blocked_ = false;
 
+    Mutex local_tasks_mutex_;
+    TaskList local_tasks_;
+    RelaxedAtomic<intptr_t> local_task_count_ = 0;
+
     DISALLOW_COPY_AND_ASSIGN(Worker);
   };
 
@@ -102,15 +147,28 @@ class ThreadPool {
   bool ShuttingDownLocked() { return shutting_down_; }
 
   // Whether new tasks are ready to be run.
-  bool TasksWaitingToRunLocked() { return !tasks_.IsEmpty(); }
+  bool TasksWaitingToRunLocked() {
+    return !tasks_.IsEmpty() || HasStealableTasksLocked();
+  }
 
  private:
-  using TaskList = IntrusiveDList<Task>;
   using WorkerList = IntrusiveDList<Worker>;
 
   bool RunImpl(std::unique_ptr<Task> task);
+  bool RunLocalImpl(std::unique_ptr<Task> task);
   void WorkerLoop(Worker* worker);
 
+  // Returns the worker of this pool the current thread runs on, if any.
+  Worker* CurrentWorker();
+
+  // Takes the next task from the shared task list, or steals one from the
+  // local run queue of a running worker.
+  std::unique_ptr<Task> NextTaskLocked(Worker* worker);
+  bool HasStealableTasksLocked();
+
+  // Records the time [task] waited for a worker.
+  void RecordTaskStart(Task* task);
+
   Worker* ScheduleTaskLocked(MonitorLocker* ml, std::unique_ptr<Task> task);
 
   void IdleToRunningLocked(Worker* worker);
@@ -120,9 +178,11 @@ class ThreadPool {
   void JoinDeadWorkersLocked(WorkerList* dead_workers_to_join);
 
   Monitor pool_monitor_;
-  bool shutting_down_ = false;
-  uint64_t count_running_ = 0;
-  uint64_t count_idle_ = 0;
+  // Only modified with [pool_monitor_] held, but read without it by
+  // [RunLocalImpl].
+  RelaxedAtomic<bool> shutting_down_ = false;
+  RelaxedAtomic<uint64_t> count_running_ = 0;
+  RelaxedAtomic<uint64_t> count_idle_ = 0;
   uint64_t count_dead_ = 0;
   WorkerList running_workers_;
   WorkerList idle_workers_;
@@ -133,7 +193,13 @@ class ThreadPool {
   Monitor exit_monitor_;
   std::atomic<bool> all_workers_dead_;
 
-  uintptr_t max_pool_size_ = 0;
+  RelaxedAtomic<uintptr_t> max_pool_size_ = 0;
+
+  RelaxedAtomic<uint64_t> tasks_started_ = 0;
+  RelaxedAtomic<uint64_t> tasks_run_locally_ = 0;
+  RelaxedAtomic<uint64_t> tasks_stolen_ = 0;
+  RelaxedAtomic<uint64_t> total_wait_micros_ = 0;
+  RelaxedAtomic<uint64_t> max_wait_micros_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
@@ -256,4 +256,44 @@ THREAD_POOL_UNIT_TEST_CASE(ThreadPool_RecursiveSpawn) {
   EXPECT_EQ(kTotalTasks, done);
 }
 
+class LocalSpawnTask : public ThreadPool::Task {
+ public:
+  LocalSpawnTask(ThreadPool* pool, Monitor* sync, int children, int* done)
+      : pool_(pool), sync_(sync), children_(children), done_(done) {}
+
+  virtual void Run() {
+    for (int i = 0; i < children_; i++) {
+      EXPECT(pool_->RunLocal<LocalSpawnTask>(pool_, sync_, 0, done_));
+    }
+    MonitorLocker ml(sync_);
+    (*done_)++;
+    ml.Notify();
+  }
+
+ private:
+  ThreadPool* pool_;
+  Monitor* sync_;
+  int children_;
+  int* done_;
+};
+
+THREAD_POOL_UNIT_TEST_CASE(ThreadPool_RunLocal) {
+  const int kChildren = 10;
+  // With a single worker which is busy, all children are queued locally.
+  ThreadPool thread_pool(1);
+  Monitor sync;
+  int done = 0;
+  EXPECT(thread_pool.RunLocal<LocalSpawnTask>(&thread_pool, &sync, kChildren,
+                                              &done));
+  {
+    MonitorLocker ml(&sync);
+    while (done < kChildren + 1) {
+      ml.Wait();
+    }
+  }
+  EXPECT_EQ(kChildren + 1, done);
+  EXPECT_EQ(static_cast<uint64_t>(kChildren), thread_pool.tasks_run_locally());
+  EXPECT_EQ(1U, thread_pool.workers_started());
+}
+
 }  // namespace dart
@@ -637,6 +637,10 @@ abstract class SendPort implements Capability {
   /// port can receive the message as soon as its isolate's event loop is ready
   /// to deliver it, independently of what the sending isolate is doing.
   ///
+  /// If the VM limits the number of pending messages of an isolate, and the
+  /// receiving isolate has reached that limit, a [StateError] is thrown and
+  /// the message is not sent.
+  ///
   /// Note: Due to an implementation choice the Dart VM made for how closures
   /// represent captured state, closures can currently capture more state than
   /// they need, which can cause the transitive closure to be larger than